@@ -0,0 +1,389 @@
+/*
+   Benchmarks for BM11Model: single-design latency, stage costs, print cost,
+   batch and sweep throughput.
+
+   Built as the BM11Bench target of the top-level CMakeLists.txt (Release,
+   -march=native), or by hand next to the model sources:
+
+      g++ -O3 -march=native -I../BM11Model main.cpp ../BM11Model/BM11[A-Z]*.cpp -pthread -o BM11Bench
+
+   Usage:
+
+      BM11Bench [--quick] [--threads N] [--output FILE]
+                [--baseline FILE] [--threshold FRACTION]
+
+   Results are printed as a table and, with --output, written as JSON with
+   one result per line. With --baseline every result is compared against the
+   stored one; a result that is worse by more than the threshold (default
+   0.10, i.e. 10%, or 0.25 with --quick) is reported as a regression and the
+   exit status is 1. --quick trades run time for noise: shorter runs, the
+   same number of repeats and a looser default threshold.
+
+   Baselines are machine specific: regenerate baseline.json with --output,
+   without --quick, on the machine that runs the comparison, and again
+   whenever a change moves a result on purpose. Record it with the --threads
+   the comparison uses, more than one, so that sweep.all_threads is checked.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "BM11Batch.h"
+#include "BM11Model.h"
+#include "BM11Parallel.h"
+#include "BM11Sweep.h"
+
+typedef struct {
+    std::string name;
+    double      value;
+    std::string unit;
+    bool        lower_is_better;
+} BenchResult;
+
+typedef struct {
+    const char                *name;
+    BM11Model::InputParameters params;
+} BenchDesign;
+
+static volatile float benchSink;
+
+static double benchNow(void)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/* Fastest of `repeats` runs of the time per call of body(iterations), with
+   the iteration count calibrated so one run takes at least `min_seconds`.
+   Interference only ever slows a run down, so the fastest is far steadier
+   from one invocation to the next than the median. */
+template <typename F> static double benchNanoseconds(F body, int repeats, double min_seconds)
+{
+    uint64_t iterations = 1;
+    for (;;) {
+        double start = benchNow();
+        body(iterations);
+        if ((benchNow() - start) >= min_seconds) {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    std::vector<double> samples;
+    for (int r = 0; r < repeats; r++) {
+        double start = benchNow();
+        body(iterations);
+        samples.push_back((benchNow() - start) * 1e9 / (double)iterations);
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[0];
+}
+
+static void benchAdd(std::vector<BenchResult> *results, const std::string &name, double value, const char *unit, bool lower_is_better)
+{
+    BenchResult result;
+    result.name            = name;
+    result.value           = value;
+    result.unit            = unit;
+    result.lower_is_better = lower_is_better;
+    results->push_back(result);
+    printf("%-36s %14.2f %s\n", name.c_str(), value, unit);
+    fflush(stdout);
+}
+
+/* Full evaluation: nudging squareSideLength by one ulp dirties every stage */
+static double benchEvaluate(const BM11Model::InputParameters *params, int field, int repeats, double min_seconds)
+{
+    BM11Model model;
+    model.setInputParameters(*params);
+
+    float values[2];
+    values[0] = BM11GetInputField(params, field);
+    values[1] = nextafterf(values[0], INFINITY);
+
+    return benchNanoseconds([&](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++) {
+            model.setInputParameter(field, values[i & 1]);
+            benchSink = model.getOutputParameters().total.cost;
+        }
+    }, repeats, min_seconds);
+}
+
+static double benchPrint(const BM11Model::InputParameters *params, int repeats, double min_seconds)
+{
+    BM11Model model;
+    model.setInputParameters(*params);
+    BM11Model::OutputParameters output = model.getOutputParameters();
+
+    /* Send stdout to /dev/null while printing */
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    if ((saved < 0) || !freopen("/dev/null", "w", stdout)) {
+        return 0.0;
+    }
+    double ns = benchNanoseconds([&](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++) {
+            BM11Model::printOutputParameters(output);
+        }
+        fflush(stdout);
+    }, repeats, min_seconds);
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    clearerr(stdout);
+    return ns;
+}
+
+static double benchBatch(size_t count, bool all_columns, int repeats, double min_seconds)
+{
+    BM11Model::InputParameters  defaults = BM11Model::getDefaultInputParameters();
+    std::vector<float>          inputs(BM11InputField_Count * count);
+    std::vector<float>          outputs(BM11OutputField_Count * count);
+    std::vector<uint8_t>        status(count);
+    BM11BatchInput              input;
+    BM11BatchOutput             output;
+
+    for (int f = 0; f < BM11InputField_Count; f++) {
+        input.column[f] = &inputs[f * count];
+        for (size_t i = 0; i < count; i++) {
+            inputs[f * count + i] = BM11GetInputField(&defaults, f);
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        inputs[BM11InputField_squareSideLength * count + i] = 8.0f + 8.0f * (float)i / (float)count;
+        inputs[BM11InputField_angle_ABC * count + i]        = BMMathDegreesToRadians(90.0f + 30.0f * (float)((i * 7) % count) / (float)count);
+    }
+    for (int f = 0; f < BM11OutputField_Count; f++) {
+        output.column[f] = (all_columns || (f == BM11OutputField_total_cost) || (f == BM11OutputField_total_mass)) ? &outputs[f * count] : NULL;
+    }
+    output.status = status.data();
+
+    return benchNanoseconds([&](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++) {
+            BM11EvaluateBatch(&input, &output, count);
+        }
+        benchSink = outputs[BM11OutputField_total_cost * count];
+    }, repeats, min_seconds) / (double)count;
+}
+
+/* One sum per thread, padded so the threads don't share a cache line */
+struct alignas(64) BenchSweepSum {
+    float sum;
+};
+
+static void benchSweepResult(void *context, uint64_t index,
+                             const BM11Model::InputParameters  *input,
+                             const BM11Model::OutputParameters *output,
+                             BM11Model::Status status, int thread_index)
+{
+    (void)index;
+    (void)input;
+    (void)status;
+    ((BenchSweepSum *)context)[thread_index].sum += output->total.cost;
+}
+
+/* Designs per second per thread for a 2D grid over the edge inputs, best
+   of `repeats` sweeps */
+static double benchSweep(uint32_t points, int thread_count, int repeats)
+{
+    BM11SweepConfig config;
+    BM11SweepConfigInit(&config);
+    BM11SweepAddAxis(&config, BM11InputField_squareSideLength, 8.0f, 16.0f, points);
+    BM11SweepAddAxis(&config, BM11InputField_angle_ABC, BMMathDegreesToRadians(60.0f), BMMathDegreesToRadians(130.0f), points);
+    config.thread_count = thread_count;
+
+    std::vector<BenchSweepSum> sums(thread_count, BenchSweepSum());
+    config.result         = benchSweepResult;
+    config.result_context = sums.data();
+
+    std::vector<double> samples;
+    for (int r = 0; r < repeats; r++) {
+        BM11SweepStats stats = BM11RunSweep(&config);
+        samples.push_back(stats.designs_per_second / (double)stats.thread_count);
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples.back();
+}
+
+static bool benchWrite(const char *path, const std::vector<BenchResult> &results, int thread_count)
+{
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+    fprintf(file, "{\n");
+    fprintf(file, "\"backend\": \"%s\",\n", BM11BatchBackendName());
+    fprintf(file, "\"threads\": %d,\n", thread_count);
+    fprintf(file, "\"results\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        fprintf(file, "{\"name\": \"%s\", \"value\": %.6g, \"unit\": \"%s\", \"better\": \"%s\"}%s\n",
+                results[i].name.c_str(), results[i].value, results[i].unit.c_str(),
+                results[i].lower_is_better ? "lower" : "higher", (i + 1 < results.size()) ? "," : "");
+    }
+    fprintf(file, "]\n}\n");
+    return (fclose(file) == 0);
+}
+
+/* Reads files written by benchWrite(), one result object per line */
+static bool benchRead(const char *path, std::vector<BenchResult> *results)
+{
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+    char line[512];
+    while (fgets(line, sizeof(line), file)) {
+        char        name[128], unit[32], better[16];
+        double      value;
+        const char *object = strstr(line, "{\"name\"");
+        if (object && (sscanf(object, "{\"name\": \"%127[^\"]\", \"value\": %lf, \"unit\": \"%31[^\"]\", \"better\": \"%15[^\"]\"",
+                              name, &value, unit, better) == 4)) {
+            BenchResult result;
+            result.name            = name;
+            result.value           = value;
+            result.unit            = unit;
+            result.lower_is_better = (strcmp(better, "lower") == 0);
+            results->push_back(result);
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+/* Returns the number of regressions */
+static int benchCompare(const std::vector<BenchResult> &baseline, const std::vector<BenchResult> &results, double threshold)
+{
+    int regressions = 0;
+
+    printf("\n%-36s %14s %14s %8s\n", "benchmark", "baseline", "current", "change");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult *base = NULL;
+        for (size_t j = 0; j < baseline.size(); j++) {
+            if (baseline[j].name == results[i].name) {
+                base = &baseline[j];
+            }
+        }
+        if (!base || (base->value <= 0.0)) {
+            printf("%-36s %14s %14.2f %8s\n", results[i].name.c_str(), "-", results[i].value, "new");
+            continue;
+        }
+
+        double change = (results[i].value - base->value) / base->value;
+        /* Positive = worse, whichever direction is better */
+        double worse  = results[i].lower_is_better ? change : -change;
+        bool   failed = (worse > threshold);
+        regressions  += failed;
+        printf("%-36s %14.2f %14.2f %+7.1f%%%s\n", results[i].name.c_str(), base->value, results[i].value,
+               change * 100.0, failed ? "  REGRESSION" : "");
+    }
+    return regressions;
+}
+
+int main(int argc, char **argv)
+{
+    const char *output_path   = NULL;
+    const char *baseline_path = NULL;
+    double      threshold     = -1.0;
+    bool        quick         = false;
+    int         thread_count  = BM11ParallelThreadCount();
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--quick")) {
+            quick = true;
+        } else if (!strcmp(argv[i], "--output") && (i + 1 < argc)) {
+            output_path = argv[++i];
+        } else if (!strcmp(argv[i], "--baseline") && (i + 1 < argc)) {
+            baseline_path = argv[++i];
+        } else if (!strcmp(argv[i], "--threshold") && (i + 1 < argc)) {
+            threshold = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--threads") && (i + 1 < argc)) {
+            thread_count = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [--quick] [--threads N] [--output FILE] [--baseline FILE] [--threshold FRACTION]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (thread_count < 1) {
+        thread_count = 1;
+    }
+    if (threshold < 0.0) {
+        threshold = quick ? 0.25 : 0.10;
+    }
+
+    /* As many repeats either way; quick only shortens them */
+    const int    repeats     = 7;
+    const double min_seconds = quick ? 0.02 : 0.05;
+
+    /* Representative designs: the default, both ends of the squareSideLength
+       range, a steep apex and one rejected by the feasibility check */
+    BenchDesign designs[5];
+    for (int i = 0; i < 5; i++) {
+        designs[i].params = BM11Model::getDefaultInputParameters();
+    }
+    designs[0].name = "default";
+    designs[1].name = "small";
+    designs[1].params.squareSideLength = 8.0f;
+    designs[2].name = "large";
+    designs[2].params.squareSideLength  = 24.0f;
+    designs[2].params.baseCutBackLength = 3.0f;
+    designs[3].name = "steep";
+    designs[3].params.angle_ABC = BMMathDegreesToRadians(70.0f);
+    designs[4].name = "rejected";
+    designs[4].params.baseCutBackLength = 20.0f;
+
+    std::vector<BenchResult> results;
+    printf("backend %s, %d lanes, %d threads\n\n", BM11BatchBackendName(), BM11BatchLaneWidth(), thread_count);
+
+    for (int i = 0; i < 5; i++) {
+        benchAdd(&results, std::string("evaluate.") + designs[i].name,
+                 benchEvaluate(&designs[i].params, BM11InputField_squareSideLength, repeats, min_seconds), "ns", true);
+    }
+
+    /* Stage costs: each field re-runs the stages downstream of where it is read */
+    static const struct {
+        const char *name;
+        int         field;
+    } stages[] = {
+        {"stages.edges_onward",     BM11InputField_angle_ABC},
+        {"stages.structure_onward", BM11InputField_shoulderHeight},
+        {"stages.frame_onward",     BM11InputField_unit_cost_frameMetal},
+        {"stages.mirror_onward",    BM11InputField_unit_cost_mirror},
+    };
+    for (size_t i = 0; i < sizeof(stages) / sizeof(stages[0]); i++) {
+        benchAdd(&results, stages[i].name, benchEvaluate(&designs[0].params, stages[i].field, repeats, min_seconds), "ns", true);
+    }
+
+    benchAdd(&results, "print.output", benchPrint(&designs[0].params, repeats, min_seconds), "ns", true);
+
+    benchAdd(&results, "batch.all_columns", benchBatch(4096, true, repeats, min_seconds), "ns/design", true);
+    benchAdd(&results, "batch.totals_only", benchBatch(4096, false, repeats, min_seconds), "ns/design", true);
+
+    uint32_t points = quick ? 300 : 1000;
+    benchAdd(&results, "sweep.1_thread", benchSweep(points, 1, 3), "designs/s/core", false);
+    if (thread_count > 1) {
+        benchAdd(&results, "sweep.all_threads", benchSweep(points, thread_count, 3), "designs/s/core", false);
+    }
+
+    if (output_path && !benchWrite(output_path, results, thread_count)) {
+        fprintf(stderr, "Could not write %s\n", output_path);
+        return 2;
+    }
+
+    if (baseline_path) {
+        std::vector<BenchResult> baseline;
+        if (!benchRead(baseline_path, &baseline)) {
+            fprintf(stderr, "Could not read %s\n", baseline_path);
+            return 2;
+        }
+        int regressions = benchCompare(baseline, results, threshold);
+        printf("\n%d regression%s beyond %.0f%%\n", regressions, (regressions == 1) ? "" : "s", threshold * 100.0);
+        return regressions ? 1 : 0;
+    }
+
+    return 0;
+}
@@ -0,0 +1,60 @@
+#include "BM11Batch.h"
+#include "BM11Kernel.h"
+
+template <typename V> static size_t evaluateLanes(const BM11BatchInput *input, BM11BatchOutput *output, size_t begin, size_t end)
+{
+    const size_t width = (size_t)bmWidth<V>();
+    V            in[BM11InputField_Count];
+    V            out[BM11OutputField_Count];
+    size_t       i;
+
+    for (i = begin; (i + width) <= end; i += width) {
+        for (int f = 0; f < BM11InputField_Count; f++) {
+            in[f] = bmLoad<V>(input->column[f] + i);
+        }
+
+        V status = bm11KernelEvaluate(in, out);
+
+        for (int f = 0; f < BM11OutputField_Count; f++) {
+            if (output->column[f]) {
+                bmStore(output->column[f] + i, out[f]);
+            }
+        }
+        if (output->status) {
+            float flags[sizeof(V) / sizeof(float)];
+            bmStore(flags, status);
+            for (size_t lane = 0; lane < width; lane++) {
+                output->status[i + lane] = (uint8_t)flags[lane];
+            }
+        }
+    }
+
+    return i;
+}
+
+void BM11EvaluateBatch(const BM11BatchInput *input, BM11BatchOutput *output, size_t count)
+{
+    size_t done = 0;
+
+    if (sizeof(BMLane) != sizeof(float)) {
+        done = evaluateLanes<BMLane>(input, output, 0, count);
+    }
+    /* Tail, one design at a time */
+    evaluateLanes<float>(input, output, done, count);
+}
+
+const char *BM11BatchBackendName(void)
+{
+#if defined(BM11_LANES_AVX512)
+    return "avx512";
+#elif defined(BM11_LANES_AVX2)
+    return "avx2";
+#else
+    return "scalar";
+#endif
+}
+
+int BM11BatchLaneWidth(void)
+{
+    return bmWidth<BMLane>();
+}
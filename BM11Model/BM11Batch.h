@@ -0,0 +1,38 @@
+#ifndef BM11_BATCH_H
+#define BM11_BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "BM11Fields.h"
+
+/*
+   Structure-of-arrays evaluation of many designs per call.
+
+   Every input column must point at `count` floats. Output columns that are
+   NULL are skipped, so callers only pay for the stores they need. When
+   `status` is set it receives the BM11Model::Status of each design; rejected
+   designs are zeroed the same way BM11Model::getOutputParameters() does.
+
+   Results match BM11Model to float tolerance, not bit for bit: the batch
+   path uses the polynomial sin/asin/acos/atan from BM11Lanes.h instead of
+   libm.
+ */
+
+typedef struct {
+    const float *column[BM11InputField_Count];
+} BM11BatchInput;
+
+typedef struct {
+    float   *column[BM11OutputField_Count];
+    uint8_t *status;
+} BM11BatchOutput;
+
+void        BM11EvaluateBatch(const BM11BatchInput *input, BM11BatchOutput *output, size_t count);
+
+/* Name of the lane backend compiled in: "avx512", "avx2" or "scalar" */
+const char *BM11BatchBackendName(void);
+
+/* Number of designs evaluated together by the compiled-in backend */
+int         BM11BatchLaneWidth(void);
+
+#endif /* BM11_BATCH_H */
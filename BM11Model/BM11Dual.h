@@ -0,0 +1,140 @@
+#ifndef BM11_DUAL_H
+#define BM11_DUAL_H
+
+#include <math.h>
+#include "BM11Lanes.h"
+
+/*
+   Forward-mode dual number carrying BM11_DUAL_TANGENTS partial derivatives
+   at once, one per BM11InputField, in double precision.
+
+   It implements the lane interface of BM11Lanes.h (arithmetic, bmSqrt,
+   bmAbs, comparisons and bmSelect with plain bool masks), so
+   bm11KernelEvaluate<BM11Dual>() runs the model once and yields every
+   output together with its gradient. bmSin/bmAsin/bmAcos/bmAtan are
+   overloaded here with libm and their exact derivatives instead of the
+   polynomial approximations used for float lanes.
+
+   Tangent arrays are padded to 16 so the per-operation loops vectorize.
+ */
+
+#define BM11_DUAL_TANGENTS 16
+
+struct BM11Dual {
+    double v;
+    double d[BM11_DUAL_TANGENTS];
+
+    BM11Dual(void) {}
+    BM11Dual(float x) : v(x) {
+        for (int i = 0; i < BM11_DUAL_TANGENTS; i++) d[i] = 0.0;
+    }
+};
+
+/* Input variable `value` with derivative 1 along tangent `index` */
+static inline BM11Dual bmDualVariable(float value, int index)
+{
+    BM11Dual r(value);
+    r.d[index] = 1.0;
+    return r;
+}
+
+/* r = a' * sa + b' * sb, the building block of every derivative rule */
+static inline void bmDualCombine(BM11Dual *r, const BM11Dual &a, double sa, const BM11Dual &b, double sb)
+{
+    for (int i = 0; i < BM11_DUAL_TANGENTS; i++) r->d[i] = (a.d[i] * sa) + (b.d[i] * sb);
+}
+
+static inline void bmDualScale(BM11Dual *r, const BM11Dual &a, double sa)
+{
+    for (int i = 0; i < BM11_DUAL_TANGENTS; i++) r->d[i] = a.d[i] * sa;
+}
+
+static inline BM11Dual operator+(const BM11Dual &a, const BM11Dual &b)
+{
+    BM11Dual r;
+    r.v = a.v + b.v;
+    bmDualCombine(&r, a, 1.0, b, 1.0);
+    return r;
+}
+
+static inline BM11Dual operator-(const BM11Dual &a, const BM11Dual &b)
+{
+    BM11Dual r;
+    r.v = a.v - b.v;
+    bmDualCombine(&r, a, 1.0, b, -1.0);
+    return r;
+}
+
+static inline BM11Dual operator*(const BM11Dual &a, const BM11Dual &b)
+{
+    BM11Dual r;
+    r.v = a.v * b.v;
+    bmDualCombine(&r, a, b.v, b, a.v);
+    return r;
+}
+
+static inline BM11Dual operator/(const BM11Dual &a, const BM11Dual &b)
+{
+    BM11Dual r;
+    r.v = a.v / b.v;
+    bmDualCombine(&r, a, 1.0 / b.v, b, -r.v / b.v);
+    return r;
+}
+
+static inline BM11Dual operator-(const BM11Dual &a)
+{
+    BM11Dual r;
+    r.v = -a.v;
+    bmDualScale(&r, a, -1.0);
+    return r;
+}
+
+static inline BM11Dual bmSqrt(const BM11Dual &x)
+{
+    BM11Dual r;
+    r.v = sqrt(x.v);
+    bmDualScale(&r, x, 0.5 / r.v);
+    return r;
+}
+
+static inline BM11Dual bmAbs(const BM11Dual &x)
+{
+    return (x.v < 0.0) ? -x : x;
+}
+
+static inline BMMask1  bmGreater(const BM11Dual &a, const BM11Dual &b)         { return (a.v > b.v); }
+static inline BM11Dual bmSelect(BMMask1 m, const BM11Dual &a, const BM11Dual &b) { return m ? a : b; }
+
+static inline BM11Dual bmSin(const BM11Dual &x)
+{
+    BM11Dual r;
+    r.v = sin(x.v);
+    bmDualScale(&r, x, cos(x.v));
+    return r;
+}
+
+static inline BM11Dual bmAsin(const BM11Dual &x)
+{
+    BM11Dual r;
+    r.v = asin(x.v);
+    bmDualScale(&r, x, 1.0 / sqrt(1.0 - (x.v * x.v)));
+    return r;
+}
+
+static inline BM11Dual bmAcos(const BM11Dual &x)
+{
+    BM11Dual r;
+    r.v = acos(x.v);
+    bmDualScale(&r, x, -1.0 / sqrt(1.0 - (x.v * x.v)));
+    return r;
+}
+
+static inline BM11Dual bmAtan(const BM11Dual &x)
+{
+    BM11Dual r;
+    r.v = atan(x.v);
+    bmDualScale(&r, x, 1.0 / (1.0 + (x.v * x.v)));
+    return r;
+}
+
+#endif /* BM11_DUAL_H */
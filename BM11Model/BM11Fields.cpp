@@ -0,0 +1,38 @@
+#include <string.h>
+#include "BM11Fields.h"
+
+/* Every member of the parameter structs must be listed exactly once */
+static_assert(sizeof(BM11Model::InputParameters)  == (BM11InputField_Count  * sizeof(float)), "InputParameters field table out of date");
+static_assert(sizeof(BM11Model::OutputParameters) == (BM11OutputField_Count * sizeof(float)), "OutputParameters field table out of date");
+
+const BM11FieldInfo BM11InputFieldInfo[BM11InputField_Count] = {
+#define BM11_FIELD_INFO(id, path) { #path, offsetof(BM11Model::InputParameters, path) },
+    BM11_INPUT_FIELDS(BM11_FIELD_INFO)
+#undef BM11_FIELD_INFO
+};
+
+const BM11FieldInfo BM11OutputFieldInfo[BM11OutputField_Count] = {
+#define BM11_FIELD_INFO(id, path) { #path, offsetof(BM11Model::OutputParameters, path) },
+    BM11_OUTPUT_FIELDS(BM11_FIELD_INFO)
+#undef BM11_FIELD_INFO
+};
+
+static int findField(const BM11FieldInfo *info, int count, const char *name)
+{
+    for (int i = 0; i < count; i++) {
+        if (strcmp(info[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int BM11FindInputField(const char *name)
+{
+    return findField(BM11InputFieldInfo, BM11InputField_Count, name);
+}
+
+int BM11FindOutputField(const char *name)
+{
+    return findField(BM11OutputFieldInfo, BM11OutputField_Count, name);
+}
@@ -0,0 +1,147 @@
+#ifndef BM11_FIELDS_H
+#define BM11_FIELDS_H
+
+#include <stddef.h>
+#include "BM11Model.h"
+
+/*
+   Flat, named view of every float in InputParameters and OutputParameters.
+
+   Both parameter structs are made of nothing but floats, so each member can
+   be addressed by an enum index and a byte offset. This is what the columnar
+   (SoA) batch API, sweeps and file writers use to refer to individual
+   fields. Names are the dotted member paths, e.g. "unit_cost.mirror" or
+   "vertex_coord.A0.x".
+ */
+
+#define BM11_INPUT_FIELDS(X)                                   \
+    X(squareSideLength,                squareSideLength)       \
+    X(baseCutBackLength,               baseCutBackLength)      \
+    X(angle_ABC,                       angle_ABC)              \
+    X(frameCrossSection_x,             frameCrossSection.x)    \
+    X(frameCrossSection_y,             frameCrossSection.y)    \
+    X(frameWallThickness,              frameWallThickness)     \
+    X(metalDensity,                    metalDensity)           \
+    X(shoulderHeight,                  shoulderHeight)         \
+    X(mirrorBoltSpacing,               mirrorBoltSpacing)      \
+    X(unit_cost_frameMetal,            unit_cost.frameMetal)   \
+    X(unit_cost_mirror,                unit_cost.mirror)       \
+    X(unit_cost_mirrorBolt,            unit_cost.mirrorBolt)   \
+    X(unit_cost_frameThroughHoleDrill, unit_cost.frameThroughHoleDrill) \
+    X(unit_cost_frameThroughHoleTap,   unit_cost.frameThroughHoleTap)
+
+#define BM11_OUTPUT_FIELDS(X)                                                    \
+    X(edge_length_OB,                         edge_length.OB)                    \
+    X(edge_length_BA,                         edge_length.BA)                    \
+    X(edge_length_OA,                         edge_length.OA)                    \
+    X(edge_length_AC,                         edge_length.AC)                    \
+    X(vertex_angle_angle_OAB,                 vertex_angle.angle_OAB)            \
+    X(vertex_angle_angle_AOB,                 vertex_angle.angle_AOB)            \
+    X(vertex_angle_angle_ABO,                 vertex_angle.angle_ABO)            \
+    X(vertex_angle_angle_OCB,                 vertex_angle.angle_OCB)            \
+    X(vertex_angle_angle_COB,                 vertex_angle.angle_COB)            \
+    X(vertex_angle_angle_CBO,                 vertex_angle.angle_CBO)            \
+    X(vertex_angle_angle_ABC,                 vertex_angle.angle_ABC)            \
+    X(vertex_angle_angle_BAC,                 vertex_angle.angle_BAC)            \
+    X(vertex_angle_angle_BCA,                 vertex_angle.angle_BCA)            \
+    X(vertex_angle_angle_AOC,                 vertex_angle.angle_AOC)            \
+    X(vertex_angle_angle_OAC,                 vertex_angle.angle_OAC)            \
+    X(vertex_angle_angle_OCA,                 vertex_angle.angle_OCA)            \
+    X(vertex_coord_A0_x,                      vertex_coord.A0.x)                 \
+    X(vertex_coord_A0_y,                      vertex_coord.A0.y)                 \
+    X(vertex_coord_A0_z,                      vertex_coord.A0.z)                 \
+    X(vertex_coord_C0_x,                      vertex_coord.C0.x)                 \
+    X(vertex_coord_C0_y,                      vertex_coord.C0.y)                 \
+    X(vertex_coord_C0_z,                      vertex_coord.C0.z)                 \
+    X(vertex_coord_B0_x,                      vertex_coord.B0.x)                 \
+    X(vertex_coord_B0_y,                      vertex_coord.B0.y)                 \
+    X(vertex_coord_B0_z,                      vertex_coord.B0.z)                 \
+    X(vertex_coord_O_x,                       vertex_coord.O.x)                  \
+    X(vertex_coord_O_y,                       vertex_coord.O.y)                  \
+    X(vertex_coord_O_z,                       vertex_coord.O.z)                  \
+    X(vertex_coord_A1_x,                      vertex_coord.A1.x)                 \
+    X(vertex_coord_A1_y,                      vertex_coord.A1.y)                 \
+    X(vertex_coord_A1_z,                      vertex_coord.A1.z)                 \
+    X(vertex_coord_B1_x,                      vertex_coord.B1.x)                 \
+    X(vertex_coord_B1_y,                      vertex_coord.B1.y)                 \
+    X(vertex_coord_B1_z,                      vertex_coord.B1.z)                 \
+    X(vertex_coord_C1_x,                      vertex_coord.C1.x)                 \
+    X(vertex_coord_C1_y,                      vertex_coord.C1.y)                 \
+    X(vertex_coord_C1_z,                      vertex_coord.C1.z)                 \
+    X(overall_structure_footprint_x,          overall_structure.footprint.x)     \
+    X(overall_structure_footprint_y,          overall_structure.footprint.y)     \
+    X(overall_structure_footprint_area,       overall_structure.footprint_area)  \
+    X(overall_structure_footprint_aspect_ratio, overall_structure.footprint_aspect_ratio) \
+    X(overall_structure_height,               overall_structure.height)          \
+    X(overall_structure_triangle_area,        overall_structure.triangle_area)   \
+    X(overall_structure_walkway_top_angle,    overall_structure.walkway_top_angle) \
+    X(overall_structure_walkway_base_width,   overall_structure.walkway_base_width) \
+    X(overall_structure_walkway_shoulder_width, overall_structure.walkway_shoulder_width) \
+    X(dihedral_angle_angle_BOA_BOC,           dihedral_angle.angle_BOA_BOC)      \
+    X(dihedral_angle_angle_BOA_ABC,           dihedral_angle.angle_BOA_ABC)      \
+    X(frame_perimeter_length,                 frame.perimeter_length)            \
+    X(frame_reinforce_length,                 frame.reinforce_length)            \
+    X(frame_total_length,                     frame.total_length)                \
+    X(frame_metal_volume,                     frame.metal_volume)                \
+    X(frame_metal_mass,                       frame.metal_mass)                  \
+    X(frame_metal_cost,                       frame.metal_cost)                  \
+    X(frame_drill_count,                      frame.drill_count)                 \
+    X(frame_drill_cost,                       frame.drill_cost)                  \
+    X(frame_tap_count,                        frame.tap_count)                   \
+    X(frame_tap_cost,                         frame.tap_cost)                    \
+    X(mirror_surface_area,                    mirror.surface_area)               \
+    X(mirror_cost,                            mirror.cost)                       \
+    X(mirror_bolt_count,                      mirror.bolt_count)                 \
+    X(mirror_bolt_cost,                       mirror.bolt_cost)                  \
+    X(wind_total_surface_area_XY,             wind.total_surface_area_XY)        \
+    X(wind_total_surface_area_YZ,             wind.total_surface_area_YZ)        \
+    X(total_mass,                             total.mass)                        \
+    X(total_cost,                             total.cost)
+
+typedef enum {
+#define BM11_FIELD_ENUM(id, path) BM11InputField_##id,
+    BM11_INPUT_FIELDS(BM11_FIELD_ENUM)
+#undef BM11_FIELD_ENUM
+    BM11InputField_Count
+} BM11InputField;
+
+typedef enum {
+#define BM11_FIELD_ENUM(id, path) BM11OutputField_##id,
+    BM11_OUTPUT_FIELDS(BM11_FIELD_ENUM)
+#undef BM11_FIELD_ENUM
+    BM11OutputField_Count
+} BM11OutputField;
+
+typedef struct {
+    const char *name;   /* Dotted member path */
+    size_t      offset; /* Byte offset into the parameter struct */
+} BM11FieldInfo;
+
+extern const BM11FieldInfo BM11InputFieldInfo[BM11InputField_Count];
+extern const BM11FieldInfo BM11OutputFieldInfo[BM11OutputField_Count];
+
+/* Name lookups, returning -1 when the name is unknown */
+int BM11FindInputField(const char *name);
+int BM11FindOutputField(const char *name);
+
+static inline float BM11GetInputField(const BM11Model::InputParameters *params, int field)
+{
+    return *(const float *)((const char *)params + BM11InputFieldInfo[field].offset);
+}
+
+static inline void BM11SetInputField(BM11Model::InputParameters *params, int field, float value)
+{
+    *(float *)((char *)params + BM11InputFieldInfo[field].offset) = value;
+}
+
+static inline float BM11GetOutputField(const BM11Model::OutputParameters *params, int field)
+{
+    return *(const float *)((const char *)params + BM11OutputFieldInfo[field].offset);
+}
+
+static inline void BM11SetOutputField(BM11Model::OutputParameters *params, int field, float value)
+{
+    *(float *)((char *)params + BM11OutputFieldInfo[field].offset) = value;
+}
+
+#endif /* BM11_FIELDS_H */
@@ -0,0 +1,36 @@
+#include <stdio.h>
+#include "BM11Dual.h"
+#include "BM11Jacobian.h"
+#include "BM11Kernel.h"
+
+static_assert(BM11InputField_Count <= BM11_DUAL_TANGENTS, "BM11Dual has fewer tangents than there are input fields");
+
+BM11Model::Status BM11EvaluateJacobian(const BM11Model::InputParameters *input,
+                                       BM11Model::OutputParameters      *output,
+                                       BM11Jacobian                     *jacobian)
+{
+    BM11Dual in[BM11InputField_Count];
+    BM11Dual out[BM11OutputField_Count];
+
+    for (int f = 0; f < BM11InputField_Count; f++) {
+        in[f] = bmDualVariable(BM11GetInputField(input, f), f);
+    }
+
+    BM11Dual status = bm11KernelEvaluate(in, out);
+
+    for (int o = 0; o < BM11OutputField_Count; o++) {
+        BM11SetOutputField(output, o, (float)out[o].v);
+        for (int i = 0; i < BM11InputField_Count; i++) {
+            jacobian->d[o][i] = out[o].d[i];
+        }
+    }
+    return (BM11Model::Status)(int)status.v;
+}
+
+void BM11PrintJacobian(const BM11Jacobian *jacobian, int output_field)
+{
+    printf("Sensitivity of %s:\n", BM11OutputFieldInfo[output_field].name);
+    for (int i = 0; i < BM11InputField_Count; i++) {
+        printf("   d/d %-32s = %.6g\n", BM11InputFieldInfo[i].name, jacobian->d[output_field][i]);
+    }
+}
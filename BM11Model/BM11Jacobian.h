@@ -0,0 +1,31 @@
+#ifndef BM11_JACOBIAN_H
+#define BM11_JACOBIAN_H
+
+#include "BM11Fields.h"
+
+/*
+   Outputs and their full Jacobian with respect to the inputs from a single
+   evaluation, by forward-mode automatic differentiation (BM11Dual through
+   bm11KernelEvaluate()).
+
+   d[o][i] is the partial derivative of BM11OutputField o with respect to
+   BM11InputField i, in the units of the fields (e.g. $ per ft for
+   total.cost against baseCutBackLength). The model is evaluated in double
+   precision, so outputs agree with BM11Model to float rounding and the
+   derivatives are exact up to double rounding, unlike finite differences.
+   Rejected designs keep their edge lengths and the derivatives of those,
+   as BM11Model does, and the vertex angles too when only the law of sines
+   check failed; everything downstream is zero, with zero derivatives.
+ */
+
+typedef struct {
+    double d[BM11OutputField_Count][BM11InputField_Count];
+} BM11Jacobian;
+
+BM11Model::Status BM11EvaluateJacobian(const BM11Model::InputParameters *input,
+                                       BM11Model::OutputParameters      *output,
+                                       BM11Jacobian                     *jacobian);
+
+void              BM11PrintJacobian(const BM11Jacobian *jacobian, int output_field);
+
+#endif /* BM11_JACOBIAN_H */
@@ -0,0 +1,266 @@
+#ifndef BM11_KERNEL_H
+#define BM11_KERNEL_H
+
+#include "BM11Fields.h"
+#include "BM11Lanes.h"
+
+/*
+   Lane-generic version of BM11Model::evaluate().
+
+   in[]  holds one value per BM11InputField, out[] receives one value per
+   BM11OutputField. V is any lane type from BM11Lanes.h, so the same code
+   runs one design (float) or 8/16 designs at once (AVX2/AVX-512).
+
+   The arithmetic follows evaluate() line for line. The returned lanes hold
+   the BM11Model::Status of each design. Rejected designs have every field
+   past the vertex angles zeroed, and the vertex angles too when the
+   feasibility pre-check failed, as BM11Model does. The Cayley-Menger test
+   runs in float here (double in BM11Model), so designs within rounding of
+   the degenerate-volume threshold may be classified differently.
+ */
+
+template <typename V> struct BM11KernelVector3 {
+    V x, y, z;
+};
+
+template <typename V> static inline BM11KernelVector3<V> bm11KernelVector3Make(V x, V y, V z)
+{
+    BM11KernelVector3<V> r = { x, y, z };
+    return r;
+}
+
+template <typename V> static inline BM11KernelVector3<V> bm11KernelSubtract(BM11KernelVector3<V> a, BM11KernelVector3<V> b)
+{
+    return bm11KernelVector3Make(a.x - b.x, a.y - b.y, a.z - b.z);
+}
+
+template <typename V> static inline BM11KernelVector3<V> bm11KernelCross(BM11KernelVector3<V> a, BM11KernelVector3<V> b)
+{
+    return bm11KernelVector3Make((a.y * b.z) - (a.z * b.y),
+                                 (a.z * b.x) - (a.x * b.z),
+                                 (a.x * b.y) - (a.y * b.x));
+}
+
+template <typename V> static inline V bm11KernelDot(BM11KernelVector3<V> a, BM11KernelVector3<V> b)
+{
+    return (a.x * b.x) + (a.y * b.y) + (a.z * b.z);
+}
+
+template <typename V> static inline V bm11KernelLength(BM11KernelVector3<V> a)
+{
+    return bmSqrt(bm11KernelDot(a, a));
+}
+
+template <typename V> static inline BM11KernelVector3<V> bm11KernelNormalize(BM11KernelVector3<V> a)
+{
+    V s = V(1.0f) / bm11KernelLength(a);
+    return bm11KernelVector3Make(a.x * s, a.y * s, a.z * s);
+}
+
+template <typename V> static inline V bm11KernelEvaluate(const V *in, V *out)
+{
+    const V PI   = V(3.14159265358979323846f);
+    const V ZERO = V(0.0f);
+
+    #define IN(f)  in[BM11InputField_##f]
+    #define OUT(f) out[BM11OutputField_##f]
+
+    /* Calculate lengths of all tetrahedron edges */
+    V OB = bmSqrt((IN(squareSideLength) * IN(squareSideLength)) + (IN(baseCutBackLength) * IN(baseCutBackLength)));
+    V BA = IN(squareSideLength) - IN(baseCutBackLength);
+    V OA = bmSqrt(V(2.0f) * IN(squareSideLength) * IN(squareSideLength));
+    V AC = V(2.0f) * BA * bmSin(IN(angle_ABC) * V(0.5f));
+
+    /* Feasibility pre-check, see BM11Model::checkEdgeFeasibility() */
+    auto nonpositive = bmOr(bmOr(bmNot(bmGreater(OB, ZERO)), bmNot(bmGreater(BA, ZERO))),
+                            bmOr(bmNot(bmGreater(OA, ZERO)), bmNot(bmGreater(AC, ZERO))));
+    auto inequality  = bmOr(bmOr(bmNot(bmGreater(OA + OB, BA)), bmNot(bmGreater(OA + BA, OB))),
+                            bmOr(bmOr(bmNot(bmGreater(OB + BA, OA)), bmNot(bmGreater(V(2.0f) * OA, AC))),
+                                 bmNot(bmGreater(V(2.0f) * BA, AC))));
+    V    p2          = OA * OA;
+    V    q2          = OB * OB;
+    V    a2          = BA * BA;
+    V    b2          = AC * AC;
+    V    cm          = (V(2.0f) * p2 * a2 * (q2 + b2)) + (q2 * b2 * (p2 + p2 + a2 + a2 - q2 - b2))
+                     - (V(2.0f) * p2 * q2 * a2) - (p2 * p2 * b2) - (a2 * b2 * a2);
+    V    max_edge    = bmSelect(bmGreater(OA, OB), OA, OB);
+    max_edge         = bmSelect(bmGreater(max_edge, BA), max_edge, BA);
+    V    max_edge3   = max_edge * max_edge * max_edge;
+    auto degenerate  = bmNot(bmGreater(cm, V(1e-6f) * max_edge3 * max_edge3));
+    auto precheck    = bmOr(nonpositive, bmOr(inequality, degenerate));
+    V    status      = bmSelect(nonpositive, V((float)BM11Model::StatusNonPositiveEdge),
+                       bmSelect(inequality,  V((float)BM11Model::StatusTriangleInequality),
+                       bmSelect(degenerate,  V((float)BM11Model::StatusDegenerateVolume), ZERO)));
+
+    /* Scalene triangles OBA and OBC: computed via triangle cosine law */
+    V angle_OAB = bmAcos(((OA * OA) + (BA * BA) - (OB * OB)) / (V(2.0f) * OA * BA));
+    V angle_AOB = bmAcos(((OA * OA) + (OB * OB) - (BA * BA)) / (V(2.0f) * OA * OB));
+    V angle_ABO = PI - angle_OAB - angle_AOB;
+
+    /* Isoceles triangles ABC and AOC */
+    V angle_ABC = IN(angle_ABC);
+    V angle_BAC = (PI - angle_ABC) * V(0.5f);
+    V angle_AOC = V(2.0f) * bmAsin(AC / (V(2.0f) * OA));
+    V angle_OAC = (PI - angle_AOC) * V(0.5f);
+
+    OUT(edge_length_OB)         = OB;
+    OUT(edge_length_BA)         = BA;
+    OUT(edge_length_OA)         = OA;
+    OUT(edge_length_AC)         = AC;
+    #define OUT_ANGLE(f, v) out[BM11OutputField_##f] = bmSelect(precheck, ZERO, (v))
+
+    OUT_ANGLE(vertex_angle_angle_OAB, angle_OAB);
+    OUT_ANGLE(vertex_angle_angle_AOB, angle_AOB);
+    OUT_ANGLE(vertex_angle_angle_ABO, angle_ABO);
+    OUT_ANGLE(vertex_angle_angle_OCB, angle_OAB);
+    OUT_ANGLE(vertex_angle_angle_COB, angle_AOB);
+    OUT_ANGLE(vertex_angle_angle_CBO, angle_ABO);
+    OUT_ANGLE(vertex_angle_angle_ABC, angle_ABC);
+    OUT_ANGLE(vertex_angle_angle_BAC, angle_BAC);
+    OUT_ANGLE(vertex_angle_angle_BCA, angle_BAC);
+    OUT_ANGLE(vertex_angle_angle_AOC, angle_AOC);
+    OUT_ANGLE(vertex_angle_angle_OAC, angle_OAC);
+    OUT_ANGLE(vertex_angle_angle_OCA, angle_OAC);
+
+    /* Validate the tetrahedron via the 3D law of sines */
+    V sin_OAB = bmSin(angle_OAB);
+    V sin_AOB = bmSin(angle_AOB);
+    V sin_ABO = bmSin(angle_ABO);
+    V sin_ABC = bmSin(angle_ABC);
+    V sin_BAC = bmSin(angle_BAC);
+    V sin_AOC = bmSin(angle_AOC);
+    V sin_OAC = bmSin(angle_OAC);
+    V epsilon = V(1.0f / 1000.0f);
+
+    auto lawofsines = bmGreater(bmAbs((sin_OAC * sin_OAB * sin_ABO) - (sin_OAC * sin_ABO * sin_OAB)), epsilon); /* O,ABC */
+    lawofsines = bmOr(lawofsines, bmGreater(bmAbs((sin_AOC * sin_BAC * sin_ABO) - (sin_OAC * sin_ABC * sin_AOB)), epsilon)); /* A,OBC */
+    lawofsines = bmOr(lawofsines, bmGreater(bmAbs((sin_BAC * sin_OAB * sin_AOB) - (sin_BAC * sin_AOB * sin_OAB)), epsilon)); /* B,AOC */
+    lawofsines = bmOr(lawofsines, bmGreater(bmAbs((sin_OAC * sin_AOB * sin_ABC) - (sin_AOC * sin_ABO * sin_BAC)), epsilon)); /* C,ABO */
+
+    auto invalid = bmOr(precheck, lawofsines);
+    status       = bmSelect(precheck, status, bmSelect(lawofsines, V((float)BM11Model::StatusLawOfSines), ZERO));
+
+    /* Compute vertex positions for the first tetrahedron, already translated such that O.xz = 0 */
+    V length_AM = AC * V(0.5f);
+    V B0z       = bmSqrt((BA * BA) - (length_AM * length_AM));
+    V Oz        = ((OB * OB) - (OA * OA) + (length_AM * length_AM) - (B0z * B0z)) / (V(-2.0f) * B0z);
+    V Oy        = bmSqrt((OA * OA) - (length_AM * length_AM) - (Oz * Oz));
+
+    BM11KernelVector3<V> A0 = bm11KernelVector3Make(-length_AM, ZERO, -Oz);
+    BM11KernelVector3<V> C0 = bm11KernelVector3Make(length_AM,  ZERO, -Oz);
+    BM11KernelVector3<V> B0 = bm11KernelVector3Make(ZERO, ZERO, B0z - Oz);
+    BM11KernelVector3<V> O  = bm11KernelVector3Make(ZERO, Oy, ZERO);
+
+    /* Everything below is zero for invalid lanes */
+    #define OUT_VALID(f, v) out[BM11OutputField_##f] = bmSelect(invalid, ZERO, (v))
+
+    OUT_VALID(vertex_coord_A0_x, A0.x);
+    OUT_VALID(vertex_coord_A0_y, A0.y);
+    OUT_VALID(vertex_coord_A0_z, A0.z);
+    OUT_VALID(vertex_coord_C0_x, C0.x);
+    OUT_VALID(vertex_coord_C0_y, C0.y);
+    OUT_VALID(vertex_coord_C0_z, C0.z);
+    OUT_VALID(vertex_coord_B0_x, B0.x);
+    OUT_VALID(vertex_coord_B0_y, B0.y);
+    OUT_VALID(vertex_coord_B0_z, B0.z);
+    OUT_VALID(vertex_coord_O_x,  O.x);
+    OUT_VALID(vertex_coord_O_y,  O.y);
+    OUT_VALID(vertex_coord_O_z,  O.z);
+    /* Second tetrahedron ABC is just first tetrahedron ABC with Z negated */
+    OUT_VALID(vertex_coord_A1_x, A0.x);
+    OUT_VALID(vertex_coord_A1_y, A0.y);
+    OUT_VALID(vertex_coord_A1_z, -A0.z);
+    OUT_VALID(vertex_coord_B1_x, B0.x);
+    OUT_VALID(vertex_coord_B1_y, B0.y);
+    OUT_VALID(vertex_coord_B1_z, -B0.z);
+    OUT_VALID(vertex_coord_C1_x, C0.x);
+    OUT_VALID(vertex_coord_C1_y, C0.y);
+    OUT_VALID(vertex_coord_C1_z, -C0.z);
+
+    /* Overall structure stats */
+    V footprint_x        = C0.x - A0.x;
+    V footprint_y        = (-A0.z) - A0.z;
+    V B1z                = -B0.z;
+    V triangle_area      = bm11KernelLength(bm11KernelCross(bm11KernelSubtract(O, B0), bm11KernelSubtract(A0, B0))) * V(0.5f);
+    V walkway_base_width = B1z - B0.z;
+
+    OUT_VALID(overall_structure_footprint_x,            footprint_x);
+    OUT_VALID(overall_structure_footprint_y,            footprint_y);
+    OUT_VALID(overall_structure_footprint_area,         footprint_x * footprint_y);
+    OUT_VALID(overall_structure_footprint_aspect_ratio, footprint_x / footprint_y);
+    OUT_VALID(overall_structure_height,                 O.y);
+    OUT_VALID(overall_structure_triangle_area,          triangle_area);
+    OUT_VALID(overall_structure_walkway_top_angle,      bmAtan(B1z / O.y) * V(2.0f));
+    OUT_VALID(overall_structure_walkway_base_width,     walkway_base_width);
+    OUT_VALID(overall_structure_walkway_shoulder_width, ((O.y - IN(shoulderHeight)) * B1z * V(2.0f)) / O.y);
+
+    /* Important dihedral angles */
+    BM11KernelVector3<V> vBO      = bm11KernelSubtract(B0, O);
+    BM11KernelVector3<V> vBA      = bm11KernelSubtract(B0, A0);
+    BM11KernelVector3<V> vBC      = bm11KernelSubtract(B0, C0);
+    BM11KernelVector3<V> norm_BOA = bm11KernelNormalize(bm11KernelCross(vBO, vBA));
+    BM11KernelVector3<V> norm_BOC = bm11KernelNormalize(bm11KernelCross(vBO, vBC));
+
+    OUT_VALID(dihedral_angle_angle_BOA_BOC, bmAcos(bm11KernelDot(norm_BOA, norm_BOC)));
+    OUT_VALID(dihedral_angle_angle_BOA_ABC, bmAcos(norm_BOA.y));
+
+    /* Frame info */
+    V perimeter_length    = (BA * V(4.0f)) + (OA * V(4.0f)) + (OB * V(4.0f));
+    V reinforce_length    = (BA * V(1.6f * 4.0f)) + walkway_base_width;
+    V total_length        = perimeter_length + reinforce_length;
+    V xsection_area       = IN(frameCrossSection_x) * IN(frameCrossSection_y);
+    V xsection_inner_area = (IN(frameCrossSection_x) - (IN(frameWallThickness) * V(2.0f))) *
+                            (IN(frameCrossSection_y) - (IN(frameWallThickness) * V(2.0f)));
+    V metal_volume        = (xsection_area - xsection_inner_area) * (total_length * V(12.0f));
+    V metal_mass          = metal_volume * IN(metalDensity);
+    V metal_cost          = total_length * IN(unit_cost_frameMetal);
+    V drill_count         = total_length / IN(mirrorBoltSpacing);
+    V drill_cost          = drill_count * IN(unit_cost_frameThroughHoleDrill);
+    V tap_count           = drill_count * V(2.0f); /* x 2 due to double sided mirror attachment */
+    V tap_cost            = tap_count * IN(unit_cost_frameThroughHoleTap);
+
+    OUT_VALID(frame_perimeter_length, perimeter_length);
+    OUT_VALID(frame_reinforce_length, reinforce_length);
+    OUT_VALID(frame_total_length,     total_length);
+    OUT_VALID(frame_metal_volume,     metal_volume);
+    OUT_VALID(frame_metal_mass,       metal_mass);
+    OUT_VALID(frame_metal_cost,       metal_cost);
+    OUT_VALID(frame_drill_count,      drill_count);
+    OUT_VALID(frame_drill_cost,       drill_cost);
+    OUT_VALID(frame_tap_count,        tap_count);
+    OUT_VALID(frame_tap_cost,         tap_cost);
+
+    /* Mirror assembly */
+    V mirror_surface_area = triangle_area * V(8.0f); /* 8 triangles */
+    V mirror_cost         = mirror_surface_area * IN(unit_cost_mirror);
+    V mirror_bolt_cost    = tap_count * IN(unit_cost_mirrorBolt);
+
+    OUT_VALID(mirror_surface_area, mirror_surface_area);
+    OUT_VALID(mirror_cost,         mirror_cost);
+    OUT_VALID(mirror_bolt_count,   tap_count);
+    OUT_VALID(mirror_bolt_cost,    mirror_bolt_cost);
+
+    /* Wind: triangle(OBA) projected onto the XY and YZ planes, two triangles each */
+    BM11KernelVector3<V> BpXY = bm11KernelVector3Make(B0.x, B0.y, ZERO);
+    BM11KernelVector3<V> BpYZ = bm11KernelVector3Make(ZERO, B0.y, B0.z);
+    V area_XY = bm11KernelLength(bm11KernelCross(bm11KernelSubtract(BpXY, bm11KernelVector3Make(A0.x, A0.y, ZERO)),
+                                                 bm11KernelSubtract(BpXY, bm11KernelVector3Make(O.x,  O.y,  ZERO)))) * V(0.5f);
+    V area_YZ = bm11KernelLength(bm11KernelCross(bm11KernelSubtract(BpYZ, bm11KernelVector3Make(ZERO, A0.y, A0.z)),
+                                                 bm11KernelSubtract(BpYZ, bm11KernelVector3Make(ZERO, O.y,  O.z)))) * V(0.5f);
+
+    OUT_VALID(wind_total_surface_area_XY, area_XY * V(2.0f));
+    OUT_VALID(wind_total_surface_area_YZ, area_YZ * V(2.0f));
+
+    /* Totals */
+    OUT_VALID(total_mass, metal_mass); /* TODO: Mirror and bolts */
+    OUT_VALID(total_cost, metal_cost + drill_cost + tap_cost + mirror_cost + mirror_bolt_cost);
+
+    #undef OUT_VALID
+    #undef OUT_ANGLE
+    #undef OUT
+    #undef IN
+
+    return status;
+}
+
+#endif /* BM11_KERNEL_H */
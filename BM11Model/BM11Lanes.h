@@ -0,0 +1,222 @@
+#ifndef BM11_LANES_H
+#define BM11_LANES_H
+
+#include <math.h>
+
+/*
+   Lane types for evaluating many designs at once.
+
+   Every lane type V provides the same small vocabulary so the model kernels
+   can be written once as templates:
+
+      V(float)                    broadcast constant
+      + - * / and unary -         lane-wise arithmetic
+      bmSqrt, bmAbs, bmFloor      lane-wise primitives
+      bmGreater(a, b)             lane-wise a > b, returns the lane's mask type
+      bmOr(m0, m1), bmNot(m)      mask union and complement
+      bmSelect(m, a, b)           m ? a : b per lane
+      bmLoad(ptr) / bmStore(ptr)  unaligned load/store of bmWidth<V>() floats
+
+   Plain float is the one-lane type and is used for the tail of a batch, so
+   a design goes through the same approximations whichever lane it lands in.
+
+   The vector backend is chosen at compile time from the target flags:
+   AVX-512F (16 lanes), AVX2 + FMA (8 lanes), otherwise scalar only.
+
+   Transcendentals (bmSin, bmAsin, bmAcos, bmAtan) are polynomial
+   approximations evaluated identically on every lane type. Maximum absolute
+   error measured against double precision libm with 4M-point sweeps over
+   the stated domain:
+
+      bmSin   [-64, 64]        1.7e-7
+      bmAsin  [-1, 1]          1.7e-7   (Cephes asinf polynomial)
+      bmAcos  [-1, 1]          3.3e-7
+      bmAtan  [-1e4, 1e4]      1.3e-7   (Cephes atanf polynomial)
+
+   Arguments outside [-1, 1] give NaN for bmAsin/bmAcos, like libm.
+ */
+
+#if defined(__AVX512F__)
+#  define BM11_LANES_AVX512 1
+#  include <immintrin.h>
+#elif defined(__AVX2__) && defined(__FMA__)
+#  define BM11_LANES_AVX2 1
+#  include <immintrin.h>
+#endif
+
+/* Scalar lane */
+
+typedef bool BMMask1;
+
+static inline float   bmSqrt(float x)                       { return sqrtf(x); }
+static inline float   bmAbs(float x)                        { return fabsf(x); }
+static inline float   bmFloor(float x)                      { return floorf(x); }
+#if defined(__FMA__)
+static inline float   bmMulAdd(float a, float b, float c)   { return fmaf(a, b, c); }
+#else
+static inline float   bmMulAdd(float a, float b, float c)   { return (a * b) + c; }
+#endif
+static inline BMMask1 bmGreater(float a, float b)           { return (a > b); }
+static inline BMMask1 bmOr(BMMask1 a, BMMask1 b)            { return (a || b); }
+static inline BMMask1 bmNot(BMMask1 a)                      { return !a; }
+static inline float   bmSelect(BMMask1 m, float a, float b) { return m ? a : b; }
+static inline bool    bmAny(BMMask1 m)                      { return m; }
+
+#if defined(BM11_LANES_AVX512)
+
+struct BMLane16 {
+    __m512 v;
+    BMLane16(void)            {}
+    BMLane16(__m512 x) : v(x) {}
+    BMLane16(float x)  : v(_mm512_set1_ps(x)) {}
+};
+typedef __mmask16 BMMask16;
+
+static inline BMLane16 operator+(BMLane16 a, BMLane16 b) { return _mm512_add_ps(a.v, b.v); }
+static inline BMLane16 operator-(BMLane16 a, BMLane16 b) { return _mm512_sub_ps(a.v, b.v); }
+static inline BMLane16 operator*(BMLane16 a, BMLane16 b) { return _mm512_mul_ps(a.v, b.v); }
+static inline BMLane16 operator/(BMLane16 a, BMLane16 b) { return _mm512_div_ps(a.v, b.v); }
+static inline BMLane16 operator-(BMLane16 a)             { return _mm512_sub_ps(_mm512_setzero_ps(), a.v); }
+
+static inline BMLane16 bmSqrt(BMLane16 x)                             { return _mm512_maskz_sqrt_ps((__mmask16)0xFFFF, x.v); }
+static inline BMLane16 bmAbs(BMLane16 x)                              { return _mm512_abs_ps(x.v); }
+static inline BMLane16 bmFloor(BMLane16 x)                            { return _mm512_maskz_roundscale_ps((__mmask16)0xFFFF, x.v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+static inline BMLane16 bmMulAdd(BMLane16 a, BMLane16 b, BMLane16 c)   { return _mm512_fmadd_ps(a.v, b.v, c.v); }
+static inline BMMask16 bmGreater(BMLane16 a, BMLane16 b)              { return _mm512_cmp_ps_mask(a.v, b.v, _CMP_GT_OQ); }
+static inline BMMask16 bmOr(BMMask16 a, BMMask16 b)                   { return (BMMask16)(a | b); }
+static inline BMMask16 bmNot(BMMask16 a)                              { return (BMMask16)~a; }
+static inline BMLane16 bmSelect(BMMask16 m, BMLane16 a, BMLane16 b)   { return _mm512_mask_blend_ps(m, b.v, a.v); }
+static inline bool     bmAny(BMMask16 m)                              { return (m != 0); }
+
+static inline BMLane16 bmLoad(const float *p, BMLane16 *) { return _mm512_loadu_ps(p); }
+static inline void     bmStore(float *p, BMLane16 x)      { _mm512_storeu_ps(p, x.v); }
+
+typedef BMLane16 BMLane;
+typedef BMMask16 BMMask;
+
+#elif defined(BM11_LANES_AVX2)
+
+struct BMLane8 {
+    __m256 v;
+    BMLane8(void)            {}
+    BMLane8(__m256 x) : v(x) {}
+    BMLane8(float x)  : v(_mm256_set1_ps(x)) {}
+};
+struct BMMask8 {
+    __m256 m;
+    BMMask8(__m256 x) : m(x) {}
+};
+
+static inline BMLane8 operator+(BMLane8 a, BMLane8 b) { return _mm256_add_ps(a.v, b.v); }
+static inline BMLane8 operator-(BMLane8 a, BMLane8 b) { return _mm256_sub_ps(a.v, b.v); }
+static inline BMLane8 operator*(BMLane8 a, BMLane8 b) { return _mm256_mul_ps(a.v, b.v); }
+static inline BMLane8 operator/(BMLane8 a, BMLane8 b) { return _mm256_div_ps(a.v, b.v); }
+static inline BMLane8 operator-(BMLane8 a)            { return _mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f)); }
+
+static inline BMLane8 bmSqrt(BMLane8 x)                          { return _mm256_sqrt_ps(x.v); }
+static inline BMLane8 bmAbs(BMLane8 x)                           { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x.v); }
+static inline BMLane8 bmFloor(BMLane8 x)                         { return _mm256_floor_ps(x.v); }
+static inline BMLane8 bmMulAdd(BMLane8 a, BMLane8 b, BMLane8 c)  { return _mm256_fmadd_ps(a.v, b.v, c.v); }
+static inline BMMask8 bmGreater(BMLane8 a, BMLane8 b)            { return _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ); }
+static inline BMMask8 bmOr(BMMask8 a, BMMask8 b)                 { return _mm256_or_ps(a.m, b.m); }
+static inline BMMask8 bmNot(BMMask8 a)                           { return _mm256_xor_ps(a.m, _mm256_castsi256_ps(_mm256_set1_epi32(-1))); }
+static inline BMLane8 bmSelect(BMMask8 m, BMLane8 a, BMLane8 b)  { return _mm256_blendv_ps(b.v, a.v, m.m); }
+static inline bool    bmAny(BMMask8 m)                           { return (_mm256_movemask_ps(m.m) != 0); }
+
+static inline BMLane8 bmLoad(const float *p, BMLane8 *) { return _mm256_loadu_ps(p); }
+static inline void    bmStore(float *p, BMLane8 x)      { _mm256_storeu_ps(p, x.v); }
+
+typedef BMLane8 BMLane;
+typedef BMMask8 BMMask;
+
+#else
+
+typedef float   BMLane;
+typedef BMMask1 BMMask;
+
+#endif
+
+static inline float bmLoad(const float *p, float *) { return *p; }
+static inline void  bmStore(float *p, float x)      { *p = x; }
+
+template <typename V> static inline int bmWidth(void) { return (int)(sizeof(V) / sizeof(float)); }
+
+template <typename V> static inline V bmLoad(const float *p)
+{
+    return bmLoad(p, (V *)0);
+}
+
+/*
+   sin(x): reduce to r = x - k*pi with |r| <= pi/2 using a three-part pi
+   (Cody-Waite), then an odd Taylor polynomial through r^11 whose truncation
+   error on [-pi/2, pi/2] is below 6e-8. Sign flips for odd k.
+ */
+template <typename V> static inline V bmSin(V x)
+{
+    const V DP1 = 3.140625f;
+    const V DP2 = 9.67502593994140625e-4f;
+    const V DP3 = 1.509957990978376432e-7f;
+
+    V k      = bmFloor(bmMulAdd(x, V(0.318309886183790671538f), V(0.5f)));
+    V r      = x - (k * DP1);
+    r        = r - (k * DP2);
+    r        = r - (k * DP3);
+    V half_k = k * V(0.5f);
+    V odd    = half_k - bmFloor(half_k);   /* 0.5 when k is odd, else 0 */
+    V r2     = r * r;
+
+    V p = V(-2.5052108385e-08f);
+    p   = bmMulAdd(p, r2, V( 2.7557319224e-06f));
+    p   = bmMulAdd(p, r2, V(-1.9841269841e-04f));
+    p   = bmMulAdd(p, r2, V( 8.3333333333e-03f));
+    p   = bmMulAdd(p, r2, V(-1.6666666667e-01f));
+    V s = bmMulAdd(p * r2, r, r);
+
+    return bmSelect(bmGreater(odd, V(0.25f)), -s, s);
+}
+
+/* asin on [0, 0.5]: x + x^3 P(x^2), Cephes asinf coefficients */
+template <typename V> static inline V _bmAsinKernel(V x)
+{
+    V z = x * x;
+    V p = V(4.2163199048e-2f);
+    p   = bmMulAdd(p, z, V(2.4181311049e-2f));
+    p   = bmMulAdd(p, z, V(4.5470025998e-2f));
+    p   = bmMulAdd(p, z, V(7.4953002686e-2f));
+    p   = bmMulAdd(p, z, V(1.6666752422e-1f));
+    return bmMulAdd(p * z, x, x);
+}
+
+template <typename V> static inline V bmAsin(V x)
+{
+    /* |x| > 0.5 uses asin(a) = pi/2 - 2 asin(sqrt((1 - a) / 2)) */
+    V    a   = bmAbs(x);
+    auto big = bmGreater(a, V(0.5f));
+    V    k   = _bmAsinKernel(bmSelect(big, bmSqrt((V(1.0f) - a) * V(0.5f)), a));
+    V    r   = bmSelect(big, V(1.57079632679489661923f) - (k + k), k);
+    return bmSelect(bmGreater(V(0.0f), x), -r, r);
+}
+
+template <typename V> static inline V bmAcos(V x)
+{
+    return V(1.57079632679489661923f) - bmAsin(x);
+}
+
+/* atan with Cephes atanf range reduction and polynomial */
+template <typename V> static inline V bmAtan(V x)
+{
+    V    a   = bmAbs(x);
+    auto big = bmGreater(a, V(2.414213562373095f));
+    auto mid = bmGreater(a, V(0.4142135623730950f));
+    V    y0  = bmSelect(big, V(1.57079632679489661923f), bmSelect(mid, V(0.78539816339744830962f), V(0.0f)));
+    V    t   = bmSelect(big, V(-1.0f) / a, bmSelect(mid, (a - V(1.0f)) / (a + V(1.0f)), a));
+    V    z   = t * t;
+    V    p   = V(8.05374449538e-2f);
+    p        = bmMulAdd(p, z, V(-1.38776856032e-1f));
+    p        = bmMulAdd(p, z, V( 1.99777106478e-1f));
+    p        = bmMulAdd(p, z, V(-3.33329491539e-1f));
+    V    r   = y0 + bmMulAdd(p * z, t, t);
+    return bmSelect(bmGreater(V(0.0f), x), -r, r);
+}
+
+#endif /* BM11_LANES_H */
@@ -0,0 +1,251 @@
+#ifndef BM11_MATH_H
+#define BM11_MATH_H
+
+#include <math.h>
+
+/*
+   Portable replacement for the parts of <GLKit/GLKMath.h> used by the model.
+
+   Semantics follow GLKit: vectors are plain float unions (no padding, so
+   sizeof(BMVector3) == 12), normalize is v * (1 / length) with no zero-length
+   guard, and degree/radian conversions are done in double precision before
+   rounding back to float.
+
+   Backend is picked at compile time:
+      - SSE (x86-64, also used under AVX builds via VEX encoding)
+      - NEON (ARMv7 with NEON, AArch64)
+      - scalar fallback (anything else, or when BM_MATH_NO_SIMD is defined)
+
+   Three-component vectors never fill more than one 128-bit register, so the
+   wider AVX/AVX-512 units only pay off when running many designs at once;
+   this header sticks to 128-bit operations for single vectors.
+ */
+
+#if !defined(BM_MATH_NO_SIMD) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#  define BM_MATH_USE_SSE 1
+#  include <xmmintrin.h>
+#elif !defined(BM_MATH_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#  define BM_MATH_USE_NEON 1
+#  include <arm_neon.h>
+#else
+#  define BM_MATH_USE_SCALAR 1
+#endif
+
+#ifndef M_PI
+#  define M_PI 3.14159265358979323846
+#endif
+
+typedef union {
+    struct { float x, y; };
+    struct { float s, t; };
+    float v[2];
+} BMVector2;
+
+typedef union {
+    struct { float x, y, z; };
+    struct { float r, g, b; };
+    struct { float s, t, p; };
+    float v[3];
+} BMVector3;
+
+/* Scalar helpers */
+
+static inline float BMMathDegreesToRadians(float degrees) { return (float)(degrees * (M_PI / 180)); }
+static inline float BMMathRadiansToDegrees(float radians) { return (float)(radians * (180 / M_PI)); }
+
+/* BMVector2 */
+
+static inline BMVector2 BMVector2Make(float x, float y)
+{
+    BMVector2 v = { { x, y } };
+    return v;
+}
+
+static inline BMVector2 BMVector2Add(BMVector2 a, BMVector2 b)      { return BMVector2Make(a.x + b.x, a.y + b.y); }
+static inline BMVector2 BMVector2Subtract(BMVector2 a, BMVector2 b) { return BMVector2Make(a.x - b.x, a.y - b.y); }
+static inline BMVector2 BMVector2Multiply(BMVector2 a, BMVector2 b) { return BMVector2Make(a.x * b.x, a.y * b.y); }
+static inline float     BMVector2DotProduct(BMVector2 a, BMVector2 b) { return (a.x * b.x) + (a.y * b.y); }
+static inline float     BMVector2Length(BMVector2 v)                { return sqrtf((v.x * v.x) + (v.y * v.y)); }
+
+/* BMVector3 */
+
+static inline BMVector3 BMVector3Make(float x, float y, float z)
+{
+    BMVector3 v = { { x, y, z } };
+    return v;
+}
+
+#if defined(BM_MATH_USE_SSE)
+
+static inline __m128 _BMVector3Load(BMVector3 v)
+{
+    return _mm_set_ps(0.0f, v.z, v.y, v.x);
+}
+
+static inline BMVector3 _BMVector3Store(__m128 m)
+{
+    float     lanes[4];
+    BMVector3 v;
+
+    _mm_storeu_ps(lanes, m);
+    v.x = lanes[0];
+    v.y = lanes[1];
+    v.z = lanes[2];
+    return v;
+}
+
+static inline BMVector3 BMVector3Add(BMVector3 a, BMVector3 b)
+{
+    return _BMVector3Store(_mm_add_ps(_BMVector3Load(a), _BMVector3Load(b)));
+}
+
+static inline BMVector3 BMVector3Subtract(BMVector3 a, BMVector3 b)
+{
+    return _BMVector3Store(_mm_sub_ps(_BMVector3Load(a), _BMVector3Load(b)));
+}
+
+static inline BMVector3 BMVector3Multiply(BMVector3 a, BMVector3 b)
+{
+    return _BMVector3Store(_mm_mul_ps(_BMVector3Load(a), _BMVector3Load(b)));
+}
+
+static inline BMVector3 BMVector3MultiplyScalar(BMVector3 a, float s)
+{
+    return _BMVector3Store(_mm_mul_ps(_BMVector3Load(a), _mm_set1_ps(s)));
+}
+
+static inline float BMVector3DotProduct(BMVector3 a, BMVector3 b)
+{
+    /* Summed x + y + z in the same order as the scalar path */
+    __m128 m = _mm_mul_ps(_BMVector3Load(a), _BMVector3Load(b));
+    __m128 y = _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 1, 1, 1));
+    __m128 z = _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 2, 2, 2));
+    return _mm_cvtss_f32(_mm_add_ss(_mm_add_ss(m, y), z));
+}
+
+static inline BMVector3 BMVector3CrossProduct(BMVector3 a, BMVector3 b)
+{
+    __m128 ma      = _BMVector3Load(a);
+    __m128 mb      = _BMVector3Load(b);
+    __m128 a_yzx   = _mm_shuffle_ps(ma, ma, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 b_yzx   = _mm_shuffle_ps(mb, mb, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 a_zxy   = _mm_shuffle_ps(ma, ma, _MM_SHUFFLE(3, 1, 0, 2));
+    __m128 b_zxy   = _mm_shuffle_ps(mb, mb, _MM_SHUFFLE(3, 1, 0, 2));
+    return _BMVector3Store(_mm_sub_ps(_mm_mul_ps(a_yzx, b_zxy), _mm_mul_ps(a_zxy, b_yzx)));
+}
+
+#elif defined(BM_MATH_USE_NEON)
+
+static inline float32x4_t _BMVector3Load(BMVector3 v)
+{
+    float lanes[4] = { v.x, v.y, v.z, 0.0f };
+    return vld1q_f32(lanes);
+}
+
+static inline BMVector3 _BMVector3Store(float32x4_t m)
+{
+    float     lanes[4];
+    BMVector3 v;
+
+    vst1q_f32(lanes, m);
+    v.x = lanes[0];
+    v.y = lanes[1];
+    v.z = lanes[2];
+    return v;
+}
+
+/* Rotate lanes (x, y, z, w) -> (y, z, x, w) */
+static inline float32x4_t _BMVector3YZX(float32x4_t m)
+{
+    float32x4_t r = vsetq_lane_f32(vgetq_lane_f32(m, 1), m, 0);
+    r = vsetq_lane_f32(vgetq_lane_f32(m, 2), r, 1);
+    r = vsetq_lane_f32(vgetq_lane_f32(m, 0), r, 2);
+    return r;
+}
+
+/* Rotate lanes (x, y, z, w) -> (z, x, y, w) */
+static inline float32x4_t _BMVector3ZXY(float32x4_t m)
+{
+    float32x4_t r = vsetq_lane_f32(vgetq_lane_f32(m, 2), m, 0);
+    r = vsetq_lane_f32(vgetq_lane_f32(m, 0), r, 1);
+    r = vsetq_lane_f32(vgetq_lane_f32(m, 1), r, 2);
+    return r;
+}
+
+static inline BMVector3 BMVector3Add(BMVector3 a, BMVector3 b)
+{
+    return _BMVector3Store(vaddq_f32(_BMVector3Load(a), _BMVector3Load(b)));
+}
+
+static inline BMVector3 BMVector3Subtract(BMVector3 a, BMVector3 b)
+{
+    return _BMVector3Store(vsubq_f32(_BMVector3Load(a), _BMVector3Load(b)));
+}
+
+static inline BMVector3 BMVector3Multiply(BMVector3 a, BMVector3 b)
+{
+    return _BMVector3Store(vmulq_f32(_BMVector3Load(a), _BMVector3Load(b)));
+}
+
+static inline BMVector3 BMVector3MultiplyScalar(BMVector3 a, float s)
+{
+    return _BMVector3Store(vmulq_n_f32(_BMVector3Load(a), s));
+}
+
+static inline float BMVector3DotProduct(BMVector3 a, BMVector3 b)
+{
+    /* Summed x + y + z in the same order as the scalar path */
+    float32x4_t m = vmulq_f32(_BMVector3Load(a), _BMVector3Load(b));
+    return (vgetq_lane_f32(m, 0) + vgetq_lane_f32(m, 1)) + vgetq_lane_f32(m, 2);
+}
+
+static inline BMVector3 BMVector3CrossProduct(BMVector3 a, BMVector3 b)
+{
+    float32x4_t ma = _BMVector3Load(a);
+    float32x4_t mb = _BMVector3Load(b);
+    return _BMVector3Store(vsubq_f32(vmulq_f32(_BMVector3YZX(ma), _BMVector3ZXY(mb)),
+                                     vmulq_f32(_BMVector3ZXY(ma), _BMVector3YZX(mb))));
+}
+
+#else /* BM_MATH_USE_SCALAR */
+
+static inline BMVector3 BMVector3Add(BMVector3 a, BMVector3 b)      { return BMVector3Make(a.x + b.x, a.y + b.y, a.z + b.z); }
+static inline BMVector3 BMVector3Subtract(BMVector3 a, BMVector3 b) { return BMVector3Make(a.x - b.x, a.y - b.y, a.z - b.z); }
+static inline BMVector3 BMVector3Multiply(BMVector3 a, BMVector3 b) { return BMVector3Make(a.x * b.x, a.y * b.y, a.z * b.z); }
+static inline BMVector3 BMVector3MultiplyScalar(BMVector3 a, float s) { return BMVector3Make(a.x * s, a.y * s, a.z * s); }
+
+static inline float BMVector3DotProduct(BMVector3 a, BMVector3 b)
+{
+    return (a.x * b.x) + (a.y * b.y) + (a.z * b.z);
+}
+
+static inline BMVector3 BMVector3CrossProduct(BMVector3 a, BMVector3 b)
+{
+    return BMVector3Make((a.y * b.z) - (a.z * b.y),
+                         (a.z * b.x) - (a.x * b.z),
+                         (a.x * b.y) - (a.y * b.x));
+}
+
+#endif
+
+static inline float BMVector3Length(BMVector3 v)
+{
+    return sqrtf(BMVector3DotProduct(v, v));
+}
+
+static inline float BMVector3Distance(BMVector3 a, BMVector3 b)
+{
+    return BMVector3Length(BMVector3Subtract(b, a));
+}
+
+static inline BMVector3 BMVector3Normalize(BMVector3 v)
+{
+    return BMVector3MultiplyScalar(v, 1.0f / BMVector3Length(v));
+}
+
+static inline BMVector3 BMVector3Negate(BMVector3 v)
+{
+    return BMVector3Make(-v.x, -v.y, -v.z);
+}
+
+#endif /* BM11_MATH_H */
@@ -0,0 +1,374 @@
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include "BM11Mesh.h"
+#include "BM11Parallel.h"
+#include "BM11ResultFile.h"
+
+#define STL_HEADER_SIZE   80
+#define STL_TRIANGLE_SIZE 50
+#define OBJ_VERTEX_SIZE   (2 + 3 * 49 + 1) /* "v" and three BM11FormatFloat() values */
+#define OBJ_FACE_SIZE     (2 + 3 * 21 + 1)
+#define OBJ_NAME_SIZE     256
+
+void BM11MeshConfigInit(BM11MeshConfig *config)
+{
+    BM11FrameConfigInit(&config->frame);
+    config->members = true;
+    config->mirrors = true;
+    config->scale   = 12.0f;
+}
+
+/* Mesh */
+
+static uint32_t addVertex(BM11Mesh *mesh, BMVector3 v)
+{
+    mesh->vertex[mesh->vertex_count] = v;
+    return mesh->vertex_count++;
+}
+
+static void addTriangle(BM11Mesh *mesh, uint32_t a, uint32_t b, uint32_t c)
+{
+    uint32_t *t = mesh->triangle[mesh->triangle_count++];
+    t[0] = a;
+    t[1] = b;
+    t[2] = c;
+}
+
+/* Box prism from a to b spanning [s0, s1] along `side` and [n0, n1] along
+   `normal`; (direction, side, normal) is right handed */
+static void addPrism(BM11Mesh *mesh, BMVector3 a, BMVector3 b, BMVector3 side, BMVector3 normal,
+                     float s0, float s1, float n0, float n1)
+{
+    /* Counter-clockwise seen from b */
+    const float ring[4][2] = { { s0, n0 }, { s1, n0 }, { s1, n1 }, { s0, n1 } };
+    uint32_t    first      = mesh->vertex_count;
+
+    for (int end = 0; end < 2; end++) {
+        BMVector3 p = end ? b : a;
+        for (int i = 0; i < 4; i++) {
+            addVertex(mesh, BMVector3Add(p, BMVector3Add(BMVector3MultiplyScalar(side, ring[i][0]),
+                                                         BMVector3MultiplyScalar(normal, ring[i][1]))));
+        }
+    }
+    addTriangle(mesh, first + 0, first + 2, first + 1);
+    addTriangle(mesh, first + 0, first + 3, first + 2);
+    addTriangle(mesh, first + 4, first + 5, first + 6);
+    addTriangle(mesh, first + 4, first + 6, first + 7);
+    for (int i = 0; i < 4; i++) {
+        int j = (i + 1) & 3;
+        addTriangle(mesh, first + i, first + j, first + 4 + j);
+        addTriangle(mesh, first + i, first + 4 + j, first + 4 + i);
+    }
+}
+
+bool BM11MeshBuild(const BM11MeshConfig *config,
+                   const BM11Model::InputParameters  *input,
+                   const BM11Model::OutputParameters *output,
+                   BM11Mesh *mesh)
+{
+    BM11FrameLayout layout;
+
+    mesh->vertex_count          = 0;
+    mesh->triangle_count        = 0;
+    mesh->member_triangle_count = 0;
+    if (!(output->vertex_coord.O.y > 0.0f)) {
+        return false;
+    }
+    BM11FrameLayoutBuild(&config->frame, output, &layout);
+
+    const float scale = config->scale;
+    const float depth = input->frameCrossSection.x / 12.0f * scale; /* Along the normal */
+    const float width = input->frameCrossSection.y / 12.0f * scale; /* In the plane     */
+    for (int n = 0; n < layout.node_count; n++) {
+        layout.node[n] = BMVector3MultiplyScalar(layout.node[n], scale);
+    }
+
+    if (config->members) {
+        for (int m = 0; m < layout.member_count; m++) {
+            const BM11FrameMember *member = &layout.member[m];
+            BMVector3 a         = layout.node[member->node[0]];
+            BMVector3 b         = layout.node[member->node[1]];
+            BMVector3 direction = BMVector3Normalize(BMVector3Subtract(b, a));
+            BMVector3 normal    = BMVector3Normalize(BMVector3Subtract(member->normal,
+                                      BMVector3MultiplyScalar(direction, BMVector3DotProduct(member->normal, direction))));
+            BMVector3 side      = BMVector3CrossProduct(normal, direction);
+
+            float s0 = -0.5f * width, s1 = 0.5f * width;
+            if (member->kind == BM11FrameMemberPerimeter) {
+                /* Towards the opposite corner of the panel */
+                const int *corner = layout.panel_node[member->panel];
+                BMVector3  centroid = BMVector3MultiplyScalar(BMVector3Add(layout.node[corner[0]],
+                                          BMVector3Add(layout.node[corner[1]], layout.node[corner[2]])), 1.0f / 3.0f);
+                if (BMVector3DotProduct(side, BMVector3Subtract(centroid, a)) >= 0.0f) {
+                    s0 = 0.0f;
+                    s1 = width;
+                } else {
+                    s0 = -width;
+                    s1 = 0.0f;
+                }
+            }
+            addPrism(mesh, a, b, side, normal, s0, s1, -0.5f * depth, 0.5f * depth);
+        }
+    }
+    mesh->member_triangle_count = mesh->triangle_count;
+
+    if (config->mirrors) {
+        for (int p = 0; p < BM11_FRAME_PANELS; p++) {
+            const int *corner = layout.panel_node[p];
+            BMVector3  normal = layout.panel_normal[p];
+            BMVector3  o      = layout.node[corner[0]];
+            BMVector3  x      = layout.node[corner[1]];
+            BMVector3  y      = layout.node[corner[2]];
+            bool       ccw    = (BMVector3DotProduct(BMVector3CrossProduct(BMVector3Subtract(x, o), BMVector3Subtract(y, o)), normal) > 0.0f);
+
+            for (int face = 0; face < 2; face++) {
+                /* Outer face first, facing along the panel normal */
+                BMVector3 offset = BMVector3MultiplyScalar(normal, face ? -0.5f * depth : 0.5f * depth);
+                uint32_t  first  = addVertex(mesh, BMVector3Add(o, offset));
+                addVertex(mesh, BMVector3Add(x, offset));
+                addVertex(mesh, BMVector3Add(y, offset));
+                if (ccw == (face == 0)) {
+                    addTriangle(mesh, first, first + 1, first + 2);
+                } else {
+                    addTriangle(mesh, first, first + 2, first + 1);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/* Writer */
+
+static int formatUInt64(char *buffer, uint64_t value)
+{
+    char digits[20];
+    int  count = 0;
+
+    do {
+        digits[count++] = (char)('0' + (value % 10));
+        value /= 10;
+    } while (value);
+    for (int i = 0; i < count; i++) {
+        buffer[i] = digits[count - 1 - i];
+    }
+    return count;
+}
+
+BM11MeshWriter::BM11MeshWriter(size_t buffer_size)
+{
+    _file           = NULL;
+    _format         = BM11MeshSTL;
+    _buffer.resize(std::max(buffer_size, (size_t)4096));
+    _fill           = 0;
+    _vertex_base    = 0;
+    _triangle_count = 0;
+    _decimals       = 4;
+    _error          = false;
+}
+
+BM11MeshWriter::~BM11MeshWriter(void)
+{
+    close();
+}
+
+bool BM11MeshWriter::open(const char *path, BM11MeshFormat format)
+{
+    close();
+
+    _file = fopen(path, "wb");
+    if (!_file) {
+        return false;
+    }
+    _format         = format;
+    _fill           = 0;
+    _vertex_base    = 0;
+    _triangle_count = 0;
+    _error          = false;
+
+    if (format == BM11MeshSTL) {
+        /* Must not start with "solid", which marks ASCII STL; the count is patched by close() */
+        char *header = reserve(STL_HEADER_SIZE + 4);
+        memset(header, 0, STL_HEADER_SIZE + 4);
+        strcpy(header, "BM11Model binary STL");
+        _fill += STL_HEADER_SIZE + 4;
+    }
+    return true;
+}
+
+void BM11MeshWriter::flush(void)
+{
+    if (_fill) {
+        _error |= (fwrite(_buffer.data(), 1, _fill, _file) != _fill);
+        _fill   = 0;
+    }
+}
+
+/* Room for `size` more bytes at the end of the buffer */
+char *BM11MeshWriter::reserve(size_t size)
+{
+    if (_fill + size > _buffer.size()) {
+        flush();
+    }
+    return &_buffer[_fill];
+}
+
+void BM11MeshWriter::append(const BM11Mesh *mesh, const char *name)
+{
+    if (!_file) {
+        return;
+    }
+
+    if (_format == BM11MeshSTL) {
+        for (uint32_t t = 0; t < mesh->triangle_count; t++) {
+            const uint32_t *triangle = mesh->triangle[t];
+            BMVector3       v[3]     = { mesh->vertex[triangle[0]], mesh->vertex[triangle[1]], mesh->vertex[triangle[2]] };
+            BMVector3       n        = BMVector3CrossProduct(BMVector3Subtract(v[1], v[0]), BMVector3Subtract(v[2], v[0]));
+            float           length   = BMVector3Length(n);
+            float           record[12] = {
+                0.0f, 0.0f, 0.0f,
+                v[0].x, v[0].y, v[0].z,
+                v[1].x, v[1].y, v[1].z,
+                v[2].x, v[2].y, v[2].z,
+            };
+            if (length > 0.0f) {
+                record[0] = n.x / length;
+                record[1] = n.y / length;
+                record[2] = n.z / length;
+            }
+            char *dst = reserve(STL_TRIANGLE_SIZE);
+            memcpy(dst, record, sizeof(record));
+            dst[48] = 0;
+            dst[49] = 0;
+            _fill  += STL_TRIANGLE_SIZE;
+        }
+    } else {
+        if (name) {
+            char *dst = reserve(OBJ_NAME_SIZE + 4);
+            int   len = snprintf(dst, OBJ_NAME_SIZE + 4, "o %.*s\n", OBJ_NAME_SIZE, name);
+            _fill    += len;
+        }
+        for (uint32_t v = 0; v < mesh->vertex_count; v++) {
+            char  *dst = reserve(OBJ_VERTEX_SIZE);
+            size_t len = 0;
+            dst[len++] = 'v';
+            dst[len++] = ' ';
+            len       += BM11FormatFloat(dst + len, mesh->vertex[v].x, _decimals);
+            dst[len++] = ' ';
+            len       += BM11FormatFloat(dst + len, mesh->vertex[v].y, _decimals);
+            dst[len++] = ' ';
+            len       += BM11FormatFloat(dst + len, mesh->vertex[v].z, _decimals);
+            dst[len++] = '\n';
+            _fill     += len;
+        }
+        for (uint32_t t = 0; t < mesh->triangle_count; t++) {
+            if ((t == 0) || (t == mesh->member_triangle_count)) {
+                const char *group = (t < mesh->member_triangle_count) ? "g frame\n" : "g mirror\n";
+                char       *dst   = reserve(16);
+                memcpy(dst, group, strlen(group));
+                _fill += strlen(group);
+            }
+            char  *dst = reserve(OBJ_FACE_SIZE);
+            size_t len = 0;
+            dst[len++] = 'f';
+            for (int i = 0; i < 3; i++) {
+                dst[len++] = ' ';
+                len       += formatUInt64(dst + len, _vertex_base + mesh->triangle[t][i] + 1);
+            }
+            dst[len++] = '\n';
+            _fill     += len;
+        }
+        _vertex_base += mesh->vertex_count;
+    }
+    _triangle_count += mesh->triangle_count;
+}
+
+bool BM11MeshWriter::close(void)
+{
+    if (!_file) {
+        return false;
+    }
+    flush();
+    if (_format == BM11MeshSTL) {
+        uint32_t count = (uint32_t)_triangle_count;
+        _error |= (_triangle_count > UINT32_MAX);
+        _error |= (fseek(_file, STL_HEADER_SIZE, SEEK_SET) != 0);
+        _error |= (fwrite(&count, sizeof(count), 1, _file) != 1);
+    }
+    _error |= (fclose(_file) != 0);
+    _file   = NULL;
+    return !_error;
+}
+
+/* Sweep driver */
+
+typedef struct {
+    const BM11MeshConfig          *config;
+    BM11MeshFormat                 format;
+    std::string                    directory;
+    std::vector<BM11Mesh *>        meshes;
+    std::vector<BM11MeshWriter *>  writers;
+    std::atomic<uint64_t>          failed;
+} MeshSweep;
+
+static void meshResult(void *context, uint64_t index,
+                       const BM11Model::InputParameters  *input,
+                       const BM11Model::OutputParameters *output,
+                       BM11Model::Status status, int thread_index)
+{
+    (void)status;
+    MeshSweep      *sweep  = (MeshSweep *)context;
+    BM11Mesh       *mesh   = sweep->meshes[thread_index];
+    BM11MeshWriter *writer = sweep->writers[thread_index];
+    char            path[4096];
+    char            name[32];
+
+    if (!BM11MeshBuild(sweep->config, input, output, mesh)) {
+        return;
+    }
+    name[formatUInt64(name, index)] = 0;
+    snprintf(path, sizeof(path), "%s/%s.%s", sweep->directory.c_str(), name, (sweep->format == BM11MeshSTL) ? "stl" : "obj");
+    bool ok = writer->open(path, sweep->format);
+    if (ok) {
+        writer->append(mesh, name);
+        ok = writer->close();
+    }
+    if (!ok) {
+        sweep->failed++;
+    }
+}
+
+BM11SweepStats BM11RunMeshSweep(const BM11SweepConfig *sweep, const BM11MeshConfig *mesh,
+                                BM11MeshFormat format, const char *directory, uint64_t *failed)
+{
+    int       thread_count = (sweep->thread_count > 0) ? sweep->thread_count : BM11ParallelThreadCount();
+    MeshSweep context;
+
+    context.config    = mesh;
+    context.format    = format;
+    context.directory = directory;
+    context.failed    = 0;
+    for (int t = 0; t < thread_count; t++) {
+        context.meshes.push_back(new BM11Mesh);
+        context.writers.push_back(new BM11MeshWriter(1 << 18));
+    }
+
+    BM11SweepConfig config = *sweep;
+    config.thread_count    = thread_count;
+    config.result          = meshResult;
+    config.result_context  = &context;
+    config.skip_invalid    = true;
+    BM11SweepStats stats   = BM11RunSweep(&config);
+
+    for (int t = 0; t < thread_count; t++) {
+        delete context.meshes[t];
+        delete context.writers[t];
+    }
+    if (failed) {
+        *failed = context.failed;
+    }
+    return stats;
+}
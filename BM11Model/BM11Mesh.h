@@ -0,0 +1,110 @@
+#ifndef BM11_MESH_H
+#define BM11_MESH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+#include "BM11Sweep.h"
+#include "BM11Truss.h"
+
+/*
+   Triangle meshes of a design for fabrication drawings and rendering.
+
+   BM11MeshBuild() meshes the members of BM11FrameLayoutBuild() as closed
+   box prisms of frameCrossSection: x along the panel normal, centred on
+   the panel plane, y in the plane. Perimeter members sit on the inside of
+   their edge line, so the two OB members of neighbouring panels touch
+   instead of overlapping; reinforcing members and the crossbar are centred
+   on theirs. Every prism is watertight on its own (8 vertices, 12
+   triangles, outward winding); prisms overlap at the joints and are not
+   merged. The section is meshed solid, without the wall.
+
+   The eight mirror triangles are the two faces of each of the four panels,
+   the outer one facing away from the tetrahedron and the inner one facing
+   into it, each half the section depth from the panel plane. They are
+   single-sided sheets.
+
+   A BM11Mesh has fixed capacity for any BM11FrameConfig, so one per thread
+   is rebuilt for every design without allocating. BM11MeshWriter streams
+   meshes to binary STL or OBJ through one preallocated buffer; several
+   meshes may go to the same file. Binary STL is written in native byte
+   order (little endian on every supported target).
+ */
+
+#define BM11_MESH_MIRRORS       8
+#define BM11_MESH_MAX_VERTICES  (BM11_FRAME_MAX_MEMBERS * 8 + BM11_MESH_MIRRORS * 3)
+#define BM11_MESH_MAX_TRIANGLES (BM11_FRAME_MAX_MEMBERS * 12 + BM11_MESH_MIRRORS)
+
+typedef struct {
+    BM11FrameConfig frame;
+    bool            members; /* Frame member prisms        */
+    bool            mirrors; /* The eight mirror triangles */
+    float           scale;   /* Output units per ft, 12 = inches */
+} BM11MeshConfig;
+
+typedef struct {
+    uint32_t  vertex_count;
+    BMVector3 vertex[BM11_MESH_MAX_VERTICES];
+    uint32_t  triangle_count;
+    uint32_t  triangle[BM11_MESH_MAX_TRIANGLES][3]; /* Counter-clockwise seen from the front */
+    uint32_t  member_triangle_count;                /* Members first, then mirrors           */
+} BM11Mesh;
+
+typedef enum {
+    BM11MeshSTL,
+    BM11MeshOBJ
+} BM11MeshFormat;
+
+/* The default frame, members and mirrors, in inches */
+void BM11MeshConfigInit(BM11MeshConfig *config);
+
+/* Returns false, with an empty mesh, for rejected designs */
+bool BM11MeshBuild(const BM11MeshConfig *config,
+                   const BM11Model::InputParameters  *input,
+                   const BM11Model::OutputParameters *output,
+                   BM11Mesh *mesh);
+
+class BM11MeshWriter {
+public:
+    BM11MeshWriter(size_t buffer_size = (1 << 20));
+    ~BM11MeshWriter(void);
+
+    bool     open(const char *path, BM11MeshFormat format);
+
+    /* Digits after the decimal point in OBJ files (default 4) */
+    void     setDecimals(int decimals) { _decimals = decimals; };
+
+    /* `name` becomes the OBJ object name (may be NULL); STL ignores it */
+    void     append(const BM11Mesh *mesh, const char *name);
+
+    /* Flushes the buffer and, for STL, patches the triangle count;
+       returns false on any I/O error */
+    bool     close(void);
+
+    uint64_t getTriangleCount(void) { return _triangle_count; };
+
+private:
+    BM11MeshWriter(const BM11MeshWriter &);
+    BM11MeshWriter &operator=(const BM11MeshWriter &);
+
+    char    *reserve(size_t size);
+    void     flush(void);
+
+    FILE             *_file;
+    BM11MeshFormat    _format;
+    std::vector<char> _buffer;
+    size_t            _fill;
+    uint64_t          _vertex_base;    /* OBJ indices are file-wide */
+    uint64_t          _triangle_count;
+    int               _decimals;
+    bool              _error;
+};
+
+/* Sweeps `sweep` and writes every valid design to directory/<index>.stl
+   (or .obj), one mesh and writer per thread. `failed` (may be NULL)
+   receives the number of files that could not be written. */
+BM11SweepStats BM11RunMeshSweep(const BM11SweepConfig *sweep, const BM11MeshConfig *mesh,
+                                BM11MeshFormat format, const char *directory, uint64_t *failed);
+
+#endif /* BM11_MESH_H */
@@ -0,0 +1,550 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <stddef.h>
+#include <vector>
+#include "BM11Model.h"
+#include "BM11Fields.h"
+#include "BM11Profile.h"
+#include "BM11ResultCache.h"
+#include "BM11Wind.h"
+
+float sq(float x)
+{
+    return (x * x);
+}
+
+void BMVector3Print(BMVector3 v)
+{
+    printf("[ %.3f, %.3f, %.3f ]\n", v.x, v.y, v.z);
+}
+
+BM11Model::InputParameters BM11Model::getDefaultInputParameters(void)
+{
+    InputParameters p;
+
+    p.squareSideLength     = 16.0f;
+    p.baseCutBackLength    = 2.0f;
+    p.angle_ABC            = BMMathDegreesToRadians(110.0f);
+    p.frameCrossSection    = BMVector2Make(0.75f, 1.5f); /* in      */
+    p.frameWallThickness   = (1.0f / 16.0f);              /* in      */
+    p.metalDensity         = 0.289f;                      /* lb/in^3 */
+    p.shoulderHeight       = 5.0f;                        /* ft      */
+    p.mirrorBoltSpacing    = 2.0f;                        /* ft      */
+
+    p.unit_cost.frameMetal = 4.4f;                    /* $ / ft   */
+    p.unit_cost.mirror     = (220.0f / (8.0f * 4.0)); /* $ / ft^2 */
+    /* McMaster Part #90585A537
+       316 Stainless Steel Hex Drive Flat Head Screw, 
+       82 Degree Countersink Angle, 1/4"-20 Thread Size, 1/2" Long.
+       Sold in bags of 10 */
+    p.unit_cost.mirrorBolt = (3.67f / 10.0f); /* $ / each */
+    p.unit_cost.frameThroughHoleDrill = (695.0f / 160.0f); /* $695 for 160 holes at 1/4" dia from Bayshore */
+    p.unit_cost.frameThroughHoleTap   = (480.0f / 320.0f); /* $480 for 320 tap plunges 1/4-20 from Bayshore */
+
+    return p;
+}
+
+void BM11Model::printInputParameters(InputParameters params)
+{
+    (void)params;
+}
+
+void BM11Model::printOutputParameters(OutputParameters params)
+{
+    OutputParameters *op = &params;
+
+    printf("Edge lengths:\n");
+    printf("   OB = %.3f ft\n", op->edge_length.OB);
+    printf("   BA = %.3f ft\n", op->edge_length.BA);
+    printf("   OA = %.3f ft\n", op->edge_length.OA);
+    printf("   AC = %.3f ft\n", op->edge_length.AC);
+
+    printf("Scalene triangle OBA and OBC vertex angles:\n");
+    printf("   angle_OAB = angle_OCB = %.3f degrees\n", BMMathRadiansToDegrees(op->vertex_angle.angle_OAB));
+    printf("   angle_AOB = angle_COB = %.3f degrees\n", BMMathRadiansToDegrees(op->vertex_angle.angle_AOB));
+    printf("   angle_ABO = angle_CBO = %.3f degrees\n", BMMathRadiansToDegrees(op->vertex_angle.angle_ABO));
+
+    printf("Isoceles triangle ABC vertex angles:\n");
+    printf("   angle_ABC             = %.3f degrees\n", BMMathRadiansToDegrees(op->vertex_angle.angle_ABC));
+    printf("   angle_BAC = angle_BCA = %.3f degrees\n", BMMathRadiansToDegrees(op->vertex_angle.angle_BAC));
+
+    printf("Isoceles triangle AOC vertex angles:\n");
+    printf("   angle_AOC             = %.3f degrees\n", BMMathRadiansToDegrees(op->vertex_angle.angle_AOC));
+    printf("   angle_OAC = angle_OCA = %.3f degrees\n", BMMathRadiansToDegrees(op->vertex_angle.angle_OAC));
+
+    printf("Vertex coordinates:\n");
+    printf("   O  = "); BMVector3Print(op->vertex_coord.O);
+    printf("   B0 = "); BMVector3Print(op->vertex_coord.B0);
+    printf("   A0 = "); BMVector3Print(op->vertex_coord.A0);
+    printf("   C0 = "); BMVector3Print(op->vertex_coord.C0);
+    printf("   B1 = "); BMVector3Print(op->vertex_coord.B1);
+    printf("   A1 = "); BMVector3Print(op->vertex_coord.A1);
+    printf("   C1 = "); BMVector3Print(op->vertex_coord.C1);
+
+    printf("Structural shape summary:\n");
+    printf("   Footprint dimensions   = [%.3f, %.3f] ft\n", op->overall_structure.footprint.x, op->overall_structure.footprint.y);
+    printf("   Footprint surface area = %.3f ft^2\n", op->overall_structure.footprint_area);
+    printf("   Footprint aspect ratio = %.3f\n", op->overall_structure.footprint_aspect_ratio);
+    printf("   Height                 = %.3f ft\n", op->overall_structure.height);
+    printf("   Triangle surface area  = %.3f ft^2\n", op->overall_structure.triangle_area);
+    printf("   Walkway top angle      = %.3f degrees\n", BMMathRadiansToDegrees(op->overall_structure.walkway_top_angle));
+    printf("   Walkway base width     = %.3f ft\n", op->overall_structure.walkway_base_width);
+    printf("   Walkway shoulder width = %.3f ft\n", op->overall_structure.walkway_shoulder_width);
+
+    printf("Important dihedral angles:\n");
+    printf("   Between triangle pairs (angle_BOA_BOC)      = %.3f degrees\n", BMMathRadiansToDegrees(op->dihedral_angle.angle_BOA_BOC));
+    printf("   Between triangle and ground (angle_BOA_ABC) = %.3f degrees\n", BMMathRadiansToDegrees(op->dihedral_angle.angle_BOA_ABC));
+
+    printf("Frame info:\n");
+    printf("   Perimeter length         = %.3f ft\n", op->frame.perimeter_length);
+    printf("   Reinforce length         = %.3f ft\n", op->frame.reinforce_length);
+    printf("   Total length             = %.3f ft\n", op->frame.total_length);
+    printf("   Metal volume             = %.3f in^3 (%.3f ft^3)\n", op->frame.metal_volume, op->frame.metal_volume / (12.0f * 12.0f * 12.0f));
+    printf("   Metal Mass               = %.3f lb\n", op->frame.metal_mass);
+    printf("   Metal Cost               = $%.3f\n", op->frame.metal_cost);
+    printf("   Drill Count              = %.3f\n", op->frame.drill_count);
+    printf("   Drill Cost               = $%.3f\n", op->frame.drill_cost);
+    printf("   Tap Count                = %.3f\n", op->frame.tap_count);
+    printf("   Tap Cost                 = $%.3f\n", op->frame.tap_cost);
+    
+    printf("Mirror coating info:\n");
+    printf("   Total surface area       = %.3f ft^2\n", op->mirror.surface_area);
+    printf("   Mirror cost              = $%.3f\n", op->mirror.cost);
+    printf("   Mirror bolt count        = %f\n", op->mirror.bolt_count);
+    printf("   Mirror bolt cost         = $%.3f\n", op->mirror.bolt_cost);
+    
+    /* Force tables at 0 degrees (wind along X, YZ plane) and 90 degrees (along Z, XY plane) */
+    BM11WindGrid grid;
+    BM11WindGridInit(&grid);
+    grid.direction_count = 4;
+    std::vector<float> force(BM11WindForceCount(&grid));
+    BM11WindEvaluate(&grid, op, 1, NULL, force.data());
+
+    printf("Wind:\n");
+    printf("   XY plane:\n");
+    printf("      Total surface area = %.3f ft^2\n", op->wind.total_surface_area_XY);
+    for (uint32_t s = 0; s < grid.speed_count; s++) {
+        printf("      Side force at %f MPH = %.0f lbs\n", grid.speed_mph[s], force[1 * grid.speed_count + s]);
+    }
+    printf("   YZ plane:\n");
+    printf("      Total surface area = %.3f ft^2\n", op->wind.total_surface_area_YZ);
+    for (uint32_t s = 0; s < grid.speed_count; s++) {
+        printf("      Side force at %f MPH = %.0f lbs\n", grid.speed_mph[s], force[0 * grid.speed_count + s]);
+    }
+
+    printf("Total:\n");
+    printf("   Mass: %.3f lb\n", op->total.mass);
+    printf("   Cost: $%.3f\n",   op->total.cost);
+}
+
+/* Dependency graph: the stages each stage reads from */
+static const unsigned int stageInputs[BM11Model::StageCount] = {
+    /* StageEdges            */ 0,
+    /* StageValidation       */ (1u << BM11Model::StageEdges),
+    /* StageVertexCoords     */ (1u << BM11Model::StageEdges) | (1u << BM11Model::StageValidation),
+    /* StageOverallStructure */ (1u << BM11Model::StageVertexCoords),
+    /* StageDihedrals        */ (1u << BM11Model::StageVertexCoords),
+    /* StageFrame            */ (1u << BM11Model::StageEdges) | (1u << BM11Model::StageOverallStructure),
+    /* StageMirror           */ (1u << BM11Model::StageOverallStructure) | (1u << BM11Model::StageFrame),
+    /* StageWind             */ (1u << BM11Model::StageVertexCoords),
+    /* StageTotals           */ (1u << BM11Model::StageFrame) | (1u << BM11Model::StageMirror),
+};
+
+/* The stage that reads each input field directly */
+static BM11Model::Stage fieldStage(int field)
+{
+    switch (field) {
+        case BM11InputField_squareSideLength:
+        case BM11InputField_baseCutBackLength:
+        case BM11InputField_angle_ABC:
+            return BM11Model::StageEdges;
+        case BM11InputField_shoulderHeight:
+            return BM11Model::StageOverallStructure;
+        case BM11InputField_unit_cost_mirror:
+        case BM11InputField_unit_cost_mirrorBolt:
+            return BM11Model::StageMirror;
+        default:
+            /* Cross section, wall thickness, density, bolt spacing, frame metal, drill and tap costs */
+            return BM11Model::StageFrame;
+    }
+}
+
+unsigned int BM11Model::getStagesAffectedBy(int field)
+{
+    unsigned int stages = (1u << fieldStage(field));
+
+    /* Stages are declared in topological order, so one forward pass closes the set */
+    for (int stage = 0; stage < StageCount; stage++) {
+        if (stageInputs[stage] & stages) {
+            stages |= (1u << stage);
+        }
+    }
+    return stages;
+}
+
+void BM11Model::setInputParameters(InputParameters params)
+{
+    for (int field = 0; field < BM11InputField_Count; field++) {
+        float value = BM11GetInputField(&params, field);
+        float old   = BM11GetInputField(&_inputParams, field);
+        if (memcmp(&value, &old, sizeof(float)) != 0) {
+            _dirty_stages |= getStagesAffectedBy(field);
+        }
+    }
+    _inputParams = params;
+}
+
+void BM11Model::setInputParameter(int field, float value)
+{
+    float old = BM11GetInputField(&_inputParams, field);
+
+    if (memcmp(&value, &old, sizeof(float)) != 0) {
+        BM11SetInputField(&_inputParams, field, value);
+        _dirty_stages |= getStagesAffectedBy(field);
+    }
+}
+
+bool BM11Model::evaluate(void)
+{
+    unsigned int stages = _dirty_stages;
+
+    _dirty_stages = 0;
+    BM11_PROFILE_COUNT(BM11ProfileEvaluations);
+
+    /* Re-running only the cost stages is cheaper than a cache lookup, so the
+       cache is only consulted when the geometry has to be solved again */
+    if (!_cache || !(stages & (1u << StageEdges))) {
+        return evaluateStages(stages);
+    }
+    if (_cache->lookup(&_inputParams, &_outputParams, &_status)) {
+        BM11_PROFILE_COUNT(BM11ProfileCacheHits);
+        /* The hit stands in for the edges and validation stages, so a cached
+           rejection counts as one */
+        if (_status != StatusOK) {
+            BM11_PROFILE_COUNT(BM11ProfileValidationFailures);
+            return true;
+        }
+        return false;
+    }
+    BM11_PROFILE_COUNT(BM11ProfileCacheMisses);
+    bool failed = evaluateStages(stages);
+    _cache->insert(&_inputParams, &_outputParams, _status);
+    return failed;
+}
+
+bool BM11Model::evaluateStages(unsigned int stages)
+{
+    if (stages & (1u << StageEdges)) {
+        BM11_PROFILE_STAGE(StageEdges, _status = evaluateEdges(&_inputParams, &_outputParams));
+    }
+    if ((stages & (1u << StageValidation)) && (_status == StatusOK)) {
+        BM11_PROFILE_STAGE(StageValidation, _status = evaluateValidation(&_inputParams, &_outputParams));
+    }
+    if (_status != StatusOK) {
+        /* Nothing past the vertex angles is meaningful */
+        memset(&_outputParams.vertex_coord, 0,
+               sizeof(_outputParams) - offsetof(OutputParameters, vertex_coord));
+        /* Validation is only dirty along with the edges; a cost-only edit of
+           a rejected design keeps the earlier rejection and isn't counted */
+        if (stages & (1u << StageEdges)) {
+            BM11_PROFILE_COUNT(BM11ProfileValidationFailures);
+        }
+        return true;
+    }
+
+    if (stages & (1u << StageVertexCoords))     BM11_PROFILE_STAGE(StageVertexCoords,     evaluateVertexCoords(&_inputParams, &_outputParams));
+    if (stages & (1u << StageOverallStructure)) BM11_PROFILE_STAGE(StageOverallStructure, evaluateOverallStructure(&_inputParams, &_outputParams));
+    if (stages & (1u << StageDihedrals))        BM11_PROFILE_STAGE(StageDihedrals,        evaluateDihedrals(&_inputParams, &_outputParams));
+    if (stages & (1u << StageFrame))            BM11_PROFILE_STAGE(StageFrame,            evaluateFrame(&_inputParams, &_outputParams));
+    if (stages & (1u << StageMirror))           BM11_PROFILE_STAGE(StageMirror,           evaluateMirror(&_inputParams, &_outputParams));
+    if (stages & (1u << StageWind))             BM11_PROFILE_STAGE(StageWind,             evaluateWind(&_inputParams, &_outputParams));
+    if (stages & (1u << StageTotals))           BM11_PROFILE_STAGE(StageTotals,           evaluateTotals(&_inputParams, &_outputParams));
+
+    return false;
+}
+
+void BM11Model::evaluateDerivedStages(unsigned int stages, const InputParameters *ip, OutputParameters *op)
+{
+    if (stages & (1u << StageVertexCoords))     evaluateVertexCoords(ip, op);
+    if (stages & (1u << StageOverallStructure)) evaluateOverallStructure(ip, op);
+    if (stages & (1u << StageDihedrals))        evaluateDihedrals(ip, op);
+    if (stages & (1u << StageFrame))            evaluateFrame(ip, op);
+    if (stages & (1u << StageMirror))           evaluateMirror(ip, op);
+    if (stages & (1u << StageWind))             evaluateWind(ip, op);
+    if (stages & (1u << StageTotals))           evaluateTotals(ip, op);
+}
+
+const char *BM11Model::getStageString(Stage stage)
+{
+    switch (stage) {
+        case StageEdges:            return "edges";
+        case StageValidation:       return "validation";
+        case StageVertexCoords:     return "vertex_coords";
+        case StageOverallStructure: return "overall_structure";
+        case StageDihedrals:        return "dihedrals";
+        case StageFrame:            return "frame";
+        case StageMirror:           return "mirror";
+        case StageWind:             return "wind";
+        case StageTotals:           return "totals";
+        default:                    return "unknown";
+    }
+}
+
+const char *BM11Model::getStatusString(Status status)
+{
+    switch (status) {
+        case StatusOK:                 return "OK";
+        case StatusNonPositiveEdge:    return "Invalid tetrahedron: non-positive edge length";
+        case StatusTriangleInequality: return "Invalid tetrahedron: face violates the triangle inequality";
+        case StatusDegenerateVolume:   return "Invalid tetrahedron: edges enclose no volume";
+        case StatusLawOfSines:         return "Invalid tetrahedron: 3D law of sines check failed";
+        default:                       return "Unknown status";
+    }
+}
+
+BM11Model::Status BM11Model::checkEdgeFeasibility(float OB, float BA, float OA, float AC)
+{
+    /* Negated compares so NaN edges are rejected too */
+    if (!(OB > 0.0f) || !(BA > 0.0f) || !(OA > 0.0f) || !(AC > 0.0f)) {
+        return StatusNonPositiveEdge;
+    }
+
+    /* Faces OAB and OCB have edges (OA, OB, BA), OAC has (OA, OA, AC) and ABC has (BA, BA, AC) */
+    if (((OA + OB) <= BA) || ((OA + BA) <= OB) || ((OB + BA) <= OA) ||
+        ((2.0f * OA) <= AC) || ((2.0f * BA) <= AC)) {
+        return StatusTriangleInequality;
+    }
+
+    /* Cayley-Menger: with p, q, r the edges from O to A, B, C and a, b, c the
+       opposite edges BC, CA, AB,
+         144 V^2 = p2 a2 (q2 + r2 + b2 + c2 - p2 - a2) + q2 b2 (p2 + r2 + a2 + c2 - q2 - b2)
+                 + r2 c2 (p2 + q2 + a2 + b2 - r2 - c2) - p2 q2 c2 - q2 r2 a2 - r2 p2 b2 - a2 b2 c2
+       Here r = p = OA, q = OB, a = c = BA and b = AC. */
+    double p2  = (double)OA * OA;
+    double q2  = (double)OB * OB;
+    double a2  = (double)BA * BA;
+    double b2  = (double)AC * AC;
+    double v2  = (p2 * a2 * (q2 + b2))
+               + (q2 * b2 * (p2 + p2 + a2 + a2 - q2 - b2))
+               + (p2 * a2 * (q2 + b2))
+               - (p2 * q2 * a2) - (q2 * p2 * a2) - (p2 * p2 * b2) - (a2 * b2 * a2);
+    double max = (OA > OB) ? OA : OB;
+    max        = (max > BA) ? max : BA;
+    if (v2 <= (1e-6 * max * max * max * max * max * max)) {
+        return StatusDegenerateVolume;
+    }
+    return StatusOK;
+}
+
+BM11Model::Status BM11Model::checkFeasibility(const InputParameters *ip)
+{
+    float OB = sqrtf(sq(ip->squareSideLength) + sq(ip->baseCutBackLength));
+    float BA = (ip->squareSideLength - ip->baseCutBackLength);
+    float OA = sqrtf(2.0f * sq(ip->squareSideLength));
+    float AC = (2.0f * BA * sin(ip->angle_ABC * 0.5f));
+
+    return checkEdgeFeasibility(OB, BA, OA, AC);
+}
+
+BM11Model::Status BM11Model::evaluateEdges(const InputParameters *ip, OutputParameters *op)
+{
+    /* Calculate lengths of all tetrahedron edges */
+    op->edge_length.OB = sqrtf((ip->squareSideLength * ip->squareSideLength) +
+                              (ip->baseCutBackLength * ip->baseCutBackLength));
+    op->edge_length.BA = (ip->squareSideLength - ip->baseCutBackLength);
+    op->edge_length.OA = sqrtf(2.0f * ip->squareSideLength * ip->squareSideLength);
+    op->edge_length.AC = (2.0f * op->edge_length.BA * sin(ip->angle_ABC * 0.5f));
+
+    /* Reject impossible edge sets before any of the trig below */
+    Status status = checkEdgeFeasibility(op->edge_length.OB, op->edge_length.BA, op->edge_length.OA, op->edge_length.AC);
+    if (status != StatusOK) {
+        memset(&op->vertex_angle, 0, sizeof(op->vertex_angle));
+        return status;
+    }
+
+    /* Compute angles of all triangles in the tetrahedron */
+    /* Scalene triangles OBA and OBC: computed via triangle cosine law */
+    op->vertex_angle.angle_OAB = acosf((sq(op->edge_length.OA) + sq(op->edge_length.BA) - sq(op->edge_length.OB)) /
+                                      (2.0f * op->edge_length.OA * op->edge_length.BA));
+    op->vertex_angle.angle_AOB = acosf((sq(op->edge_length.OA) + sq(op->edge_length.OB) - sq(op->edge_length.BA)) /
+                                      (2.0f * op->edge_length.OA * op->edge_length.OB));
+    op->vertex_angle.angle_ABO = (M_PI - op->vertex_angle.angle_OAB - op->vertex_angle.angle_AOB);
+    op->vertex_angle.angle_OCB = op->vertex_angle.angle_OAB;
+    op->vertex_angle.angle_COB = op->vertex_angle.angle_AOB;
+    op->vertex_angle.angle_CBO = op->vertex_angle.angle_ABO;
+
+    /* Isoceles triangle ABC */
+    op->vertex_angle.angle_ABC = ip->angle_ABC;
+    op->vertex_angle.angle_BAC = (M_PI - op->vertex_angle.angle_ABC) * 0.5f;
+    op->vertex_angle.angle_BCA = op->vertex_angle.angle_BAC;
+
+    /* Isoceles triangle AOC */
+    op->vertex_angle.angle_AOC = (2.0f * asin(op->edge_length.AC / (2.0f * op->edge_length.OA)));
+    op->vertex_angle.angle_OAC = (M_PI - op->vertex_angle.angle_AOC) * 0.5f;
+    op->vertex_angle.angle_OCA = op->vertex_angle.angle_OAC;
+
+    return StatusOK;
+}
+
+BM11Model::Status BM11Model::evaluateValidation(const InputParameters *ip, OutputParameters *op)
+{
+    (void)ip;
+    /* Validate the tetrahedron via the 3D law of sines */
+    float epsilon = (1.0f / 1000.0f);
+    /* O,ABC */
+    {
+        float lhs = (sin(op->vertex_angle.angle_OAC) * sin(op->vertex_angle.angle_OCB) * sin(op->vertex_angle.angle_ABO));
+        float rhs = (sin(op->vertex_angle.angle_OCA) * sin(op->vertex_angle.angle_CBO) * sin(op->vertex_angle.angle_OAB));
+        if (fabsf(lhs - rhs) > epsilon) {
+            return StatusLawOfSines;
+        }
+    }
+    /* A,OBC */
+    {
+        float lhs = (sin(op->vertex_angle.angle_AOC) * sin(op->vertex_angle.angle_BCA) * sin(op->vertex_angle.angle_ABO));
+        float rhs = (sin(op->vertex_angle.angle_OCA) * sin(op->vertex_angle.angle_ABC) * sin(op->vertex_angle.angle_AOB));
+        if (fabsf(lhs - rhs) > epsilon) {
+            return StatusLawOfSines;
+        }
+    }
+    /* B,AOC */
+    {
+        float lhs = (sin(op->vertex_angle.angle_BAC) * sin(op->vertex_angle.angle_OCB) * sin(op->vertex_angle.angle_AOB));
+        float rhs = (sin(op->vertex_angle.angle_BCA) * sin(op->vertex_angle.angle_COB) * sin(op->vertex_angle.angle_OAB));
+        if (fabsf(lhs - rhs) > epsilon) {
+            return StatusLawOfSines;
+        }
+    }
+    /* C,ABO */
+    {
+        float lhs = (sin(op->vertex_angle.angle_OAC) * sin(op->vertex_angle.angle_COB) * sin(op->vertex_angle.angle_ABC));
+        float rhs = (sin(op->vertex_angle.angle_AOC) * sin(op->vertex_angle.angle_CBO) * sin(op->vertex_angle.angle_BAC));
+        if (fabsf(lhs - rhs) > epsilon) {
+            return StatusLawOfSines;
+        }
+    }
+    return StatusOK;
+}
+
+void BM11Model::evaluateVertexCoords(const InputParameters *ip, OutputParameters *op)
+{
+    (void)ip;
+    /* Compute vertex positions for the first tetrahedron */
+    float      length_AM = op->edge_length.AC * 0.5f; /* M is at the midpoint between A and C */
+    op->vertex_coord.A0 = BMVector3Make(-length_AM, 0, 0);
+    op->vertex_coord.C0 = BMVector3Make(+length_AM, 0, 0);
+    op->vertex_coord.B0 = BMVector3Make(0, 0, sqrtf(sq(op->edge_length.BA) - sq(length_AM)));
+    op->vertex_coord.O.x = 0;
+    op->vertex_coord.O.z = ((sq(op->edge_length.OB) - sq(op->edge_length.OA) + sq(length_AM) - sq(op->vertex_coord.B0.z)) / 
+           (-2.0f * op->vertex_coord.B0.z));
+    op->vertex_coord.O.y = sqrtf(sq(op->edge_length.OA) - sq(length_AM) - sq(op->vertex_coord.O.z));
+
+    /* Translate first tetrahedron such that O.xz = 0 */
+    op->vertex_coord.A0.z -= op->vertex_coord.O.z;
+    op->vertex_coord.B0.z -= op->vertex_coord.O.z;
+    op->vertex_coord.C0.z -= op->vertex_coord.O.z;
+    op->vertex_coord.O.z = 0;
+    
+    /* Second tetrahedron ABC is just first tetrahedron ABC with Z negated */
+    op->vertex_coord.A1 = BMVector3Multiply(op->vertex_coord.A0, BMVector3Make(1.0f, 1.0f, -1.0f));
+    op->vertex_coord.B1 = BMVector3Multiply(op->vertex_coord.B0, BMVector3Make(1.0f, 1.0f, -1.0f));
+    op->vertex_coord.C1 = BMVector3Multiply(op->vertex_coord.C0, BMVector3Make(1.0f, 1.0f, -1.0f));
+}
+
+void BM11Model::evaluateOverallStructure(const InputParameters *ip, OutputParameters *op)
+{
+    /* Overall structure stats */
+    op->overall_structure.footprint              = BMVector2Make(op->vertex_coord.C0.x - op->vertex_coord.A0.x,
+                                                                 op->vertex_coord.A1.z - op->vertex_coord.A0.z);
+    op->overall_structure.footprint_area         = (op->overall_structure.footprint.x * op->overall_structure.footprint.y);
+    op->overall_structure.footprint_aspect_ratio = (op->overall_structure.footprint.x / op->overall_structure.footprint.y);
+    op->overall_structure.height                 = op->vertex_coord.O.y;
+    op->overall_structure.triangle_area          = BMVector3Length(BMVector3CrossProduct(BMVector3Subtract(op->vertex_coord.O, op->vertex_coord.B0),
+                                                                                          BMVector3Subtract(op->vertex_coord.A0, op->vertex_coord.B0))) * 0.5f;
+    op->overall_structure.walkway_top_angle      = atanf(op->vertex_coord.B1.z / op->vertex_coord.O.y) * 2.0f;
+    op->overall_structure.walkway_base_width     = op->vertex_coord.B1.z - op->vertex_coord.B0.z;
+    op->overall_structure.walkway_shoulder_width = ((op->vertex_coord.O.y - ip->shoulderHeight) * op->vertex_coord.B1.z * 2.0f) / op->vertex_coord.O.y;
+}
+
+void BM11Model::evaluateDihedrals(const InputParameters *ip, OutputParameters *op)
+{
+    (void)ip;
+    /* Important dihedral angles */
+    BMVector3 BO            = BMVector3Subtract(op->vertex_coord.B0, op->vertex_coord.O);
+    BMVector3 BA            = BMVector3Subtract(op->vertex_coord.B0, op->vertex_coord.A0);
+    BMVector3 BC            = BMVector3Subtract(op->vertex_coord.B0, op->vertex_coord.C0);
+    BMVector3 norm_BOA      = BMVector3Normalize(BMVector3CrossProduct(BO, BA));
+    BMVector3 norm_BOC      = BMVector3Normalize(BMVector3CrossProduct(BO, BC));
+    BMVector3 norm_ABC      = BMVector3Make(0.0f, 1.0f, 0.0f);
+    op->dihedral_angle.angle_BOA_BOC = acosf(BMVector3DotProduct(norm_BOA, norm_BOC));
+    op->dihedral_angle.angle_BOA_ABC = acosf(BMVector3DotProduct(norm_BOA, norm_ABC));
+}
+
+void BM11Model::evaluateFrame(const InputParameters *ip, OutputParameters *op)
+{
+    /* Frame info */
+    op->frame.perimeter_length    = ((op->edge_length.BA * 4) + 
+                                    (op->edge_length.OA * 4) + 
+                                    (op->edge_length.OB * 4));
+    /* Shitty estimate on reinforcement.  Need to design first, but assuming 3 per triangle, so this is approx.
+       Also, one cross-bar between B0 and B1 */
+    op->frame.reinforce_length    = (op->edge_length.BA * 1.6 * 4) + op->overall_structure.walkway_base_width;
+    op->frame.total_length        = (op->frame.perimeter_length + op->frame.reinforce_length);
+    float      xsection_area      = (ip->frameCrossSection.x *
+                                     ip->frameCrossSection.y);
+    BMVector2 xsection_inner_dim = BMVector2Make(ip->frameCrossSection.x - (ip->frameWallThickness * 2.0f),
+                                                   ip->frameCrossSection.y - (ip->frameWallThickness * 2.0f));
+    float      xsection_inner_area = (xsection_inner_dim.x * xsection_inner_dim.y);
+    float      xsection_metal_area = (xsection_area - xsection_inner_area);
+    op->frame.metal_volume        = (xsection_metal_area * (op->frame.total_length * 12.0f));
+    op->frame.metal_mass          = (op->frame.metal_volume * ip->metalDensity);
+    op->frame.metal_cost          = (op->frame.total_length * ip->unit_cost.frameMetal);
+    op->frame.drill_count         = (op->frame.total_length / ip->mirrorBoltSpacing);
+    op->frame.drill_cost          = (op->frame.drill_count * ip->unit_cost.frameThroughHoleDrill);
+    op->frame.tap_count           = (op->frame.drill_count * 2.0f); /* x 2 due to double sided mirror attachment */
+    op->frame.tap_cost            = (op->frame.tap_count * ip->unit_cost.frameThroughHoleTap);
+}
+
+void BM11Model::evaluateMirror(const InputParameters *ip, OutputParameters *op)
+{
+    /* Mirror assembly */
+    op->mirror.surface_area = (op->overall_structure.triangle_area * 8.0f); /* 8 triangles */
+    op->mirror.cost         = (op->mirror.surface_area * ip->unit_cost.mirror);
+    op->mirror.bolt_count   = op->frame.tap_count;
+    op->mirror.bolt_cost    = (op->mirror.bolt_count * ip->unit_cost.mirrorBolt);
+}
+
+void BM11Model::evaluateWind(const InputParameters *ip, OutputParameters *op)
+{
+    (void)ip;
+    /* Wind force calculations */
+    /* Project triangle(OBA) onto XY plane */
+    BMVector3 ApXY = BMVector3Multiply(op->vertex_coord.A0, BMVector3Make(1.0f, 1.0f, 0.0f));
+    BMVector3 BpXY = BMVector3Multiply(op->vertex_coord.B0, BMVector3Make(1.0f, 1.0f, 0.0f));
+    BMVector3 OpXY = BMVector3Multiply(op->vertex_coord.O,  BMVector3Make(1.0f, 1.0f, 0.0f));
+    /* Compute projected surface area */
+    float      triangle_surface_area_XY = (BMVector3Length(BMVector3CrossProduct(BMVector3Subtract(BpXY, ApXY),
+                                                                                   BMVector3Subtract(BpXY, OpXY))) * 0.5f);
+    op->wind.total_surface_area_XY = (triangle_surface_area_XY * 2.0f);
+    /* Project triangle(OBA) onto YZ plane */
+    BMVector3 ApYZ = BMVector3Multiply(op->vertex_coord.A0, BMVector3Make(0.0f, 1.0f, 1.0f));
+    BMVector3 BpYZ = BMVector3Multiply(op->vertex_coord.B0, BMVector3Make(0.0f, 1.0f, 1.0f));
+    BMVector3 OpYZ = BMVector3Multiply(op->vertex_coord.O,  BMVector3Make(0.0f, 1.0f, 1.0f));
+    /* Compute projected surface area */
+    float      triangle_surface_area_YZ = (BMVector3Length(BMVector3CrossProduct(BMVector3Subtract(BpYZ, ApYZ),
+                                                                                   BMVector3Subtract(BpYZ, OpYZ))) * 0.5f);
+    op->wind.total_surface_area_YZ = (triangle_surface_area_YZ * 2.0f);
+}
+
+void BM11Model::evaluateTotals(const InputParameters *ip, OutputParameters *op)
+{
+    (void)ip;
+    /* Totals */
+    op->total.mass = op->frame.metal_mass; /* TODO: Mirror and bolts */
+    op->total.cost = (op->frame.metal_cost + 
+                      op->frame.drill_cost + 
+                      op->frame.tap_cost   + 
+                      op->mirror.cost      + 
+                      op->mirror.bolt_cost);
+}
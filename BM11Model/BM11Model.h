@@ -0,0 +1,244 @@
+#ifndef BM11_MODEL_H
+#define BM11_MODEL_H
+
+#include "BM11Math.h"
+
+/*
+                        O
+                       /|\
+                      / | \
+                     /  |  \
+                    /   |   \
+                   /    |    \
+                  /     |     \
+                 /      |      \
+                /       |       \
+               /        |        \
+              /         |         \
+             /         -Bn         \
+            /       -/     \-       \
+           /     -/           \-     \
+          /   -/                 \-   \
+         / -/                       \- \
+        /. . . . . . . . . . . . . . . .\
+      An                                  Cn
+
+      Geometric Constraints:
+      ---------------------
+      - An, Bn, Cn and O are vertices of an irregular tetrahedron
+      - The overall structure has two identical tetrahedrons with O as common vertex
+      - OBA, OBC are identical scalene triangles
+      - ABC is an isoceles triangle
+      - AOC is an isoceles triangle
+      - length(OA) = length(OC)
+      - length(BA) = length(BC)
+
+ */
+
+
+class BM11ResultCache;
+
+class BM11Model {
+public:
+    BM11Model(void) {
+        _inputParams  = BM11Model::getDefaultInputParameters();
+        _dirty_stages = AllStages;
+        _status       = StatusOK;
+        _cache        = NULL;
+    };
+
+    ~BM11Model(void) {
+    };
+
+    typedef struct {
+        float      squareSideLength;   /* Size of the starting square forming one of the triangles */
+        float      baseCutBackLength;  /* Cut back on base of square to form the triangle          */
+        float      angle_ABC;          /* Angle on the ground plane between the two triangles      */
+        BMVector2 frameCrossSection;  /* Cross section dimensions (in)                            */
+        float      frameWallThickness; /* Wall thickness (in)                                      */
+        float      metalDensity;       /* lb/in^3                                                  */
+        float      shoulderHeight;     /* ft                                                       */
+        float      mirrorBoltSpacing;  /* ft                                                       */
+
+        struct {
+            float frameMetal;            /* $ / ft   */
+            float mirror;                /* $ / ft^2 */
+            float mirrorBolt;            /* $ / each */
+            float frameThroughHoleDrill; /* $ / each */
+            float frameThroughHoleTap;   /* $ / each */
+        } unit_cost;
+
+    } InputParameters;
+    
+    typedef struct {
+        struct {
+            float OB;
+            float BA;
+            float OA;
+            float AC;
+        } edge_length;
+        struct {
+            float angle_OAB;
+            float angle_AOB;
+            float angle_ABO;
+            float angle_OCB;
+            float angle_COB;
+            float angle_CBO;
+            float angle_ABC;
+            float angle_BAC;
+            float angle_BCA;
+            float angle_AOC;
+            float angle_OAC;
+            float angle_OCA;
+        } vertex_angle;
+        struct {
+            BMVector3 A0;
+            BMVector3 C0;
+            BMVector3 B0;
+            BMVector3 O;
+            BMVector3 A1;
+            BMVector3 B1;
+            BMVector3 C1;
+        } vertex_coord;
+        struct {
+            BMVector2 footprint;
+            float      footprint_area;
+            float      footprint_aspect_ratio;
+            float      height;
+            float      triangle_area;
+            float      walkway_top_angle;
+            float      walkway_base_width;
+            float      walkway_shoulder_width;
+        } overall_structure;
+        struct {
+            float      angle_BOA_BOC;
+            float      angle_BOA_ABC;
+        } dihedral_angle;
+        struct { 
+            float      perimeter_length;
+            float      reinforce_length;
+            float      total_length;
+            float      metal_volume;
+            float      metal_mass;
+            float      metal_cost;
+            float      drill_count; /* Through drill,  both sides of box section */
+            float      drill_cost;
+            float      tap_count;
+            float      tap_cost;
+        } frame;
+        struct {
+            float      surface_area;
+            float      cost;
+            float      bolt_count;
+            float      bolt_cost;
+        } mirror;
+        struct {
+            float      total_surface_area_XY;
+            float      total_surface_area_YZ;
+        } wind;
+        struct {
+            float mass;
+            float cost;
+        } total;
+    } OutputParameters;
+
+    /* evaluate() runs as a chain of stages, in this (topological) order. Each
+       input field feeds some stages and everything downstream of them is
+       re-run when it changes; see getStagesAffectedBy(). */
+    typedef enum {
+        StageEdges = 0,        /* Edge lengths and vertex angles             */
+        StageValidation,       /* 3D law of sines                            */
+        StageVertexCoords,     /* Vertex positions of both tetrahedrons      */
+        StageOverallStructure, /* Footprint, height, walkway                 */
+        StageDihedrals,        /* Dihedral angles                            */
+        StageFrame,            /* Frame lengths, mass, drilling and costs    */
+        StageMirror,           /* Mirror area, bolts and costs               */
+        StageWind,             /* Projected wind surface areas               */
+        StageTotals,           /* Total mass and cost                        */
+        StageCount
+    } Stage;
+
+    enum { AllStages = (1u << StageCount) - 1 };
+
+    /* Why a design was rejected. Everything past the vertex angles (and, for
+       the pre-check failures, the vertex angles too) is zero for a rejected
+       design. */
+    typedef enum {
+        StatusOK = 0,
+        StatusNonPositiveEdge,    /* An edge length is zero, negative or NaN              */
+        StatusTriangleInequality, /* A face of the tetrahedron can't be a triangle        */
+        StatusDegenerateVolume,   /* Cayley-Menger determinant <= 0: no volume            */
+        StatusLawOfSines,         /* 3D law of sines check failed                         */
+        StatusCount
+    } Status;
+
+    static InputParameters getDefaultInputParameters(void);
+    static void            printInputParameters(InputParameters params);
+    static void            printOutputParameters(OutputParameters params);
+    static const char     *getStatusString(Status status);
+    static const char     *getStageString(Stage stage);
+
+    /* Algebraic feasibility test on the edge lengths alone: positive edges,
+       triangle inequalities on every face and a positive Cayley-Menger
+       determinant. Costs two square roots, one sine and a few multiplies. */
+    static Status          checkFeasibility(const InputParameters *ip);
+
+    /* Bit mask (1 << Stage) of the stages that must re-run when `field` (a
+       BM11InputField from BM11Fields.h) changes */
+    static unsigned int    getStagesAffectedBy(int field);
+
+    /* Runs `stages` (a Stage bit mask) past StageValidation, in order, on
+       outputs whose upstream fields are already filled in, e.g. the cost
+       stages on geometry from BM11Surrogate. Edges and validation are
+       ignored; use a model for those. */
+    static void            evaluateDerivedStages(unsigned int stages, const InputParameters *ip, OutputParameters *op);
+
+    /* Only the stages downstream of the fields that actually changed are
+       marked dirty */
+    void                   setInputParameters(InputParameters params);
+    void                   setInputParameter(int field, float value);
+    InputParameters        getInputParameters(void)                   { return _inputParams; };
+
+    /* Optional memo consulted whenever the geometry has to be re-solved.
+       Not owned; the same cache may be shared by many models and threads. */
+    void                   setResultCache(BM11ResultCache *cache)     { _cache = cache; };
+    BM11ResultCache       *getResultCache(void)                       { return _cache; };
+
+    OutputParameters       getOutputParameters(void) {
+        if (_dirty_stages) {
+            evaluate();
+        }
+        return _outputParams;
+    }
+
+    Status                 getStatus(void) {
+        if (_dirty_stages) {
+            evaluate();
+        }
+        return _status;
+    }
+
+private:
+    bool evaluate(void);
+    bool evaluateStages(unsigned int stages);
+
+    static Status checkEdgeFeasibility(float OB, float BA, float OA, float AC);
+
+    static Status evaluateEdges(const InputParameters *ip, OutputParameters *op);
+    static Status evaluateValidation(const InputParameters *ip, OutputParameters *op);
+    static void evaluateVertexCoords(const InputParameters *ip, OutputParameters *op);
+    static void evaluateOverallStructure(const InputParameters *ip, OutputParameters *op);
+    static void evaluateDihedrals(const InputParameters *ip, OutputParameters *op);
+    static void evaluateFrame(const InputParameters *ip, OutputParameters *op);
+    static void evaluateMirror(const InputParameters *ip, OutputParameters *op);
+    static void evaluateWind(const InputParameters *ip, OutputParameters *op);
+    static void evaluateTotals(const InputParameters *ip, OutputParameters *op);
+
+    InputParameters  _inputParams;
+    OutputParameters _outputParams;
+    unsigned int     _dirty_stages; /* Bit mask of stages to re-run         */
+    Status           _status;       /* Result of the edges and validation stages */
+    BM11ResultCache *_cache;
+};
+
+#endif /* BM11_MODEL_H */
@@ -0,0 +1,431 @@
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include <chrono>
+#include "BM11Batch.h"
+#include "BM11MonteCarlo.h"
+#include "BM11Parallel.h"
+
+/* BM11QuantileSketch */
+
+BM11QuantileSketch::BM11QuantileSketch(double relative_accuracy, double min_magnitude)
+{
+    _gamma            = (1.0 + relative_accuracy) / (1.0 - relative_accuracy);
+    _inv_log_gamma    = 1.0 / log(_gamma);
+    _min_magnitude    = min_magnitude;
+    _positive.offset  = 0;
+    _negative.offset  = 0;
+    _zero             = 0;
+    _count            = 0;
+}
+
+int BM11QuantileSketch::bucketIndex(double magnitude) const
+{
+    return (int)ceil(log(magnitude) * _inv_log_gamma);
+}
+
+/* Midpoint (in relative terms) of bucket (gamma^(index-1), gamma^index] */
+double BM11QuantileSketch::bucketValue(int index) const
+{
+    return (2.0 * pow(_gamma, index)) / (_gamma + 1.0);
+}
+
+void BM11QuantileSketch::storeAdd(Store *store, int index, uint64_t count)
+{
+    if (store->counts.empty()) {
+        store->offset = index;
+        store->counts.push_back(0);
+    } else if (index < store->offset) {
+        store->counts.insert(store->counts.begin(), (size_t)(store->offset - index), 0);
+        store->offset = index;
+    } else if (index >= store->offset + (int)store->counts.size()) {
+        store->counts.resize((size_t)(index - store->offset) + 1, 0);
+    }
+    store->counts[(size_t)(index - store->offset)] += count;
+}
+
+void BM11QuantileSketch::add(double value)
+{
+    if (value > _min_magnitude) {
+        storeAdd(&_positive, bucketIndex(value), 1);
+    } else if (value < -_min_magnitude) {
+        storeAdd(&_negative, bucketIndex(-value), 1);
+    } else {
+        _zero++;
+    }
+    _count++;
+}
+
+/* Both sketches must have the same relative accuracy */
+void BM11QuantileSketch::merge(const BM11QuantileSketch &other)
+{
+    for (size_t i = 0; i < other._positive.counts.size(); i++) {
+        if (other._positive.counts[i]) {
+            storeAdd(&_positive, other._positive.offset + (int)i, other._positive.counts[i]);
+        }
+    }
+    for (size_t i = 0; i < other._negative.counts.size(); i++) {
+        if (other._negative.counts[i]) {
+            storeAdd(&_negative, other._negative.offset + (int)i, other._negative.counts[i]);
+        }
+    }
+    _zero  += other._zero;
+    _count += other._count;
+}
+
+double BM11QuantileSketch::getQuantile(double q) const
+{
+    if (_count == 0) {
+        return NAN;
+    }
+    q = (q < 0.0) ? 0.0 : ((q > 1.0) ? 1.0 : q);
+    uint64_t rank = (uint64_t)(q * (double)(_count - 1));
+    uint64_t seen = 0;
+
+    /* Most negative first */
+    for (size_t i = _negative.counts.size(); i-- > 0;) {
+        seen += _negative.counts[i];
+        if (seen > rank) {
+            return -bucketValue(_negative.offset + (int)i);
+        }
+    }
+    seen += _zero;
+    if (seen > rank) {
+        return 0.0;
+    }
+    for (size_t i = 0; i < _positive.counts.size(); i++) {
+        seen += _positive.counts[i];
+        if (seen > rank) {
+            return bucketValue(_positive.offset + (int)i);
+        }
+    }
+    return bucketValue(_positive.offset + (int)_positive.counts.size() - 1);
+}
+
+/* Distributions */
+
+BM11Distribution BM11DistributionMakeUniform(float min, float max)
+{
+    BM11Distribution d = {BM11DistributionUniform, min, max, 0.5f * (min + max), 0.0f};
+    return d;
+}
+
+BM11Distribution BM11DistributionMakeNormal(float mean, float sigma)
+{
+    BM11Distribution d = {BM11DistributionNormal, -FLT_MAX, FLT_MAX, mean, sigma};
+    return d;
+}
+
+BM11Distribution BM11DistributionMakeTriangular(float min, float mode, float max)
+{
+    BM11Distribution d = {BM11DistributionTriangular, min, max, mode, 0.0f};
+    return d;
+}
+
+/* Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3") */
+static inline void philox4x32(uint32_t counter[4], uint32_t key0, uint32_t key1)
+{
+    for (int round = 0; round < 10; round++) {
+        uint64_t p0 = (uint64_t)0xD2511F53u * counter[0];
+        uint64_t p1 = (uint64_t)0xCD9E8D57u * counter[2];
+        uint32_t c0 = (uint32_t)(p1 >> 32) ^ counter[1] ^ key0;
+        uint32_t c2 = (uint32_t)(p0 >> 32) ^ counter[3] ^ key1;
+        counter[0]  = c0;
+        counter[1]  = (uint32_t)p1;
+        counter[2]  = c2;
+        counter[3]  = (uint32_t)p0;
+        key0       += 0x9E3779B9u;
+        key1       += 0xBB67AE85u;
+    }
+}
+
+/* Uniform in (0, 1), never exactly 0 or 1 */
+static inline double unitInterval(uint32_t bits)
+{
+    return ((double)(bits >> 8) + 0.5) * (1.0 / 16777216.0);
+}
+
+static float sampleField(const BM11Distribution *d, uint64_t seed, uint64_t sample, int field)
+{
+    uint32_t random[4] = {(uint32_t)sample, (uint32_t)(sample >> 32), (uint32_t)field, 0};
+    philox4x32(random, (uint32_t)seed, (uint32_t)(seed >> 32));
+    double   u = unitInterval(random[0]);
+
+    switch (d->kind) {
+        case BM11DistributionUniform:
+            return (float)(d->min + (d->max - d->min) * u);
+        case BM11DistributionNormal: {
+            /* Box-Muller */
+            double z     = sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * unitInterval(random[1]));
+            double value = d->mode + d->sigma * z;
+            value        = (value < d->min) ? d->min : ((value > d->max) ? d->max : value);
+            return (float)value;
+        }
+        case BM11DistributionTriangular: {
+            double range = (double)d->max - d->min;
+            double split = (range > 0.0) ? ((d->mode - d->min) / range) : 0.5;
+            if (u < split) {
+                return (float)(d->min + sqrt(u * range * (d->mode - d->min)));
+            }
+            return (float)(d->max - sqrt((1.0 - u) * range * (d->max - d->mode)));
+        }
+        default:
+            return 0.0f;
+    }
+}
+
+/* Monte Carlo run */
+
+typedef struct {
+    uint64_t count;
+    double   mean;
+    double   m2;
+    double   min;
+    double   max;
+} RunningStats;
+
+typedef struct {
+    std::vector<float>              inputs;  /* BM11InputField_Count columns of one block */
+    std::vector<float>              outputs; /* output_count columns of one block         */
+    std::vector<uint8_t>            status;
+    std::vector<RunningStats>       stats;
+    std::vector<BM11QuantileSketch> sketches;
+    uint64_t                        status_count[BM11Model::StatusCount];
+} ThreadState;
+
+typedef struct {
+    const BM11MonteCarloConfig *config;
+    std::vector<ThreadState>   *threads;
+    int                         output_count; /* Clamped to BM11_MONTE_CARLO_MAX_OUTPUTS  */
+    const int                  *slot;         /* Output column holding each output's values */
+    const float                *reference;    /* Base design's value of each output       */
+} MonteCarloJob;
+
+static void monteCarloRange(void *context, uint64_t begin, uint64_t end, int thread_index)
+{
+    MonteCarloJob              *job    = (MonteCarloJob *)context;
+    const BM11MonteCarloConfig *config = job->config;
+    ThreadState                *state  = &(*job->threads)[thread_index];
+    const size_t                block  = BM11_MONTE_CARLO_BLOCK;
+
+    BM11BatchInput  input;
+    BM11BatchOutput output;
+    for (int f = 0; f < BM11InputField_Count; f++) {
+        input.column[f] = &state->inputs[f * block];
+    }
+    memset(output.column, 0, sizeof(output.column));
+    for (int o = 0; o < job->output_count; o++) {
+        output.column[config->output[o]] = &state->outputs[job->slot[o] * block];
+    }
+    output.status = state->status.data();
+
+    for (uint64_t b = begin; b < end; b++) {
+        uint64_t first = b * block;
+        size_t   count = (size_t)(((first + block) <= config->sample_count) ? block : (config->sample_count - first));
+
+        for (int f = 0; f < BM11InputField_Count; f++) {
+            float *column = &state->inputs[f * block];
+            if (config->distribution[f].kind == BM11DistributionFixed) {
+                float value = BM11GetInputField(&config->base, f);
+                for (size_t i = 0; i < count; i++) {
+                    column[i] = value;
+                }
+            } else {
+                for (size_t i = 0; i < count; i++) {
+                    column[i] = sampleField(&config->distribution[f], config->seed, first + i, f);
+                }
+            }
+        }
+
+        BM11EvaluateBatch(&input, &output, count);
+
+        for (size_t i = 0; i < count; i++) {
+            state->status_count[state->status[i]]++;
+        }
+        for (int o = 0; o < job->output_count; o++) {
+            const float  *column    = &state->outputs[job->slot[o] * block];
+            RunningStats *stats     = &state->stats[o];
+            double        reference = job->reference[o];
+            for (size_t i = 0; i < count; i++) {
+                if (state->status[i] != BM11Model::StatusOK) {
+                    continue;
+                }
+                double value = column[i];
+                double delta = value - stats->mean;
+                stats->count++;
+                stats->mean += delta / (double)stats->count;
+                stats->m2   += delta * (value - stats->mean);
+                stats->min   = (value < stats->min) ? value : stats->min;
+                stats->max   = (value > stats->max) ? value : stats->max;
+                state->sketches[o].add(value - reference);
+            }
+        }
+    }
+}
+
+void BM11MonteCarloConfigInit(BM11MonteCarloConfig *config)
+{
+    memset(config, 0, sizeof(*config));
+    config->base = BM11Model::getDefaultInputParameters();
+    for (int f = 0; f < BM11InputField_Count; f++) {
+        config->distribution[f].kind = BM11DistributionFixed;
+    }
+    config->sample_count      = 1000000;
+    config->seed              = 0x4d43424d3131ull;
+    config->relative_accuracy = 0.001;
+
+    static const int outputs[] = {
+        BM11OutputField_total_cost,
+        BM11OutputField_total_mass,
+        BM11OutputField_dihedral_angle_angle_BOA_BOC,
+        BM11OutputField_dihedral_angle_angle_BOA_ABC,
+        BM11OutputField_overall_structure_walkway_base_width,
+        BM11OutputField_overall_structure_walkway_shoulder_width,
+    };
+    config->output_count = sizeof(outputs) / sizeof(outputs[0]);
+    memcpy(config->output, outputs, sizeof(outputs));
+}
+
+BM11MonteCarloResult BM11RunMonteCarlo(const BM11MonteCarloConfig *config)
+{
+    BM11MonteCarloResult result;
+    memset(&result, 0, sizeof(result));
+
+    auto     start        = std::chrono::steady_clock::now();
+    uint64_t block_count  = (config->sample_count + BM11_MONTE_CARLO_BLOCK - 1) / BM11_MONTE_CARLO_BLOCK;
+    int      thread_count = (config->thread_count > 0) ? config->thread_count : BM11ParallelThreadCount();
+    int      output_count = (config->output_count < BM11_MONTE_CARLO_MAX_OUTPUTS) ? config->output_count : BM11_MONTE_CARLO_MAX_OUTPUTS;
+    if ((uint64_t)thread_count > block_count) {
+        thread_count = (block_count > 0) ? (int)block_count : 1;
+    }
+
+    std::vector<ThreadState> threads(thread_count);
+    for (int t = 0; t < thread_count; t++) {
+        ThreadState *state = &threads[t];
+        state->inputs.resize(BM11InputField_Count * BM11_MONTE_CARLO_BLOCK);
+        state->outputs.resize(output_count * BM11_MONTE_CARLO_BLOCK);
+        state->status.resize(BM11_MONTE_CARLO_BLOCK);
+        state->stats.resize(output_count);
+        for (int o = 0; o < output_count; o++) {
+            RunningStats empty = {0, 0.0, 0.0, INFINITY, -INFINITY};
+            state->stats[o]    = empty;
+        }
+        memset(state->status_count, 0, sizeof(state->status_count));
+    }
+
+    /* Sketch deviations from the base design, so the sketch's relative
+       accuracy applies to the spread rather than to the value itself */
+    float reference[BM11_MONTE_CARLO_MAX_OUTPUTS];
+    {
+        float           base_inputs[BM11InputField_Count];
+        float           base_outputs[BM11OutputField_Count];
+        uint8_t         base_status;
+        BM11BatchInput  input;
+        BM11BatchOutput output;
+        for (int f = 0; f < BM11InputField_Count; f++) {
+            base_inputs[f]  = BM11GetInputField(&config->base, f);
+            input.column[f] = &base_inputs[f];
+        }
+        for (int f = 0; f < BM11OutputField_Count; f++) {
+            output.column[f] = &base_outputs[f];
+        }
+        output.status = &base_status;
+        BM11EvaluateBatch(&input, &output, 1);
+        for (int o = 0; o < output_count; o++) {
+            reference[o] = base_outputs[config->output[o]];
+        }
+    }
+
+    /* A field listed twice is evaluated into its first slot and reduced into
+       both, so the duplicate gets the same statistics */
+    int slot[BM11_MONTE_CARLO_MAX_OUTPUTS];
+    for (int o = 0; o < output_count; o++) {
+        slot[o] = o;
+        for (int p = 0; p < o; p++) {
+            if (config->output[p] == config->output[o]) {
+                slot[o] = p;
+                break;
+            }
+        }
+    }
+
+    /* Deviations below float resolution of the reference are noise */
+    std::vector<BM11QuantileSketch> sketches;
+    for (int o = 0; o < output_count; o++) {
+        double floor = fabs((double)reference[o]) * 1e-7;
+        sketches.push_back(BM11QuantileSketch(config->relative_accuracy, (floor > 1e-30) ? floor : 1e-30));
+    }
+    for (int t = 0; t < thread_count; t++) {
+        threads[t].sketches = sketches;
+    }
+
+    MonteCarloJob job;
+    job.config       = config;
+    job.threads      = &threads;
+    job.output_count = output_count;
+    job.slot         = slot;
+    job.reference    = reference;
+    BM11ParallelFor(block_count, 1, thread_count, monteCarloRange, &job);
+
+    /* Merge in thread order; Chan et al. for the running moments */
+    for (int o = 0; o < output_count; o++) {
+        RunningStats       total = {0, 0.0, 0.0, INFINITY, -INFINITY};
+        BM11QuantileSketch sketch = sketches[o];
+        for (int t = 0; t < thread_count; t++) {
+            const RunningStats *s = &threads[t].stats[o];
+            if (s->count == 0) {
+                continue;
+            }
+            uint64_t n     = total.count + s->count;
+            double   delta = s->mean - total.mean;
+            total.m2      += s->m2 + delta * delta * ((double)total.count * (double)s->count / (double)n);
+            total.mean    += delta * ((double)s->count / (double)n);
+            total.count    = n;
+            total.min      = (s->min < total.min) ? s->min : total.min;
+            total.max      = (s->max > total.max) ? s->max : total.max;
+            sketch.merge(threads[t].sketches[o]);
+        }
+
+        BM11MonteCarloOutput *out = &result.output[o];
+        out->field  = config->output[o];
+        out->count  = total.count;
+        out->mean   = total.mean;
+        out->stddev = (total.count > 1) ? sqrt(total.m2 / (double)(total.count - 1)) : 0.0;
+        out->min    = total.min;
+        out->max    = total.max;
+        out->p05    = reference[o] + sketch.getQuantile(0.05);
+        out->p50    = reference[o] + sketch.getQuantile(0.50);
+        out->p95    = reference[o] + sketch.getQuantile(0.95);
+        out->p99    = reference[o] + sketch.getQuantile(0.99);
+    }
+    for (int t = 0; t < thread_count; t++) {
+        for (int s = 0; s < BM11Model::StatusCount; s++) {
+            result.status_count[s] += threads[t].status_count[s];
+        }
+    }
+
+    result.samples      = config->sample_count;
+    result.seconds      = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.thread_count = thread_count;
+    result.output_count = output_count;
+    return result;
+}
+
+void BM11MonteCarloPrint(FILE *file, const BM11MonteCarloResult *result)
+{
+    fprintf(file, "Monte Carlo: %llu samples in %.3f s on %d threads (%.2f M samples/s)\n",
+            (unsigned long long)result->samples, result->seconds, result->thread_count,
+            (result->seconds > 0.0) ? (result->samples / result->seconds * 1e-6) : 0.0);
+    for (int s = 1; s < BM11Model::StatusCount; s++) {
+        if (result->status_count[s]) {
+            fprintf(file, "   Rejected %llu: %s\n", (unsigned long long)result->status_count[s],
+                    BM11Model::getStatusString((BM11Model::Status)s));
+        }
+    }
+    fprintf(file, "   %-42s %12s %12s %12s %12s %12s\n", "output", "mean", "stddev", "P05", "P50", "P95");
+    for (int o = 0; o < result->output_count; o++) {
+        const BM11MonteCarloOutput *out = &result->output[o];
+        fprintf(file, "   %-42s %12.4f %12.4f %12.4f %12.4f %12.4f\n", BM11OutputFieldInfo[out->field].name,
+                out->mean, out->stddev, out->p05, out->p50, out->p95);
+    }
+}
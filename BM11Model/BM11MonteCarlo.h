@@ -0,0 +1,124 @@
+#ifndef BM11_MONTE_CARLO_H
+#define BM11_MONTE_CARLO_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+#include "BM11Fields.h"
+
+/*
+   Monte Carlo tolerance and price-uncertainty analysis.
+
+   Every sample perturbs the InputParameters fields that have a
+   distribution; the rest keep their `base` value. Random numbers come
+   from Philox4x32-10 keyed by the seed, with the sample number and field
+   as the counter, so sample i is the same whatever the thread count or
+   scheduling and a run is reproducible from its seed alone.
+
+   Samples are generated and evaluated in blocks of BM11_MONTE_CARLO_BLOCK
+   with BM11EvaluateBatch(), spread over threads with BM11ParallelFor().
+   Each thread reduces its outputs into running mean/variance (Welford) and
+   BM11QuantileSketch accumulators, merged once at the end; samples are
+   never stored. The sketches hold deviations from the base design's
+   output, so quantiles are accurate relative to the spread, not to the
+   value. Rejected designs are counted per status and excluded from
+   the statistics.
+ */
+
+#define BM11_MONTE_CARLO_MAX_OUTPUTS 16
+#define BM11_MONTE_CARLO_BLOCK       1024
+
+/* Mergeable quantile sketch with relative error guarantee (log-spaced
+   buckets, as in DDSketch): any quantile is returned within
+   `relative_accuracy` of a value of the right rank. Values smaller in
+   magnitude than `min_magnitude` are counted as zero. */
+class BM11QuantileSketch {
+public:
+    BM11QuantileSketch(double relative_accuracy = 0.001, double min_magnitude = 1e-30);
+
+    void     add(double value);
+    void     merge(const BM11QuantileSketch &other);
+    double   getQuantile(double q) const;
+    uint64_t getCount(void) const { return _count; };
+
+private:
+    int    bucketIndex(double magnitude) const;
+    double bucketValue(int index) const;
+
+    typedef struct {
+        std::vector<uint64_t> counts;
+        int                   offset; /* Bucket index of counts[0] */
+    } Store;
+
+    static void storeAdd(Store *store, int index, uint64_t count);
+
+    double   _gamma;
+    double   _inv_log_gamma;
+    double   _min_magnitude;
+    Store    _positive;
+    Store    _negative;               /* By magnitude */
+    uint64_t _zero;
+    uint64_t _count;
+};
+
+typedef enum {
+    BM11DistributionFixed,      /* base value                                     */
+    BM11DistributionUniform,    /* [min, max]                                     */
+    BM11DistributionNormal,     /* mean `mode`, deviation `sigma`, clamped to [min, max] */
+    BM11DistributionTriangular  /* [min, max] peaking at `mode`                   */
+} BM11DistributionKind;
+
+typedef struct {
+    BM11DistributionKind kind;
+    float                min;
+    float                max;
+    float                mode;
+    float                sigma;
+} BM11Distribution;
+
+BM11Distribution BM11DistributionMakeUniform(float min, float max);
+BM11Distribution BM11DistributionMakeNormal(float mean, float sigma);
+BM11Distribution BM11DistributionMakeTriangular(float min, float mode, float max);
+
+typedef struct {
+    BM11Model::InputParameters base;
+    BM11Distribution           distribution[BM11InputField_Count];
+    uint64_t                   sample_count;
+    uint64_t                   seed;
+    int                        thread_count;      /* 0 = all hardware threads */
+    int                        output[BM11_MONTE_CARLO_MAX_OUTPUTS]; /* BM11OutputFields to reduce */
+    int                        output_count;      /* Clamped to the maximum; repeats share stats */
+    double                     relative_accuracy; /* Of the quantile sketches */
+} BM11MonteCarloConfig;
+
+typedef struct {
+    int      field;
+    uint64_t count;
+    double   mean;
+    double   stddev;
+    double   min;
+    double   max;
+    double   p05;
+    double   p50;
+    double   p95;
+    double   p99;
+} BM11MonteCarloOutput;
+
+typedef struct {
+    uint64_t             samples;
+    uint64_t             status_count[BM11Model::StatusCount];
+    double               seconds;
+    int                  thread_count;
+    int                  output_count;
+    BM11MonteCarloOutput output[BM11_MONTE_CARLO_MAX_OUTPUTS];
+} BM11MonteCarloResult;
+
+/* Default inputs, every field fixed, one million samples and outputs
+   total.cost, total.mass, both dihedral angles and both walkway widths */
+void                 BM11MonteCarloConfigInit(BM11MonteCarloConfig *config);
+
+BM11MonteCarloResult BM11RunMonteCarlo(const BM11MonteCarloConfig *config);
+
+void                 BM11MonteCarloPrint(FILE *file, const BM11MonteCarloResult *result);
+
+#endif /* BM11_MONTE_CARLO_H */
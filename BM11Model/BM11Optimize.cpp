@@ -0,0 +1,374 @@
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "BM11Optimize.h"
+#include "BM11Parallel.h"
+
+#define REJECTED_SCORE 1e30 /* Score of designs the model rejects */
+
+void BM11OptimizeConfigInit(BM11OptimizeConfig *config)
+{
+    memset(config, 0, sizeof(*config));
+    config->base            = BM11Model::getDefaultInputParameters();
+    config->start_count     = 32;
+    config->max_evaluations = 2000;
+    config->tolerance       = 1e-6;
+    config->penalty         = 1000.0;
+    config->seed            = 0x4f50544d;
+}
+
+bool BM11OptimizeAddVariable(BM11OptimizeConfig *config, int input_field, float min, float max)
+{
+    if (config->variable_count >= BM11_OPTIMIZE_MAX_VARIABLES) {
+        return false;
+    }
+    BM11OptimizeVariable *v = &config->variable[config->variable_count++];
+    v->field = input_field;
+    v->min   = min;
+    v->max   = max;
+    return true;
+}
+
+bool BM11OptimizeAddTerm(BM11OptimizeConfig *config, int output_field, float weight)
+{
+    if (config->term_count >= BM11_OPTIMIZE_MAX_TERMS) {
+        return false;
+    }
+    config->term[config->term_count].field  = output_field;
+    config->term[config->term_count].weight = weight;
+    config->term_count++;
+    return true;
+}
+
+bool BM11OptimizeAddConstraint(BM11OptimizeConfig *config, int output_field, BM11ConstraintKind kind, float bound)
+{
+    if (config->constraint_count >= BM11_OPTIMIZE_MAX_CONSTRAINTS) {
+        return false;
+    }
+    BM11OptimizeConstraint *c = &config->constraint[config->constraint_count++];
+    c->field = output_field;
+    c->kind  = kind;
+    c->bound = bound;
+    return true;
+}
+
+typedef struct {
+    double   score;     /* Objective plus penalty */
+    double   objective;
+    double   violation;
+    bool     valid;
+} Evaluation;
+
+typedef struct {
+    double     x[BM11_OPTIMIZE_MAX_VARIABLES];
+    Evaluation eval;
+    uint64_t   evaluations;
+} StartResult;
+
+typedef struct {
+    const BM11OptimizeConfig *config;
+    BM11Model                *models;
+    StartResult              *starts;
+    double                    penalty_scale;
+} OptimizeJob;
+
+static void makeInput(const BM11OptimizeConfig *config, const double *x, BM11Model::InputParameters *input)
+{
+    *input = config->base;
+    for (int v = 0; v < config->variable_count; v++) {
+        const BM11OptimizeVariable *var = &config->variable[v];
+        BM11SetInputField(input, var->field, (float)(var->min + (var->max - var->min) * x[v]));
+    }
+}
+
+static Evaluation evaluateDesign(const BM11OptimizeConfig *config, double penalty_scale,
+                                 BM11Model *model, const double *x)
+{
+    BM11Model::InputParameters input;
+    Evaluation                 eval;
+
+    makeInput(config, x, &input);
+    model->setInputParameters(input);
+    BM11Model::OutputParameters output = model->getOutputParameters();
+
+    eval.valid = (model->getStatus() == BM11Model::StatusOK);
+    if (!eval.valid) {
+        eval.score     = REJECTED_SCORE;
+        eval.objective = REJECTED_SCORE;
+        eval.violation = INFINITY;
+        return eval;
+    }
+    if (config->adjust) {
+        config->adjust(config->adjust_context, &input, &output);
+    }
+
+    eval.objective = config->term_count ? 0.0 : output.total.cost;
+    for (int t = 0; t < config->term_count; t++) {
+        eval.objective += config->term[t].weight * BM11GetOutputField(&output, config->term[t].field);
+    }
+    eval.violation = 0.0;
+    for (int c = 0; c < config->constraint_count; c++) {
+        const BM11OptimizeConstraint *con = &config->constraint[c];
+        double value = BM11GetOutputField(&output, con->field);
+        double over  = (con->kind == BM11ConstraintAtLeast) ? (con->bound - value) : (value - con->bound);
+        if (over > 0.0) {
+            eval.violation += over / fmax(fabs((double)con->bound), 1.0);
+        }
+    }
+    eval.score = eval.objective + penalty_scale * eval.violation;
+    return eval;
+}
+
+static inline uint64_t splitmix64(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+/* Nelder-Mead from x0, keeping every point inside the unit box */
+static void nelderMead(OptimizeJob *job, BM11Model *model, StartResult *start)
+{
+    const BM11OptimizeConfig *config = job->config;
+    const int                 n      = config->variable_count;
+    const double              alpha  = 1.0, gamma = 2.0, rho = 0.5, sigma = 0.5;
+
+    std::vector<std::vector<double>> simplex(n + 1, std::vector<double>(n));
+    std::vector<Evaluation>          value(n + 1);
+    std::vector<int>                 order(n + 1);
+    std::vector<double>              centroid(n), trial(n), trial2(n);
+    uint64_t                         evaluations = 0;
+
+    auto clampBox = [](std::vector<double> &p) {
+        for (size_t i = 0; i < p.size(); i++) {
+            p[i] = (p[i] < 0.0) ? 0.0 : ((p[i] > 1.0) ? 1.0 : p[i]);
+        }
+    };
+    auto evaluate = [&](const std::vector<double> &p) {
+        evaluations++;
+        return evaluateDesign(config, job->penalty_scale, model, p.data());
+    };
+
+    std::vector<double> best(start->x, start->x + n);
+    Evaluation          best_eval = evaluate(best);
+
+    while (evaluations < config->max_evaluations) {
+        /* (Re)build the simplex around the best point so far */
+        simplex[0] = best;
+        value[0]   = best_eval;
+        for (int i = 0; i < n; i++) {
+            simplex[i + 1]     = best;
+            double step        = (best[i] < 0.9) ? 0.1 : -0.1;
+            simplex[i + 1][i] += step;
+            value[i + 1]       = evaluate(simplex[i + 1]);
+        }
+        double restart_score = best_eval.score;
+
+        while (evaluations < config->max_evaluations) {
+            for (int i = 0; i <= n; i++) {
+                order[i] = i;
+            }
+            std::sort(order.begin(), order.end(), [&](int a, int b) { return value[a].score < value[b].score; });
+            int lo = order[0], hi = order[n], second = order[n - 1];
+
+            /* Converged when the simplex has collapsed in the unit box */
+            double size = 0.0;
+            for (int i = 0; i <= n; i++) {
+                for (int j = 0; j < n; j++) {
+                    size = fmax(size, fabs(simplex[i][j] - simplex[lo][j]));
+                }
+            }
+            if (size < config->tolerance) {
+                break;
+            }
+
+            for (int j = 0; j < n; j++) {
+                centroid[j] = 0.0;
+                for (int i = 0; i <= n; i++) {
+                    if (i != hi) {
+                        centroid[j] += simplex[i][j];
+                    }
+                }
+                centroid[j] /= n;
+            }
+
+            for (int j = 0; j < n; j++) {
+                trial[j] = centroid[j] + alpha * (centroid[j] - simplex[hi][j]);
+            }
+            clampBox(trial);
+            Evaluation reflected = evaluate(trial);
+
+            if (reflected.score < value[lo].score) {
+                for (int j = 0; j < n; j++) {
+                    trial2[j] = centroid[j] + gamma * (trial[j] - centroid[j]);
+                }
+                clampBox(trial2);
+                Evaluation expanded = evaluate(trial2);
+                if (expanded.score < reflected.score) {
+                    simplex[hi] = trial2;
+                    value[hi]   = expanded;
+                } else {
+                    simplex[hi] = trial;
+                    value[hi]   = reflected;
+                }
+            } else if (reflected.score < value[second].score) {
+                simplex[hi] = trial;
+                value[hi]   = reflected;
+            } else {
+                /* Contract towards the better of the reflected and worst points */
+                bool outside = (reflected.score < value[hi].score);
+                for (int j = 0; j < n; j++) {
+                    const double far = outside ? trial[j] : simplex[hi][j];
+                    trial2[j] = centroid[j] + rho * (far - centroid[j]);
+                }
+                Evaluation contracted = evaluate(trial2);
+                if (contracted.score < (outside ? reflected.score : value[hi].score)) {
+                    simplex[hi] = trial2;
+                    value[hi]   = contracted;
+                } else {
+                    /* Shrink everything towards the best vertex */
+                    for (int i = 0; i <= n; i++) {
+                        if (i == lo) {
+                            continue;
+                        }
+                        for (int j = 0; j < n; j++) {
+                            simplex[i][j] = simplex[lo][j] + sigma * (simplex[i][j] - simplex[lo][j]);
+                        }
+                        value[i] = evaluate(simplex[i]);
+                    }
+                }
+            }
+        }
+
+        for (int i = 0; i <= n; i++) {
+            if (value[i].score < best_eval.score) {
+                best      = simplex[i];
+                best_eval = value[i];
+            }
+        }
+        /* A restart that found nothing better means we've converged */
+        if (!(best_eval.score < restart_score)) {
+            break;
+        }
+    }
+
+    std::copy(best.begin(), best.end(), start->x);
+    start->eval        = best_eval;
+    start->evaluations = evaluations;
+}
+
+static void optimizeRange(void *context, uint64_t begin, uint64_t end, int thread_index)
+{
+    OptimizeJob *job = (OptimizeJob *)context;
+
+    for (uint64_t s = begin; s < end; s++) {
+        nelderMead(job, &job->models[thread_index], &job->starts[s]);
+    }
+}
+
+BM11OptimizeResult BM11RunOptimize(const BM11OptimizeConfig *config)
+{
+    BM11OptimizeResult result;
+    memset(&result, 0, sizeof(result));
+    auto start_time = std::chrono::steady_clock::now();
+
+    int start_count  = (config->start_count > 0) ? config->start_count : 1;
+    int thread_count = (config->thread_count > 0) ? config->thread_count : BM11ParallelThreadCount();
+    if (thread_count > start_count) {
+        thread_count = start_count;
+    }
+
+    std::vector<StartResult> starts(start_count);
+    uint64_t                 rng = config->seed;
+    for (int s = 0; s < start_count; s++) {
+        for (int v = 0; v < config->variable_count; v++) {
+            const BM11OptimizeVariable *var = &config->variable[v];
+            if (s == 0) {
+                /* The base design, clipped into the box */
+                double range = (double)var->max - var->min;
+                double x     = (range > 0.0) ? ((BM11GetInputField(&config->base, var->field) - var->min) / range) : 0.0;
+                starts[s].x[v] = (x < 0.0) ? 0.0 : ((x > 1.0) ? 1.0 : x);
+            } else {
+                starts[s].x[v] = (double)(splitmix64(&rng) >> 11) * (1.0 / 9007199254740992.0);
+            }
+        }
+    }
+
+    /* Penalty in units of the base design's objective */
+    BM11Model  base_model;
+    Evaluation base = evaluateDesign(config, 0.0, &base_model, starts[0].x);
+    double     scale = (base.valid && (fabs(base.objective) > 1.0)) ? fabs(base.objective) : 1.0;
+
+    /* Nothing to vary: the base design is the only candidate */
+    if (config->variable_count <= 0) {
+        makeInput(config, starts[0].x, &result.input);
+        result.output = base_model.getOutputParameters();
+        if (config->adjust && base.valid) {
+            config->adjust(config->adjust_context, &result.input, &result.output);
+        }
+        result.objective       = base.objective;
+        result.violation       = base.violation;
+        result.feasible        = base.valid && (base.violation == 0.0);
+        result.evaluations     = 1;
+        result.starts_feasible = result.feasible;
+        result.seconds         = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        return result;
+    }
+
+    std::vector<BM11Model> models(thread_count);
+    OptimizeJob job;
+    job.config        = config;
+    job.models        = models.data();
+    job.starts        = starts.data();
+    job.penalty_scale = config->penalty * scale;
+    BM11ParallelFor(start_count, 1, thread_count, optimizeRange, &job);
+
+    /* Best feasible start, else the least infeasible one; ties go to the lower start */
+    int best = 0;
+    for (int s = 0; s < start_count; s++) {
+        const Evaluation *e = &starts[s].eval;
+        const Evaluation *b = &starts[best].eval;
+        bool feasible      = e->valid && (e->violation == 0.0);
+        bool best_feasible = b->valid && (b->violation == 0.0);
+        result.evaluations     += starts[s].evaluations;
+        result.starts_feasible += feasible;
+        if ((feasible && !best_feasible) ||
+            ((feasible == best_feasible) && (feasible ? (e->objective < b->objective) : (e->score < b->score)))) {
+            best = s;
+        }
+    }
+
+    BM11Model model;
+    makeInput(config, starts[best].x, &result.input);
+    model.setInputParameters(result.input);
+    result.output    = model.getOutputParameters();
+    if (config->adjust && (model.getStatus() == BM11Model::StatusOK)) {
+        config->adjust(config->adjust_context, &result.input, &result.output);
+    }
+    result.objective = starts[best].eval.objective;
+    result.violation = starts[best].eval.violation;
+    result.feasible  = starts[best].eval.valid && (starts[best].eval.violation == 0.0);
+    result.seconds   = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    return result;
+}
+
+void BM11OptimizePrint(FILE *file, const BM11OptimizeConfig *config, const BM11OptimizeResult *result)
+{
+    fprintf(file, "Optimize: objective %.4f (%s), %llu evaluations in %.3f s, %d feasible starts\n",
+            result->objective, result->feasible ? "feasible" : "infeasible",
+            (unsigned long long)result->evaluations, result->seconds, result->starts_feasible);
+    for (int v = 0; v < config->variable_count; v++) {
+        const BM11OptimizeVariable *var = &config->variable[v];
+        fprintf(file, "   %-42s %12.4f   in [%g, %g]\n", BM11InputFieldInfo[var->field].name,
+                BM11GetInputField(&result->input, var->field), var->min, var->max);
+    }
+    for (int c = 0; c < config->constraint_count; c++) {
+        const BM11OptimizeConstraint *con = &config->constraint[c];
+        fprintf(file, "   %-42s %12.4f   %s %g\n", BM11OutputFieldInfo[con->field].name,
+                BM11GetOutputField(&result->output, con->field),
+                (con->kind == BM11ConstraintAtLeast) ? ">=" : "<=", con->bound);
+    }
+}
@@ -0,0 +1,106 @@
+#ifndef BM11_OPTIMIZE_H
+#define BM11_OPTIMIZE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "BM11Fields.h"
+
+/*
+   Constrained design optimizer.
+
+   Minimizes a weighted sum of output fields (e.g. total.cost, or
+   total.cost + 10 * total.mass) over a box of selected input fields,
+   subject to output constraints such as
+   overall_structure.walkway_shoulder_width >= 4 and the tetrahedron being
+   valid.
+
+   The search is multi-start Nelder-Mead in the box scaled to [0, 1]^n.
+   Start 0 is the base design and the others are drawn uniformly from the
+   box; starts run concurrently with BM11ParallelFor(), each thread with its
+   own BM11Model, so only the stages a move actually dirties are re-run.
+   Each start restarts its simplex once it collapses, to shake off false
+   convergence. Constraint violations, relative to max(|bound|, 1), are
+   added to the objective as an exact (L1) penalty scaled by the base
+   design's objective; invalid designs are rejected outright.
+
+   Starts draw their points from their own seeded generator and results
+   are reduced in start order, so a run is reproducible whatever the
+   thread count.
+ */
+
+#define BM11_OPTIMIZE_MAX_VARIABLES   BM11InputField_Count
+#define BM11_OPTIMIZE_MAX_TERMS       8
+#define BM11_OPTIMIZE_MAX_CONSTRAINTS 16
+
+typedef struct {
+    int   field; /* BM11InputField */
+    float min;
+    float max;
+} BM11OptimizeVariable;
+
+typedef struct {
+    int   field; /* BM11OutputField */
+    float weight;
+} BM11OptimizeTerm;
+
+typedef enum {
+    BM11ConstraintAtLeast, /* output >= bound */
+    BM11ConstraintAtMost   /* output <= bound */
+} BM11ConstraintKind;
+
+typedef struct {
+    int                field; /* BM11OutputField */
+    BM11ConstraintKind kind;
+    float              bound;
+} BM11OptimizeConstraint;
+
+/* Rewrites a valid design's outputs before they are scored, e.g. with
+   costs the model doesn't compute; called concurrently from every thread */
+typedef void (*BM11OptimizeAdjustFunc)(void *context, const BM11Model::InputParameters *input,
+                                       BM11Model::OutputParameters *output);
+
+typedef struct {
+    BM11Model::InputParameters base;          /* Values of the fields not being optimized */
+    BM11OptimizeVariable       variable[BM11_OPTIMIZE_MAX_VARIABLES];
+    int                        variable_count;
+    BM11OptimizeTerm           term[BM11_OPTIMIZE_MAX_TERMS];
+    int                        term_count;      /* 0 = minimize total.cost               */
+    BM11OptimizeConstraint     constraint[BM11_OPTIMIZE_MAX_CONSTRAINTS];
+    int                        constraint_count;
+
+    int                        start_count;     /* Independent Nelder-Mead runs           */
+    uint32_t                   max_evaluations; /* Per start                              */
+    double                     tolerance;       /* Simplex size in the unit box           */
+    double                     penalty;         /* Weight of a 100% constraint violation  */
+    uint64_t                   seed;
+    int                        thread_count;    /* 0 = all hardware threads               */
+    BM11OptimizeAdjustFunc     adjust;          /* May be NULL                            */
+    void                      *adjust_context;
+} BM11OptimizeConfig;
+
+typedef struct {
+    BM11Model::InputParameters  input;
+    BM11Model::OutputParameters output;
+    double                      objective;     /* Weighted sum, without the penalty     */
+    double                      violation;     /* Sum of relative violations, 0 = feasible */
+    bool                        feasible;
+    uint64_t                    evaluations;   /* Over all starts                       */
+    int                         starts_feasible;
+    double                      seconds;
+} BM11OptimizeResult;
+
+/* Default inputs, minimize total.cost, no variables or constraints,
+   32 starts of up to 2000 evaluations each */
+void               BM11OptimizeConfigInit(BM11OptimizeConfig *config);
+
+/* Each returns false when the corresponding table is full */
+bool               BM11OptimizeAddVariable(BM11OptimizeConfig *config, int input_field, float min, float max);
+bool               BM11OptimizeAddTerm(BM11OptimizeConfig *config, int output_field, float weight);
+bool               BM11OptimizeAddConstraint(BM11OptimizeConfig *config, int output_field, BM11ConstraintKind kind, float bound);
+
+BM11OptimizeResult BM11RunOptimize(const BM11OptimizeConfig *config);
+
+/* Optimized variables and constraint values against their bounds */
+void               BM11OptimizePrint(FILE *file, const BM11OptimizeConfig *config, const BM11OptimizeResult *result);
+
+#endif /* BM11_OPTIMIZE_H */
@@ -0,0 +1,135 @@
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "BM11Parallel.h"
+
+/* One slice per thread, padded so neighbouring locks don't share a cache line.
+   begin/end only change under the lock; thieves read them unlocked as a hint. */
+struct alignas(64) Slice {
+    std::mutex            lock;
+    std::atomic<uint64_t> begin;
+    std::atomic<uint64_t> end;
+};
+
+typedef struct {
+    Slice                *slices;
+    int                   thread_count;
+    uint64_t              grain;
+    BM11ParallelRangeFunc func;
+    void                 *context;
+} ParallelJob;
+
+static bool takeOwn(Slice *slice, uint64_t grain, uint64_t *begin, uint64_t *end)
+{
+    std::lock_guard<std::mutex> guard(slice->lock);
+
+    if (slice->begin >= slice->end) {
+        return false;
+    }
+    *begin       = slice->begin;
+    *end         = ((slice->end - slice->begin) > grain) ? (slice->begin + grain) : slice->end.load();
+    slice->begin = *end;
+    return true;
+}
+
+static bool steal(ParallelJob *job, int thief)
+{
+    for (;;) {
+        /* Pick the victim with the most work left; the sizes are only a hint */
+        int      victim    = -1;
+        uint64_t remaining = 0;
+        for (int t = 0; t < job->thread_count; t++) {
+            if (t == thief) {
+                continue;
+            }
+            uint64_t b = job->slices[t].begin.load(std::memory_order_relaxed);
+            uint64_t e = job->slices[t].end.load(std::memory_order_relaxed);
+            if ((e > b) && ((e - b) > remaining)) {
+                victim    = t;
+                remaining = (e - b);
+            }
+        }
+        if (victim < 0) {
+            return false;
+        }
+
+        uint64_t begin = 0, end = 0;
+        {
+            Slice                      *slice = &job->slices[victim];
+            std::lock_guard<std::mutex> guard(slice->lock);
+            if (slice->begin >= slice->end) {
+                continue; /* Lost the race, look again */
+            }
+            uint64_t size = (slice->end - slice->begin);
+            begin         = slice->begin + (size / 2);
+            end           = slice->end;
+            slice->end    = begin;
+        }
+        {
+            Slice                      *slice = &job->slices[thief];
+            std::lock_guard<std::mutex> guard(slice->lock);
+            slice->begin = begin;
+            slice->end   = end;
+        }
+        return true;
+    }
+}
+
+static void worker(ParallelJob *job, int thread_index)
+{
+    Slice   *own = &job->slices[thread_index];
+    uint64_t begin, end;
+
+    do {
+        while (takeOwn(own, job->grain, &begin, &end)) {
+            job->func(job->context, begin, end, thread_index);
+        }
+    } while (steal(job, thread_index));
+}
+
+int BM11ParallelThreadCount(void)
+{
+    unsigned int n = std::thread::hardware_concurrency();
+    return (n > 0) ? (int)n : 1;
+}
+
+void BM11ParallelFor(uint64_t count, uint64_t grain, int thread_count, BM11ParallelRangeFunc func, void *context)
+{
+    if (count == 0) {
+        return;
+    }
+    if (thread_count <= 0) {
+        thread_count = BM11ParallelThreadCount();
+    }
+    if ((uint64_t)thread_count > count) {
+        thread_count = (int)count;
+    }
+    if (grain == 0) {
+        /* Aim for ~64 work items per thread so stealing has something to balance */
+        grain = count / ((uint64_t)thread_count * 64);
+        grain = (grain < 1) ? 1 : ((grain > 4096) ? 4096 : grain);
+    }
+
+    std::vector<Slice> slices(thread_count);
+    for (int t = 0; t < thread_count; t++) {
+        slices[t].begin = (count * (uint64_t)t) / (uint64_t)thread_count;
+        slices[t].end   = (count * (uint64_t)(t + 1)) / (uint64_t)thread_count;
+    }
+
+    ParallelJob job;
+    job.slices       = slices.data();
+    job.thread_count = thread_count;
+    job.grain        = grain;
+    job.func         = func;
+    job.context      = context;
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t < thread_count; t++) {
+        threads.push_back(std::thread(worker, &job, t));
+    }
+    worker(&job, 0);
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+}
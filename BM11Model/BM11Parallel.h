@@ -0,0 +1,25 @@
+#ifndef BM11_PARALLEL_H
+#define BM11_PARALLEL_H
+
+#include <stdint.h>
+
+/*
+   Work-stealing parallel loop over [0, count).
+
+   Each thread starts with an equal slice and takes `grain` items at a time
+   from the front of it. A thread that runs dry steals the back half of the
+   largest remaining slice. `func` is called with disjoint [begin, end)
+   sub-ranges and the index of the calling thread (0 .. thread_count-1), so
+   per-thread state can live in plain arrays indexed by thread. Thread 0 is
+   the calling thread.
+ */
+
+typedef void (*BM11ParallelRangeFunc)(void *context, uint64_t begin, uint64_t end, int thread_index);
+
+/* Number of hardware threads, at least 1 */
+int  BM11ParallelThreadCount(void);
+
+/* thread_count <= 0 uses BM11ParallelThreadCount(), grain 0 picks a default */
+void BM11ParallelFor(uint64_t count, uint64_t grain, int thread_count, BM11ParallelRangeFunc func, void *context);
+
+#endif /* BM11_PARALLEL_H */
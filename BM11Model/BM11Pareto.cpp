@@ -0,0 +1,336 @@
+#include <math.h>
+#include <algorithm>
+#include "BM11Model.h"
+#include "BM11Parallel.h"
+#include "BM11Pareto.h"
+
+#define LEAF_SIZE   16
+#define MIN_BUFFER  64 /* Buffered points that become a new tree */
+
+BM11ParetoFront::BM11ParetoFront(const BM11ParetoObjective *objectives, int objective_count)
+{
+    if (objective_count > BM11_PARETO_MAX_OBJECTIVES) {
+        objective_count = BM11_PARETO_MAX_OBJECTIVES;
+    }
+    for (int i = 0; i < objective_count; i++) {
+        _objective[i] = objectives[i];
+    }
+    _objective_count = objective_count;
+    _buffer_begin    = 0;
+    _live            = 0;
+    _dead            = 0;
+    _inserts         = 0;
+}
+
+bool BM11ParetoFront::insert(uint64_t index, const BM11Model::InputParameters *input, const BM11Model::OutputParameters *output,
+                             BM11Model::Status status)
+{
+    float key[BM11_PARETO_MAX_OBJECTIVES];
+
+    if (status != BM11Model::StatusOK) {
+        return false;
+    }
+
+    for (int d = 0; d < _objective_count; d++) {
+        const BM11ParetoObjective *objective = &_objective[d];
+        float v = BM11GetOutputField(output, objective->field);
+        if (!isfinite(v)) {
+            return false;
+        }
+        if (objective->sense == BM11ParetoMaximize) {
+            v = -v;
+        }
+        if (objective->resolution > 0.0f) {
+            v = floorf(v / objective->resolution);
+        }
+        key[d] = v;
+    }
+    return insertKey(index, input, key);
+}
+
+void BM11ParetoFront::merge(const BM11ParetoFront &other)
+{
+    for (size_t p = 0; p < other._index.size(); p++) {
+        if (other._alive[p]) {
+            insertKey(other._index[p], &other._input[p], &other._key[p * _objective_count]);
+        }
+    }
+}
+
+void BM11ParetoFront::getPoints(std::vector<BM11ParetoPoint> *points) const
+{
+    points->clear();
+    points->reserve(_live);
+    for (size_t p = 0; p < _index.size(); p++) {
+        if (_alive[p]) {
+            BM11ParetoPoint point;
+            point.index = _index[p];
+            point.input = _input[p];
+            points->push_back(point);
+        }
+    }
+    std::sort(points->begin(), points->end(),
+              [](const BM11ParetoPoint &a, const BM11ParetoPoint &b) { return a.index < b.index; });
+}
+
+bool BM11ParetoFront::write(const char *path, BM11ResultFormat format, const BM11ResultColumn *columns, int column_count) const
+{
+    std::vector<BM11ParetoPoint> points;
+    BM11ResultWriter             writer;
+    BM11Model                    model;
+
+    getPoints(&points);
+    if (!writer.open(path, format, columns, column_count)) {
+        return false;
+    }
+    for (size_t i = 0; i < points.size(); i++) {
+        model.setInputParameters(points[i].input);
+        BM11Model::OutputParameters output = model.getOutputParameters();
+        writer.appendDesign(0, points[i].index, &points[i].input, &output, model.getStatus());
+    }
+    return writer.close();
+}
+
+/* Point p is at least as good as (key, index) everywhere; exact ties go to the lower index */
+bool BM11ParetoFront::beats(uint32_t p, const float *key, uint64_t index) const
+{
+    const float *pk     = &_key[(size_t)p * _objective_count];
+    bool         strict = false;
+
+    for (int d = 0; d < _objective_count; d++) {
+        if (pk[d] > key[d]) {
+            return false;
+        }
+        strict |= (pk[d] < key[d]);
+    }
+    return strict || (_index[p] < index);
+}
+
+/* Calls visit(p) on every live point that may satisfy key <= p (UPPER) or
+   p <= key (!UPPER), pruning subtrees by their bounds; stops early and
+   returns true as soon as visit does */
+template <bool UPPER, typename Visit>
+bool BM11ParetoFront::query(const float *key, Visit visit) const
+{
+    const int k = _objective_count;
+
+    for (size_t t = 0; t < _tree.size(); t++) {
+        int32_t stack[64];
+        int     top = 0;
+        stack[top++] = (int32_t)_tree[t].node_begin;
+        while (top) {
+            int32_t      id     = stack[--top];
+            const Node  *node   = &_node[id];
+            const float *bounds = &_bounds[(size_t)id * 2 * k];
+            bool         prune  = false;
+            for (int d = 0; d < k; d++) {
+                prune |= UPPER ? (bounds[k + d] < key[d]) : (bounds[d] > key[d]);
+            }
+            if (prune) {
+                continue;
+            }
+            if (node->left < 0) {
+                for (uint32_t p = node->begin; p < node->end; p++) {
+                    if (_alive[p] && visit(p)) {
+                        return true;
+                    }
+                }
+            } else {
+                stack[top++] = node->right;
+                stack[top++] = node->left;
+            }
+        }
+    }
+    for (uint32_t p = _buffer_begin; p < _index.size(); p++) {
+        if (_alive[p] && visit(p)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BM11ParetoFront::isBeaten(const float *key, uint64_t index) const
+{
+    return query<false>(key, [&](uint32_t p) { return beats(p, key, index); });
+}
+
+void BM11ParetoFront::evictBeatenBy(const float *key, uint64_t index)
+{
+    const int k = _objective_count;
+
+    query<true>(key, [&](uint32_t p) {
+        const float *pk     = &_key[(size_t)p * k];
+        bool         strict = false;
+        for (int d = 0; d < k; d++) {
+            if (key[d] > pk[d]) {
+                return false;
+            }
+            strict |= (key[d] < pk[d]);
+        }
+        if (strict || (index < _index[p])) {
+            _alive[p] = 0;
+            _live--;
+            _dead++;
+        }
+        return false;
+    });
+}
+
+bool BM11ParetoFront::insertKey(uint64_t index, const BM11Model::InputParameters *input, const float *key)
+{
+    if (isBeaten(key, index)) {
+        return false;
+    }
+    evictBeatenBy(key, index);
+
+    _key.insert(_key.end(), key, key + _objective_count);
+    _index.push_back(index);
+    _input.push_back(*input);
+    _alive.push_back(1);
+    _live++;
+    _inserts++;
+
+    if (_dead > _live + MIN_BUFFER) {
+        rebuild(0);
+    } else if (_index.size() - _buffer_begin >= MIN_BUFFER) {
+        /* Merge the buffer with every trailing tree up to twice its size */
+        size_t first = _tree.size();
+        size_t size  = _index.size() - _buffer_begin;
+        while ((first > 0) && (_tree[first - 1].end - _tree[first - 1].begin <= 2 * size)) {
+            first--;
+            size += _tree[first].end - _tree[first].begin;
+        }
+        rebuild(first);
+    }
+    return true;
+}
+
+/* Builds a subtree over order[begin - base, end - base), the points that will
+   occupy [begin, end) */
+int BM11ParetoFront::build(uint32_t begin, uint32_t end, uint32_t base, std::vector<uint32_t> &order, int depth)
+{
+    const int k  = _objective_count;
+    int       id = (int)_node.size();
+
+    _node.push_back(Node());
+    _bounds.resize(_bounds.size() + 2 * k);
+    float *min = &_bounds[(size_t)id * 2 * k];
+    float *max = min + k;
+    for (int d = 0; d < k; d++) {
+        min[d] = INFINITY;
+        max[d] = -INFINITY;
+    }
+    for (uint32_t i = begin; i < end; i++) {
+        const float *pk = &_key[(size_t)order[i - base] * k];
+        for (int d = 0; d < k; d++) {
+            min[d] = std::min(min[d], pk[d]);
+            max[d] = std::max(max[d], pk[d]);
+        }
+    }
+
+    /* The query stack holds at most one pending sibling per level */
+    if ((end - begin <= LEAF_SIZE) || (depth >= 60)) {
+        _node[id] = { begin, end, -1, -1 };
+        return id;
+    }
+
+    int   split  = 0;
+    float spread = -1.0f;
+    for (int d = 0; d < k; d++) {
+        if (max[d] - min[d] > spread) {
+            spread = max[d] - min[d];
+            split  = d;
+        }
+    }
+    uint32_t mid = begin + (end - begin) / 2;
+    std::nth_element(order.begin() + (begin - base), order.begin() + (mid - base), order.begin() + (end - base),
+                     [&](uint32_t a, uint32_t b) { return _key[(size_t)a * k + split] < _key[(size_t)b * k + split]; });
+
+    int left  = build(begin, mid, base, order, depth + 1);
+    int right = build(mid, end, base, order, depth + 1);
+    _node[id] = { begin, end, left, right };
+    return id;
+}
+
+/* Replaces trees first_tree.. and the buffer by one tree of their live points */
+void BM11ParetoFront::rebuild(size_t first_tree)
+{
+    const int             k     = _objective_count;
+    const uint32_t        base  = (first_tree < _tree.size()) ? _tree[first_tree].begin : _buffer_begin;
+    std::vector<uint32_t> order;
+
+    for (uint32_t p = base; p < _index.size(); p++) {
+        if (_alive[p]) {
+            order.push_back(p);
+        } else {
+            _dead--;
+        }
+    }
+
+    if (first_tree < _tree.size()) {
+        _node.resize(_tree[first_tree].node_begin);
+        _bounds.resize(_node.size() * 2 * k);
+        _tree.resize(first_tree);
+    }
+    if (!order.empty()) {
+        Tree tree;
+        tree.begin      = base;
+        tree.end        = base + (uint32_t)order.size();
+        tree.node_begin = (uint32_t)_node.size();
+        build(tree.begin, tree.end, base, order, 0);
+        _tree.push_back(tree);
+    }
+
+    /* Move the points into tree order; sources are all at or after their destination */
+    std::vector<float>                      key(order.size() * k);
+    std::vector<uint64_t>                   index(order.size());
+    std::vector<BM11Model::InputParameters> input(order.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        std::copy(&_key[(size_t)order[i] * k], &_key[(size_t)order[i] * k] + k, &key[i * k]);
+        index[i] = _index[order[i]];
+        input[i] = _input[order[i]];
+    }
+    _key.resize((size_t)base * k);
+    _key.insert(_key.end(), key.begin(), key.end());
+    _index.resize(base);
+    _index.insert(_index.end(), index.begin(), index.end());
+    _input.resize(base);
+    _input.insert(_input.end(), input.begin(), input.end());
+    _alive.resize(base);
+    _alive.resize(base + order.size(), 1);
+    _buffer_begin = base + (uint32_t)order.size();
+}
+
+/* Sweep driver */
+
+static void paretoResult(void *context, uint64_t index,
+                         const BM11Model::InputParameters  *input,
+                         const BM11Model::OutputParameters *output,
+                         BM11Model::Status status, int thread_index)
+{
+    std::vector<BM11ParetoFront> *fronts = (std::vector<BM11ParetoFront> *)context;
+    (*fronts)[thread_index].insert(index, input, output, status);
+}
+
+BM11SweepStats BM11RunParetoSweep(const BM11SweepConfig *sweep, BM11ParetoFront *front)
+{
+    BM11ParetoObjective objectives[BM11_PARETO_MAX_OBJECTIVES];
+    for (int i = 0; i < front->getObjectiveCount(); i++) {
+        objectives[i] = *front->getObjective(i);
+    }
+
+    int thread_count = (sweep->thread_count > 0) ? sweep->thread_count : BM11ParallelThreadCount();
+    std::vector<BM11ParetoFront> fronts(thread_count, BM11ParetoFront(objectives, front->getObjectiveCount()));
+
+    BM11SweepConfig config = *sweep;
+    config.thread_count    = thread_count;
+    config.result          = paretoResult;
+    config.result_context  = &fronts;
+    config.skip_invalid    = true;
+    BM11SweepStats stats   = BM11RunSweep(&config);
+
+    for (int t = 0; t < thread_count; t++) {
+        front->merge(fronts[t]);
+    }
+    return stats;
+}
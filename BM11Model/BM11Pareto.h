@@ -0,0 +1,123 @@
+#ifndef BM11_PARETO_H
+#define BM11_PARETO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "BM11Fields.h"
+#include "BM11ResultFile.h"
+#include "BM11Sweep.h"
+
+/*
+   Incremental Pareto front over chosen output fields.
+
+   Designs are streamed through insert(); a design is kept unless a kept
+   design is at least as good in every objective, and keeping it evicts the
+   designs it beats. Designs with identical objectives are resolved in
+   favour of the lower index, so the front is a function of the set of
+   designs and not of the order (or threads) they arrived in.
+
+   Kept designs live in bucketed k-d trees whose nodes carry the bounding
+   box of their subtree, so both "is q beaten?" and "what does q beat?" are
+   orthant queries that prune most of each tree. Fresh points go to a small
+   linear buffer; when it fills it becomes a tree, merged with the trailing
+   trees that are no more than twice its size (the logarithmic method), so
+   there are O(log n) trees and rebuilding is amortized. Evicted points are
+   tombstoned and everything is rebuilt once they outnumber the live ones.
+
+   Memory grows with the front, not with the number of designs streamed.
+   A non-zero resolution snaps an objective to multiples of it before
+   comparing, which thins a large front to at most one design per cell.
+
+   Only each design's index and inputs are stored; write() re-evaluates the
+   front to produce outputs.
+ */
+
+#define BM11_PARETO_MAX_OBJECTIVES 8
+
+typedef enum {
+    BM11ParetoMinimize,
+    BM11ParetoMaximize
+} BM11ParetoSense;
+
+typedef struct {
+    int             field;      /* BM11OutputField                    */
+    BM11ParetoSense sense;
+    float           resolution; /* Comparison grid, 0 = exact values  */
+} BM11ParetoObjective;
+
+typedef struct {
+    uint64_t                   index;
+    BM11Model::InputParameters input;
+} BM11ParetoPoint;
+
+class BM11ParetoFront {
+public:
+    BM11ParetoFront(const BM11ParetoObjective *objectives, int objective_count);
+
+    /* Returns true if the design joins the front. Rejected designs (their
+       outputs are zeroed) and designs whose objectives aren't all finite
+       are ignored. */
+    bool     insert(uint64_t index, const BM11Model::InputParameters *input, const BM11Model::OutputParameters *output,
+                    BM11Model::Status status);
+
+    /* Insert every design of `other`, which must have the same objectives */
+    void     merge(const BM11ParetoFront &other);
+
+    size_t   getSize(void) const         { return _live; };
+    uint64_t getInsertCount(void) const  { return _inserts; };
+    int      getObjectiveCount(void) const { return _objective_count; };
+    const BM11ParetoObjective *getObjective(int i) const { return &_objective[i]; };
+
+    /* The front, sorted by design index */
+    void     getPoints(std::vector<BM11ParetoPoint> *points) const;
+
+    /* Writes the front in index order with BM11ResultWriter */
+    bool     write(const char *path, BM11ResultFormat format, const BM11ResultColumn *columns, int column_count) const;
+
+private:
+    typedef struct {
+        uint32_t begin;
+        uint32_t end;
+        int32_t  left;  /* -1 for leaves */
+        int32_t  right;
+    } Node;
+
+    typedef struct {
+        uint32_t begin;      /* Points */
+        uint32_t end;
+        uint32_t node_begin; /* Root */
+    } Tree;
+
+    bool insertKey(uint64_t index, const BM11Model::InputParameters *input, const float *key);
+    bool beats(uint32_t p, const float *key, uint64_t index) const;
+    bool isBeaten(const float *key, uint64_t index) const;
+    void evictBeatenBy(const float *key, uint64_t index);
+    void rebuild(size_t first_tree);
+    int  build(uint32_t begin, uint32_t end, uint32_t base, std::vector<uint32_t> &order, int depth);
+    template <bool UPPER, typename Visit>
+    bool query(const float *key, Visit visit) const;
+
+    BM11ParetoObjective                     _objective[BM11_PARETO_MAX_OBJECTIVES];
+    int                                     _objective_count;
+
+    /* Points: each tree owns a range, in order, then the buffer follows */
+    std::vector<float>                      _key;   /* _objective_count per point, all minimized */
+    std::vector<uint64_t>                   _index;
+    std::vector<BM11Model::InputParameters> _input;
+    std::vector<uint8_t>                    _alive;
+    uint32_t                                _buffer_begin;
+    size_t                                  _live;
+    size_t                                  _dead;
+    uint64_t                                _inserts;
+
+    std::vector<Tree>                       _tree;
+    std::vector<Node>                       _node;   /* Each tree's nodes follow the previous tree's */
+    std::vector<float>                      _bounds; /* min then max key of each node's subtree */
+};
+
+/* Runs `sweep` (its result callback is replaced) with a front per thread and
+   merges them into `front` */
+BM11SweepStats BM11RunParetoSweep(const BM11SweepConfig *sweep, BM11ParetoFront *front);
+
+#endif /* BM11_PARETO_H */
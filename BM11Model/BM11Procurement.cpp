@@ -0,0 +1,471 @@
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "BM11Parallel.h"
+#include "BM11Procurement.h"
+
+#define SHAPE_COUNT      10 /* One triangle, then a pair and two fours per corner */
+#define SHAPE_MAX_POINTS 4
+
+void BM11ProcurementConfigInit(BM11ProcurementConfig *config)
+{
+    memset(config, 0, sizeof(*config));
+    BM11FrameConfigInit(&config->frame);
+    config->stock_length = 20.0f;
+    config->kerf         = 0.125f;
+    config->sheet        = BMVector2Make(8.0f, 4.0f);
+    config->restarts     = 8;
+    config->seed         = 0x50524f43;
+    config->thread_count = 0;
+}
+
+static inline uint64_t splitmix64(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+static inline double unitRandom(uint64_t *state)
+{
+    return (double)(splitmix64(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* Cut list */
+
+typedef struct {
+    int    bars;
+    double space; /* Largest space left in a length */
+} PackScore;
+
+typedef struct {
+    int            count;
+    const double  *size;     /* Remainder plus kerf */
+    double         capacity; /* Stock plus kerf     */
+    uint64_t       seed;
+    PackScore     *scores;
+} PackJob;
+
+static inline bool packBetter(const PackScore &a, const PackScore &b)
+{
+    return (a.bars < b.bars) || ((a.bars == b.bars) && (a.space > b.space));
+}
+
+/* Restart 0 is first fit decreasing; the others sort on randomly scaled
+   sizes and alternate best fit and first fit */
+static PackScore pack(const PackJob *job, int restart, int *bar)
+{
+    const double tolerance = 1e-9 * job->capacity;
+    int          order[BM11_PROCUREMENT_MAX_PIECES];
+    double       key[BM11_PROCUREMENT_MAX_PIECES];
+    double       space[BM11_PROCUREMENT_MAX_PIECES];
+    uint64_t     rng       = job->seed + (uint64_t)restart * 0x632be59bd9b4e019ull;
+    bool         best_fit  = (restart & 1);
+
+    for (int i = 0; i < job->count; i++) {
+        order[i] = i;
+        key[i]   = restart ? (job->size[i] * (1.0 + 0.3 * unitRandom(&rng))) : job->size[i];
+    }
+    std::stable_sort(order, order + job->count, [&](int a, int b) { return key[a] > key[b]; });
+
+    PackScore score = { 0, 0.0 };
+    for (int k = 0; k < job->count; k++) {
+        int    i      = order[k];
+        int    chosen = -1;
+        for (int b = 0; b < score.bars; b++) {
+            if (space[b] + tolerance >= job->size[i]) {
+                if ((chosen < 0) || (best_fit && (space[b] < space[chosen]))) {
+                    chosen = b;
+                }
+                if (!best_fit) {
+                    break;
+                }
+            }
+        }
+        if (chosen < 0) {
+            chosen        = score.bars++;
+            space[chosen] = job->capacity;
+        }
+        space[chosen] -= job->size[i];
+        bar[i]         = chosen;
+    }
+    for (int b = 0; b < score.bars; b++) {
+        score.space = std::max(score.space, space[b]);
+    }
+    return score;
+}
+
+static void packRange(void *context, uint64_t begin, uint64_t end, int thread_index)
+{
+    (void)thread_index;
+    PackJob *job = (PackJob *)context;
+    int      bar[BM11_PROCUREMENT_MAX_PIECES];
+
+    for (uint64_t r = begin; r < end; r++) {
+        job->scores[r] = pack(job, (int)r, bar);
+    }
+}
+
+static void cutList(const BM11ProcurementConfig *config, const BM11Model::InputParameters *input,
+                    const BM11FrameLayout *layout, int thread_count, BM11CutList *list)
+{
+    const double stock = config->stock_length * 12.0;
+    const double kerf  = config->kerf;
+    double       size[BM11_PROCUREMENT_MAX_PIECES];
+    double       total = 0.0, packed = 0.0;
+    int          full  = 0;
+
+    memset(list, 0, sizeof(*list));
+    list->piece_count = layout->member_count;
+    for (int m = 0; m < layout->member_count; m++) {
+        const BM11FrameMember *member = &layout->member[m];
+        double length = BMVector3Length(BMVector3Subtract(layout->node[member->node[1]], layout->node[member->node[0]])) * 12.0;
+        int    whole  = std::max((int)ceil(length / stock - 1e-9) - 1, 0);
+
+        list->piece_full[m]   = whole;
+        list->piece_length[m] = (float)(length - whole * stock);
+        list->splice_count   += whole;
+        size[m]               = list->piece_length[m] + kerf;
+        packed               += size[m];
+        total                += length;
+        full                 += whole;
+    }
+
+    PackJob job;
+    job.count    = layout->member_count;
+    job.size     = size;
+    job.capacity = stock + kerf;
+    job.seed     = config->seed;
+    std::vector<PackScore> scores(config->restarts + 1);
+    job.scores   = scores.data();
+    BM11ParallelFor(scores.size(), 1, thread_count, packRange, &job);
+
+    int best = 0;
+    for (size_t r = 1; r < scores.size(); r++) {
+        if (packBetter(scores[r], scores[best])) {
+            best = (int)r;
+        }
+    }
+    PackScore score = pack(&job, best, list->piece_bar);
+    for (int m = 0; m < layout->member_count; m++) {
+        list->piece_bar[m] += full;
+    }
+
+    list->bar_count      = full + score.bars;
+    list->lower_bound    = full + (int)ceil(packed / job.capacity - 1e-9);
+    list->member_length  = (float)(total / 12.0);
+    list->waste_length   = (float)((list->bar_count * stock - total) / 12.0);
+    list->largest_offcut = (float)(std::max(score.space - kerf, 0.0) / 12.0);
+    list->cost           = list->bar_count * config->stock_length * input->unit_cost.frameMetal;
+}
+
+/* Mirror nesting */
+
+typedef struct {
+    int    count;
+    double point[SHAPE_MAX_POINTS][2];
+} Shape;
+
+typedef struct {
+    int    sheets;
+    double rotation;
+    double offset[2];
+} Placement;
+
+typedef struct {
+    const Shape *shapes;
+    double       sheet[2];
+    uint64_t     seed;
+    Placement   *placements; /* [restart][shape] */
+} NestJob;
+
+/* Grid cells [i W, (i + 1) W] x [j H, (j + 1) H] a convex polygon overlaps,
+   or any count >= limit once that is certain */
+static int coveredCells(const double (*p)[2], int n, double W, double H, int limit)
+{
+    const double eps  = 1e-7 * (W + H);
+    double       xmin = INFINITY, xmax = -INFINITY;
+    int          count = 0;
+
+    for (int k = 0; k < n; k++) {
+        xmin = std::min(xmin, p[k][0]);
+        xmax = std::max(xmax, p[k][0]);
+    }
+    int i0 = (int)floor((xmin + eps) / W);
+    int i1 = (int)ceil((xmax - eps) / W);
+    for (int i = i0; (i < i1) && (count < limit); i++) {
+        /* The polygon's y extent over this column */
+        double x[2] = { std::max(i * W, xmin), std::min((i + 1) * W, xmax) };
+        double ylo  = INFINITY, yhi = -INFINITY;
+        for (int k = 0; k < n; k++) {
+            const double *a = p[k], *b = p[(k + 1) % n];
+            if ((a[0] >= x[0]) && (a[0] <= x[1])) {
+                ylo = std::min(ylo, a[1]);
+                yhi = std::max(yhi, a[1]);
+            }
+            for (int s = 0; s < 2; s++) {
+                if ((a[0] - x[s]) * (b[0] - x[s]) < 0.0) {
+                    double y = a[1] + (b[1] - a[1]) * (x[s] - a[0]) / (b[0] - a[0]);
+                    ylo = std::min(ylo, y);
+                    yhi = std::max(yhi, y);
+                }
+            }
+        }
+        int j0 = (int)floor((ylo + eps) / H);
+        int j1 = (int)ceil((yhi - eps) / H);
+        count += std::max(j1 - j0, 0);
+    }
+    return count;
+}
+
+/* Best offset at one rotation: each vertex on a vertical grid line against
+   each vertex on a horizontal one, and optionally one given offset */
+static void placeRotated(const Shape *shape, double rotation, const double *sheet, const double *extra, Placement *best)
+{
+    double c = cos(rotation), s = sin(rotation);
+    double p[SHAPE_MAX_POINTS][2], q[SHAPE_MAX_POINTS][2];
+    double ox[SHAPE_MAX_POINTS + 1], oy[SHAPE_MAX_POINTS + 1];
+    int    n = shape->count, offsets = n;
+
+    for (int k = 0; k < n; k++) {
+        p[k][0] = shape->point[k][0] * c - shape->point[k][1] * s;
+        p[k][1] = shape->point[k][0] * s + shape->point[k][1] * c;
+        ox[k]   = sheet[0] * ceil(p[k][0] / sheet[0]) - p[k][0];
+        oy[k]   = sheet[1] * ceil(p[k][1] / sheet[1]) - p[k][1];
+    }
+    if (extra) {
+        ox[n]   = extra[0];
+        oy[n]   = extra[1];
+        offsets = n + 1;
+    }
+    for (int i = 0; i < offsets; i++) {
+        for (int j = 0; j < offsets; j++) {
+            for (int k = 0; k < n; k++) {
+                q[k][0] = p[k][0] + ox[i];
+                q[k][1] = p[k][1] + oy[j];
+            }
+            int sheets = coveredCells(q, n, sheet[0], sheet[1], best->sheets);
+            if (sheets < best->sheets) {
+                best->sheets    = sheets;
+                best->rotation  = rotation;
+                best->offset[0] = ox[i];
+                best->offset[1] = oy[j];
+            }
+        }
+    }
+}
+
+/* Restart 0 aligns every edge with the sheet; the others try one random
+   rotation and offset */
+static void nestRange(void *context, uint64_t begin, uint64_t end, int thread_index)
+{
+    (void)thread_index;
+    NestJob *job = (NestJob *)context;
+
+    for (uint64_t r = begin; r < end; r++) {
+        uint64_t rng      = job->seed + r * 0x632be59bd9b4e019ull;
+        double   rotation = M_PI * unitRandom(&rng);
+        double   offset[2] = { job->sheet[0] * unitRandom(&rng), job->sheet[1] * unitRandom(&rng) };
+
+        for (int s = 0; s < SHAPE_COUNT; s++) {
+            const Shape *shape = &job->shapes[s];
+            Placement   *best  = &job->placements[r * SHAPE_COUNT + s];
+            best->sheets = INT32_MAX;
+            if (r == 0) {
+                /* A parallelogram's opposite edges give the same rotations */
+                int edges = (shape->count == 4) ? 2 : shape->count;
+                for (int k = 0; k < edges; k++) {
+                    const double *a = shape->point[k], *b = shape->point[(k + 1) % shape->count];
+                    double        angle = -atan2(b[1] - a[1], b[0] - a[0]);
+                    placeRotated(shape, angle, job->sheet, NULL, best);
+                    placeRotated(shape, angle + 0.5 * M_PI, job->sheet, NULL, best);
+                }
+            } else {
+                placeRotated(shape, rotation, job->sheet, offset, best);
+            }
+        }
+    }
+}
+
+static void nestMirrors(const BM11ProcurementConfig *config, const BM11Model::InputParameters *input,
+                        const BM11Model::OutputParameters *output, int thread_count, BM11SheetNesting *nesting)
+{
+    /* OBA in its plane: O at the origin, A on +x */
+    const double a = output->edge_length.OA, b = output->edge_length.OB, c = output->edge_length.BA;
+    const double x = (a * a + b * b - c * c) / (2.0 * a);
+    const double y = sqrt(std::max(b * b - x * x, 0.0));
+    const double triangle[3][2] = { { 0.0, 0.0 }, { a, 0.0 }, { x, y } };
+
+    Shape shapes[SHAPE_COUNT];
+    int   multiple[SHAPE_COUNT];
+    shapes[0].count = 3;
+    memcpy(shapes[0].point, triangle, sizeof(triangle));
+    multiple[0] = 4;
+    for (int corner = 0; corner < 3; corner++) {
+        const double *p = triangle[corner], *q = triangle[(corner + 1) % 3], *r = triangle[(corner + 2) % 3];
+        double        u[2] = { q[0] - p[0], q[1] - p[1] };
+        double        v[2] = { r[0] - p[0], r[1] - p[1] };
+        const double  span[3][2] = { { 1.0, 1.0 }, { 2.0, 1.0 }, { 1.0, 2.0 } };
+        for (int k = 0; k < 3; k++) {
+            Shape *shape = &shapes[1 + corner * 3 + k];
+            double su = span[k][0], sv = span[k][1];
+            shape->count       = 4;
+            shape->point[0][0] = p[0];
+            shape->point[0][1] = p[1];
+            shape->point[1][0] = p[0] + su * u[0];
+            shape->point[1][1] = p[1] + su * u[1];
+            shape->point[2][0] = p[0] + su * u[0] + sv * v[0];
+            shape->point[2][1] = p[1] + su * u[1] + sv * v[1];
+            shape->point[3][0] = p[0] + sv * v[0];
+            shape->point[3][1] = p[1] + sv * v[1];
+            multiple[1 + corner * 3 + k] = k ? 1 : 2;
+        }
+    }
+
+    NestJob job;
+    job.shapes   = shapes;
+    job.sheet[0] = config->sheet.x;
+    job.sheet[1] = config->sheet.y;
+    job.seed     = config->seed ^ 0x4e455354ull;
+    std::vector<Placement> placements((size_t)(config->restarts + 1) * SHAPE_COUNT);
+    job.placements = placements.data();
+    BM11ParallelFor(config->restarts + 1, 1, thread_count, nestRange, &job);
+
+    int       best_shape = 0;
+    Placement best       = { INT32_MAX, 0.0, { 0.0, 0.0 } };
+    for (int s = 0; s < SHAPE_COUNT; s++) {
+        for (int r = 0; r <= config->restarts; r++) {
+            const Placement *placement = &placements[(size_t)r * SHAPE_COUNT + s];
+            if ((int64_t)placement->sheets * multiple[s] < (int64_t)best.sheets * multiple[best_shape]) {
+                best       = *placement;
+                best_shape = s;
+            }
+        }
+    }
+
+    const double sheet_area = config->sheet.x * config->sheet.y;
+    memset(nesting, 0, sizeof(*nesting));
+    nesting->sheet_count = 2 * best.sheets * multiple[best_shape];
+    nesting->mirror_area = (float)(8.0 * 0.5 * a * y);
+    nesting->lower_bound = (int)ceil(nesting->mirror_area / sheet_area - 1e-9);
+    nesting->arrangement = best_shape ? ((best_shape - 1) % 3 ? 2 : 1) : 0;
+    nesting->corner      = best_shape ? (best_shape - 1) / 3 : 0;
+    nesting->rotation    = (float)fmod(best.rotation * (180.0 / M_PI) + 360.0, 360.0);
+    nesting->offset      = BMVector2Make((float)best.offset[0], (float)best.offset[1]);
+    nesting->waste_area  = (float)(nesting->sheet_count * sheet_area - nesting->mirror_area);
+    nesting->cost        = (float)(nesting->sheet_count * sheet_area * input->unit_cost.mirror);
+}
+
+/* Evaluation */
+
+static bool evaluate(const BM11ProcurementConfig *config,
+                     const BM11Model::InputParameters  *input,
+                     const BM11Model::OutputParameters *output,
+                     int thread_count, BM11ProcurementResult *result)
+{
+    BM11FrameLayout layout;
+
+    memset(result, 0, sizeof(*result));
+    if (!(output->vertex_coord.O.y > 0.0f) || !(output->edge_length.OA > 0.0f) ||
+        !(config->stock_length > 0.0f) || !(config->sheet.x > 0.0f) || !(config->sheet.y > 0.0f)) {
+        return false;
+    }
+    BM11FrameLayoutBuild(&config->frame, output, &layout);
+    cutList(config, input, &layout, thread_count, &result->frame);
+    nestMirrors(config, input, output, thread_count, &result->mirror);
+    result->cost          = result->frame.cost + result->mirror.cost;
+    result->estimate_cost = output->frame.metal_cost + output->mirror.cost;
+    return true;
+}
+
+bool BM11ProcurementEvaluate(const BM11ProcurementConfig *config,
+                             const BM11Model::InputParameters  *input,
+                             const BM11Model::OutputParameters *output,
+                             BM11ProcurementResult *result)
+{
+    return evaluate(config, input, output, config->thread_count, result);
+}
+
+typedef struct {
+    const BM11ProcurementConfig       *config;
+    const BM11Model::InputParameters  *inputs;
+    const BM11Model::OutputParameters *outputs;
+    BM11ProcurementResult             *results;
+} BatchJob;
+
+static void batchRange(void *context, uint64_t begin, uint64_t end, int thread_index)
+{
+    (void)thread_index;
+    BatchJob *job = (BatchJob *)context;
+
+    for (uint64_t i = begin; i < end; i++) {
+        evaluate(job->config, &job->inputs[i], &job->outputs[i], 1, &job->results[i]);
+    }
+}
+
+void BM11ProcurementEvaluateBatch(const BM11ProcurementConfig *config,
+                                  const BM11Model::InputParameters  *inputs,
+                                  const BM11Model::OutputParameters *outputs,
+                                  size_t count, BM11ProcurementResult *results, int thread_count)
+{
+    BatchJob job;
+    job.config  = config;
+    job.inputs  = inputs;
+    job.outputs = outputs;
+    job.results = results;
+    BM11ParallelFor(count, 0, thread_count, batchRange, &job);
+}
+
+void BM11ProcurementAdjustCosts(void *context, const BM11Model::InputParameters *input, BM11Model::OutputParameters *output)
+{
+    BM11ProcurementResult result;
+
+    if (evaluate((const BM11ProcurementConfig *)context, input, output, 1, &result)) {
+        output->total.cost       += (result.frame.cost - output->frame.metal_cost) + (result.mirror.cost - output->mirror.cost);
+        output->frame.metal_cost  = result.frame.cost;
+        output->mirror.cost       = result.mirror.cost;
+    }
+}
+
+void BM11ProcurementPrint(FILE *file, const BM11ProcurementResult *result)
+{
+    static const char *arrangementName[] = { "separate triangles", "pairs", "fours" };
+    static const char *cornerName[]      = { "O", "A", "B" };
+    const BM11CutList      *frame  = &result->frame;
+    const BM11SheetNesting *mirror = &result->mirror;
+
+    fprintf(file, "Procurement:\n");
+    fprintf(file, "   Frame stock lengths    = %d (at least %d), %d splices\n", frame->bar_count, frame->lower_bound, frame->splice_count);
+    fprintf(file, "   Frame member length    = %.3f ft\n", frame->member_length);
+    fprintf(file, "   Frame waste            = %.3f ft, largest offcut %.3f ft\n", frame->waste_length, frame->largest_offcut);
+    fprintf(file, "   Frame metal cost       = $%.3f\n", frame->cost);
+    if (frame->splice_count) {
+        fprintf(file, "      Lengths 0-%d whole, spliced into long members\n", frame->splice_count - 1);
+    }
+    for (int bar = frame->splice_count; bar < frame->bar_count; bar++) {
+        bool first = true;
+        for (int p = 0; p < frame->piece_count; p++) {
+            if (frame->piece_bar[p] == bar) {
+                if (first) {
+                    fprintf(file, "      Length %-3d", bar);
+                    first = false;
+                }
+                fprintf(file, " %8.3f", frame->piece_length[p]);
+            }
+        }
+        if (!first) {
+            fprintf(file, " in\n");
+        }
+    }
+    fprintf(file, "   Mirror sheets          = %d (at least %d)\n", mirror->sheet_count, mirror->lower_bound);
+    fprintf(file, "   Mirror layout          = %s", arrangementName[mirror->arrangement]);
+    if (mirror->arrangement) {
+        fprintf(file, " from %s", cornerName[mirror->corner]);
+    }
+    fprintf(file, " at %.2f deg, offset (%.3f, %.3f) ft\n", mirror->rotation, mirror->offset.x, mirror->offset.y);
+    fprintf(file, "   Mirror waste           = %.3f of %.3f ft^2\n", mirror->waste_area, mirror->mirror_area + mirror->waste_area);
+    fprintf(file, "   Mirror cost            = $%.3f\n", mirror->cost);
+    fprintf(file, "   Cost as bought         = $%.3f (per unit estimate $%.3f)\n", result->cost, result->estimate_cost);
+}
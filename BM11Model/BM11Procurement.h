@@ -0,0 +1,110 @@
+#ifndef BM11_PROCUREMENT_H
+#define BM11_PROCUREMENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "BM11Truss.h"
+
+/*
+   Material take-off in whole stock lengths and whole mirror sheets.
+
+   The model prices frame metal per foot and mirror per square foot. Here
+   the members of BM11FrameLayoutBuild() are cut from stock lengths and
+   the eight mirror triangles from sheets, and the bought material is
+   priced instead: a stock length at stock_length * unit_cost.frameMetal,
+   a sheet at sheet area * unit_cost.mirror (the default mirror price is a
+   4 x 8 ft sheet's).
+
+   Cut list: a one dimensional cutting stock problem. Every cut consumes
+   the kerf. A member longer than the stock takes whole lengths spliced to
+   one remainder piece; remainders are packed by first fit decreasing,
+   then by randomized restarts that perturb the order and alternate first
+   and best fit. Ties on the number of lengths go to the plan with the
+   longest single offcut.
+
+   Mirror nesting: OBA and OBC are mirror images and the coating has one
+   side, so the eight triangles are two groups of four of one handedness
+   each, and the groups are laid out alike. A group is cut as four
+   separate triangles, as two parallelograms of two triangles, or as one
+   parallelogram of four, over each pair of triangle edges. Each shape is
+   placed on the sheet grid at a rotation and offset and costs every sheet
+   it overlaps, so triangles larger than a sheet are assembled from pieces
+   of several. Rotations aligning a shape's edges with the sheet, at
+   offsets putting a vertex on a grid line, are always tried; restarts add
+   random rotations.
+
+   Restarts run on `thread_count` threads and are reduced in restart
+   order, so results don't depend on the thread count. Use one thread per
+   design inside sweeps, BM11ProcurementEvaluateBatch() across designs, or
+   BM11ProcurementAdjustCosts() as the optimizer's adjust hook.
+ */
+
+#define BM11_PROCUREMENT_MAX_PIECES BM11_FRAME_MAX_MEMBERS
+
+typedef struct {
+    BM11FrameConfig frame;
+    float           stock_length; /* ft                                     */
+    float           kerf;         /* in                                     */
+    BMVector2       sheet;        /* ft                                     */
+    int             restarts;     /* Randomized restarts of each heuristic  */
+    uint64_t        seed;
+    int             thread_count; /* 0 = all hardware threads               */
+} BM11ProcurementConfig;
+
+typedef struct {
+    int   piece_count;
+    float piece_length[BM11_PROCUREMENT_MAX_PIECES]; /* in, remainder cut from a shared length    */
+    int   piece_bar[BM11_PROCUREMENT_MAX_PIECES];    /* Length each remainder is cut from         */
+    int   piece_full[BM11_PROCUREMENT_MAX_PIECES];   /* Whole lengths spliced ahead of the piece  */
+    int   bar_count;                                 /* Stock lengths bought                      */
+    int   lower_bound;                               /* Fewest lengths the total could fit in     */
+    int   splice_count;
+    float member_length;                             /* ft, sum over the members                  */
+    float waste_length;                              /* ft, bought minus members, kerf included   */
+    float largest_offcut;                            /* ft                                        */
+    float cost;
+} BM11CutList;
+
+typedef struct {
+    int   sheet_count;
+    int   lower_bound;   /* Triangle area over sheet area, rounded up */
+    int   arrangement;   /* 0 = separate triangles, 1 = pairs, 2 = fours */
+    int   corner;        /* Triangle vertex the parallelograms are spanned from: 0 = O, 1 = A, 2 = B */
+    float rotation;      /* Degrees of the shape on the sheet grid   */
+    BMVector2 offset;    /* ft                                       */
+    float mirror_area;   /* ft^2, the eight triangles                */
+    float waste_area;    /* ft^2                                     */
+    float cost;
+} BM11SheetNesting;
+
+typedef struct {
+    BM11CutList      frame;
+    BM11SheetNesting mirror;
+    float            cost;          /* Frame metal and mirror as bought     */
+    float            estimate_cost; /* frame.metal_cost + mirror.cost       */
+} BM11ProcurementResult;
+
+/* 20 ft stock, 1/8 in kerf, 4 x 8 ft sheets, 8 restarts, all threads */
+void BM11ProcurementConfigInit(BM11ProcurementConfig *config);
+
+/* Returns false for rejected designs */
+bool BM11ProcurementEvaluate(const BM11ProcurementConfig *config,
+                             const BM11Model::InputParameters  *input,
+                             const BM11Model::OutputParameters *output,
+                             BM11ProcurementResult *result);
+
+/* One design per thread, each with a single-threaded search */
+void BM11ProcurementEvaluateBatch(const BM11ProcurementConfig *config,
+                                  const BM11Model::InputParameters  *inputs,
+                                  const BM11Model::OutputParameters *outputs,
+                                  size_t count, BM11ProcurementResult *results, int thread_count);
+
+/* Replaces frame.metal_cost, mirror.cost and total.cost with the bought
+   material's; `context` is a const BM11ProcurementConfig *, searched on
+   one thread. Matches BM11OptimizeConfig::adjust. */
+void BM11ProcurementAdjustCosts(void *context, const BM11Model::InputParameters *input, BM11Model::OutputParameters *output);
+
+void BM11ProcurementPrint(FILE *file, const BM11ProcurementResult *result);
+
+#endif /* BM11_PROCUREMENT_H */
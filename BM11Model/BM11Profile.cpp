@@ -0,0 +1,155 @@
+#include <string.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "BM11Profile.h"
+
+#if defined(BM11_PROFILE)
+
+/* Written only by the owning thread; relaxed atomics so merging readers
+   see whole values without slowing the writer down */
+typedef struct {
+    std::atomic<uint64_t> counter[BM11ProfileCounterCount];
+    std::atomic<uint64_t> stage_runs[BM11Model::StageCount];
+    std::atomic<uint64_t> stage_cycles[BM11Model::StageCount];
+} ThreadCounters;
+
+static std::mutex                    registryLock;
+static std::vector<ThreadCounters *> registry;
+static BM11ProfileStats              retired; /* Totals of threads that have exited */
+
+static inline void bump(std::atomic<uint64_t> *value, uint64_t amount)
+{
+    value->store(value->load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+static void addCounters(BM11ProfileStats *stats, ThreadCounters *counters)
+{
+    for (int c = 0; c < BM11ProfileCounterCount; c++) {
+        stats->counter[c] += counters->counter[c].load(std::memory_order_relaxed);
+    }
+    for (int s = 0; s < BM11Model::StageCount; s++) {
+        stats->stage_runs[s]   += counters->stage_runs[s].load(std::memory_order_relaxed);
+        stats->stage_cycles[s] += counters->stage_cycles[s].load(std::memory_order_relaxed);
+    }
+}
+
+static void clearCounters(ThreadCounters *counters)
+{
+    for (int c = 0; c < BM11ProfileCounterCount; c++) {
+        counters->counter[c].store(0, std::memory_order_relaxed);
+    }
+    for (int s = 0; s < BM11Model::StageCount; s++) {
+        counters->stage_runs[s].store(0, std::memory_order_relaxed);
+        counters->stage_cycles[s].store(0, std::memory_order_relaxed);
+    }
+}
+
+class ThreadSlot {
+public:
+    ThreadSlot(void) {
+        counters = new ThreadCounters;
+        clearCounters(counters);
+        std::lock_guard<std::mutex> guard(registryLock);
+        registry.push_back(counters);
+    }
+    ~ThreadSlot(void) {
+        std::lock_guard<std::mutex> guard(registryLock);
+        addCounters(&retired, counters);
+        for (size_t i = 0; i < registry.size(); i++) {
+            if (registry[i] == counters) {
+                registry.erase(registry.begin() + i);
+                break;
+            }
+        }
+        delete counters;
+    }
+
+    ThreadCounters *counters;
+};
+
+static thread_local ThreadSlot threadSlot;
+
+void BM11ProfileAddStage(int stage, uint64_t cycles)
+{
+    ThreadCounters *counters = threadSlot.counters;
+    bump(&counters->stage_runs[stage], 1);
+    bump(&counters->stage_cycles[stage], cycles);
+}
+
+void BM11ProfileCount(BM11ProfileCounter counter)
+{
+    bump(&threadSlot.counters->counter[counter], 1);
+}
+
+#endif /* BM11_PROFILE */
+
+bool BM11ProfileEnabled(void)
+{
+#if defined(BM11_PROFILE)
+    return true;
+#else
+    return false;
+#endif
+}
+
+void BM11ProfileGetStats(BM11ProfileStats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+#if defined(BM11_PROFILE)
+    std::lock_guard<std::mutex> guard(registryLock);
+    *stats = retired;
+    for (size_t i = 0; i < registry.size(); i++) {
+        addCounters(stats, registry[i]);
+    }
+#endif
+}
+
+void BM11ProfileSubtract(const BM11ProfileStats *after, const BM11ProfileStats *before, BM11ProfileStats *stats)
+{
+    for (int c = 0; c < BM11ProfileCounterCount; c++) {
+        stats->counter[c] = after->counter[c] - before->counter[c];
+    }
+    for (int s = 0; s < BM11Model::StageCount; s++) {
+        stats->stage_runs[s]   = after->stage_runs[s] - before->stage_runs[s];
+        stats->stage_cycles[s] = after->stage_cycles[s] - before->stage_cycles[s];
+    }
+}
+
+/* Counters of other threads are cleared while they may be running, so an
+   increment racing with the reset can survive it */
+void BM11ProfileReset(void)
+{
+#if defined(BM11_PROFILE)
+    std::lock_guard<std::mutex> guard(registryLock);
+    memset(&retired, 0, sizeof(retired));
+    for (size_t i = 0; i < registry.size(); i++) {
+        clearCounters(registry[i]);
+    }
+#endif
+}
+
+void BM11ProfilePrint(FILE *file, const BM11ProfileStats *stats)
+{
+    uint64_t total = 0;
+    for (int s = 0; s < BM11Model::StageCount; s++) {
+        total += stats->stage_cycles[s];
+    }
+
+    fprintf(file, "profile: %llu evaluations, %llu rejected, cache %llu hits / %llu misses\n",
+            (unsigned long long)stats->counter[BM11ProfileEvaluations],
+            (unsigned long long)stats->counter[BM11ProfileValidationFailures],
+            (unsigned long long)stats->counter[BM11ProfileCacheHits],
+            (unsigned long long)stats->counter[BM11ProfileCacheMisses]);
+    fprintf(file, "  %-18s %12s %12s %7s\n", "stage", "runs", "cycles/run", "share");
+    for (int s = 0; s < BM11Model::StageCount; s++) {
+        if (!stats->stage_runs[s]) {
+            continue;
+        }
+        fprintf(file, "  %-18s %12llu %12.1f %6.1f%%\n",
+                BM11Model::getStageString((BM11Model::Stage)s),
+                (unsigned long long)stats->stage_runs[s],
+                (double)stats->stage_cycles[s] / (double)stats->stage_runs[s],
+                total ? (100.0 * stats->stage_cycles[s] / total) : 0.0);
+    }
+}
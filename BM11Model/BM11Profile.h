@@ -0,0 +1,90 @@
+#ifndef BM11_PROFILE_H
+#define BM11_PROFILE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "BM11Model.h"
+
+/*
+   Hot-path instrumentation for BM11Model::evaluate().
+
+   Build with -DBM11_PROFILE to count, per thread, how often each stage runs
+   and the cycles spent in it, along with evaluations, validation failures
+   and result-cache hits. Counters live in thread-local storage and are
+   only summed when BM11ProfileGetStats() is called, so the hot path never
+   touches shared cache lines. Without BM11_PROFILE the hooks expand to the
+   bare statements and the query API reports nothing.
+
+   Cycles come from the time-stamp counter (x86), the virtual counter
+   (arm64) or steady_clock nanoseconds elsewhere, so compare them within one
+   machine only.
+ */
+
+typedef enum {
+    BM11ProfileEvaluations,       /* evaluate() calls                           */
+    BM11ProfileValidationFailures, /* Rejections by edges/validation or the cache */
+    BM11ProfileCacheHits,
+    BM11ProfileCacheMisses,
+    BM11ProfileCounterCount
+} BM11ProfileCounter;
+
+typedef struct {
+    uint64_t counter[BM11ProfileCounterCount];
+    uint64_t stage_runs[BM11Model::StageCount];
+    uint64_t stage_cycles[BM11Model::StageCount];
+} BM11ProfileStats;
+
+/* True when built with BM11_PROFILE */
+bool BM11ProfileEnabled(void);
+
+/* Sum of every thread's counters, including threads that have exited */
+void BM11ProfileGetStats(BM11ProfileStats *stats);
+
+/* stats = after - before, for profiling one section of a run */
+void BM11ProfileSubtract(const BM11ProfileStats *after, const BM11ProfileStats *before, BM11ProfileStats *stats);
+
+void BM11ProfileReset(void);
+
+void BM11ProfilePrint(FILE *file, const BM11ProfileStats *stats);
+
+#if defined(BM11_PROFILE)
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+static inline uint64_t BM11ProfileCycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+void BM11ProfileAddStage(int stage, uint64_t cycles);
+void BM11ProfileCount(BM11ProfileCounter counter);
+
+#define BM11_PROFILE_STAGE(stage, statement)                                      \
+    do {                                                                          \
+        uint64_t bm11_profile_begin = BM11ProfileCycles();                        \
+        statement;                                                                \
+        BM11ProfileAddStage((stage), BM11ProfileCycles() - bm11_profile_begin);   \
+    } while (0)
+#define BM11_PROFILE_COUNT(counter) BM11ProfileCount(counter)
+
+#else
+
+#define BM11_PROFILE_STAGE(stage, statement) do { statement; } while (0)
+#define BM11_PROFILE_COUNT(counter)          do { } while (0)
+
+#endif /* BM11_PROFILE */
+
+#endif /* BM11_PROFILE_H */
@@ -0,0 +1,193 @@
+#include <math.h>
+#include <string.h>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "BM11ResultCache.h"
+
+typedef struct {
+    int64_t v[BM11InputField_Count];
+} CacheKey;
+
+static inline bool operator==(const CacheKey &a, const CacheKey &b)
+{
+    return (memcmp(a.v, b.v, sizeof(a.v)) == 0);
+}
+
+struct CacheKeyHash {
+    size_t operator()(const CacheKey &key) const {
+        uint64_t h = 0x9e3779b97f4a7c15ull;
+        for (int i = 0; i < BM11InputField_Count; i++) {
+            /* splitmix64 finalizer over each word */
+            uint64_t x = (uint64_t)key.v[i] + h;
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+            h = x ^ (x >> 31);
+        }
+        return (size_t)h;
+    }
+};
+
+typedef struct {
+    CacheKey                    key;
+    BM11Model::OutputParameters output;
+    BM11Model::Status           status;
+    bool                        referenced; /* CLOCK second-chance bit */
+    bool                        occupied;
+} CacheEntry;
+
+struct BM11ResultCache::Shard {
+    std::mutex                                     lock;
+    std::vector<CacheEntry>                        entries;
+    std::unordered_map<CacheKey, size_t, CacheKeyHash> index;
+    size_t                                         hand;
+    uint64_t                                       hits;
+    uint64_t                                       misses;
+    uint64_t                                       evictions;
+};
+
+BM11ResultCache::BM11ResultCache(size_t capacity, int shard_count)
+{
+    if (shard_count <= 0) {
+        shard_count = 16;
+    }
+    _shard_count = 1;
+    while (_shard_count < shard_count) {
+        _shard_count <<= 1;
+    }
+    size_t per_shard = (capacity + _shard_count - 1) / _shard_count;
+    if (per_shard < 1) {
+        per_shard = 1;
+    }
+
+    _shards = new Shard[_shard_count];
+    for (int s = 0; s < _shard_count; s++) {
+        _shards[s].entries.resize(per_shard);
+        _shards[s].index.reserve(per_shard);
+        _shards[s].hand      = 0;
+        _shards[s].hits      = 0;
+        _shards[s].misses    = 0;
+        _shards[s].evictions = 0;
+    }
+    for (int f = 0; f < BM11InputField_Count; f++) {
+        _tolerance[f] = 0.0f;
+    }
+}
+
+BM11ResultCache::~BM11ResultCache(void)
+{
+    delete [] _shards;
+}
+
+void BM11ResultCache::setTolerance(int field, float tolerance)
+{
+    _tolerance[field] = tolerance;
+}
+
+float BM11ResultCache::getTolerance(int field) const
+{
+    return _tolerance[field];
+}
+
+static void makeKey(const float *tolerance, const BM11Model::InputParameters *input, CacheKey *key)
+{
+    for (int f = 0; f < BM11InputField_Count; f++) {
+        float value = BM11GetInputField(input, f);
+        if (tolerance[f] > 0.0f) {
+            key->v[f] = (int64_t)llround((double)value / tolerance[f]);
+        } else {
+            int32_t bits;
+            value = (value == 0.0f) ? 0.0f : value; /* -0 and +0 share an entry */
+            memcpy(&bits, &value, sizeof(bits));
+            key->v[f] = bits;
+        }
+    }
+}
+
+bool BM11ResultCache::lookup(const BM11Model::InputParameters *input, BM11Model::OutputParameters *output, BM11Model::Status *status)
+{
+    CacheKey key;
+    makeKey(_tolerance, input, &key);
+    size_t   hash  = CacheKeyHash()(key);
+    Shard   *shard = &_shards[(hash >> 32) & (_shard_count - 1)];
+
+    std::lock_guard<std::mutex> guard(shard->lock);
+    auto it = shard->index.find(key);
+    if (it == shard->index.end()) {
+        shard->misses++;
+        return false;
+    }
+    CacheEntry *entry = &shard->entries[it->second];
+    entry->referenced = true;
+    *output           = entry->output;
+    *status           = entry->status;
+    shard->hits++;
+    return true;
+}
+
+void BM11ResultCache::insert(const BM11Model::InputParameters *input, const BM11Model::OutputParameters *output, BM11Model::Status status)
+{
+    CacheKey key;
+    makeKey(_tolerance, input, &key);
+    size_t   hash  = CacheKeyHash()(key);
+    Shard   *shard = &_shards[(hash >> 32) & (_shard_count - 1)];
+
+    std::lock_guard<std::mutex> guard(shard->lock);
+    auto it = shard->index.find(key);
+    if (it != shard->index.end()) {
+        /* Another model got here first; keep its entry */
+        shard->entries[it->second].referenced = true;
+        return;
+    }
+
+    /* CLOCK: skip referenced entries once, take the first free or unreferenced one */
+    size_t      count = shard->entries.size();
+    CacheEntry *entry;
+    for (;;) {
+        entry       = &shard->entries[shard->hand];
+        shard->hand = (shard->hand + 1) % count;
+        if (!entry->occupied || !entry->referenced) {
+            break;
+        }
+        entry->referenced = false;
+    }
+    if (entry->occupied) {
+        shard->index.erase(entry->key);
+        shard->evictions++;
+    }
+
+    entry->key        = key;
+    entry->output     = *output;
+    entry->status     = status;
+    entry->referenced = false;
+    entry->occupied   = true;
+    shard->index[key] = (size_t)(entry - shard->entries.data());
+}
+
+BM11ResultCache::Stats BM11ResultCache::getStats(void)
+{
+    Stats stats;
+    memset(&stats, 0, sizeof(stats));
+
+    for (int s = 0; s < _shard_count; s++) {
+        std::lock_guard<std::mutex> guard(_shards[s].lock);
+        stats.hits      += _shards[s].hits;
+        stats.misses    += _shards[s].misses;
+        stats.evictions += _shards[s].evictions;
+        stats.entries   += _shards[s].index.size();
+    }
+    return stats;
+}
+
+void BM11ResultCache::clear(void)
+{
+    for (int s = 0; s < _shard_count; s++) {
+        std::lock_guard<std::mutex> guard(_shards[s].lock);
+        for (size_t i = 0; i < _shards[s].entries.size(); i++) {
+            _shards[s].entries[i].occupied   = false;
+            _shards[s].entries[i].referenced = false;
+        }
+        _shards[s].index.clear();
+        _shards[s].hand = 0;
+    }
+}
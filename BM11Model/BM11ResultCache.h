@@ -0,0 +1,56 @@
+#ifndef BM11_RESULT_CACHE_H
+#define BM11_RESULT_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "BM11Fields.h"
+
+/*
+   Bounded, thread-safe memo of OutputParameters keyed on quantized inputs.
+
+   Each input field is rounded to a multiple of its tolerance before it is
+   hashed, so designs that differ by less than the tolerance share an entry
+   (and get the outputs of whichever of them was inserted first). A
+   tolerance of 0, the default, keys on the exact float value.
+
+   The table is split into independently locked shards, each with CLOCK
+   (second chance) eviction, so many sweep workers can share one cache. A
+   cache can be attached to any number of BM11Model instances through
+   BM11Model::setResultCache(); it is not owned by them.
+ */
+
+class BM11ResultCache {
+public:
+    typedef struct {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+        uint64_t entries;
+    } Stats;
+
+    /* shard_count is rounded up to a power of two; 0 picks a default */
+    BM11ResultCache(size_t capacity, int shard_count = 0);
+    ~BM11ResultCache(void);
+
+    /* Set tolerances before the cache is shared; 0 = exact */
+    void  setTolerance(int field, float tolerance);
+    float getTolerance(int field) const;
+
+    bool  lookup(const BM11Model::InputParameters *input, BM11Model::OutputParameters *output, BM11Model::Status *status);
+    void  insert(const BM11Model::InputParameters *input, const BM11Model::OutputParameters *output, BM11Model::Status status);
+
+    Stats getStats(void);
+    void  clear(void);
+
+private:
+    struct Shard;
+
+    BM11ResultCache(const BM11ResultCache &);
+    BM11ResultCache &operator=(const BM11ResultCache &);
+
+    Shard   *_shards;
+    int      _shard_count;
+    float    _tolerance[BM11InputField_Count];
+};
+
+#endif /* BM11_RESULT_CACHE_H */
@@ -0,0 +1,564 @@
+#include <math.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "BM11ResultFile.h"
+
+#define RESULT_ALIGN        64
+#define RESULT_VERSION      1
+#define RESULT_NAME_SIZE    48
+#define RESULT_STAGING_ROWS 1024
+#define RESULT_TEXT_SIZE    (1 << 20)
+
+static const char resultMagic[8] = {'B', 'M', '1', '1', 'C', 'O', 'L', '1'};
+static const char chunkTag[8]    = {'B', 'M', '1', '1', 'C', 'H', 'N', 'K'};
+static const uint8_t zeroPad[RESULT_ALIGN] = {0};
+
+static inline size_t alignUp(size_t size)
+{
+    return (size + RESULT_ALIGN - 1) & ~(size_t)(RESULT_ALIGN - 1);
+}
+
+static size_t columnElementSize(const BM11ResultColumn *column)
+{
+    switch (column->source) {
+        case BM11ResultColumnStatus: return sizeof(uint8_t);
+        case BM11ResultColumnIndex:  return sizeof(uint64_t);
+        default:                     return sizeof(float);
+    }
+}
+
+static BM11ResultType columnType(const BM11ResultColumn *column)
+{
+    switch (column->source) {
+        case BM11ResultColumnStatus: return BM11ResultUInt8;
+        case BM11ResultColumnIndex:  return BM11ResultUInt64;
+        default:                     return BM11ResultFloat32;
+    }
+}
+
+int BM11ParseResultColumns(const char *list, BM11ResultColumn *columns, int max_columns)
+{
+    int count = 0;
+
+    while (*list) {
+        const char *end = strchr(list, ',');
+        size_t      length = end ? (size_t)(end - list) : strlen(list);
+        char        name[RESULT_NAME_SIZE];
+
+        while (length && (*list == ' ')) {
+            list++;
+            length--;
+        }
+        while (length && (list[length - 1] == ' ')) {
+            length--;
+        }
+        if (length >= sizeof(name)) {
+            return -1;
+        }
+        memcpy(name, list, length);
+        name[length] = 0;
+
+        if (length) {
+            int field;
+            if (strcmp(name, "outputs") == 0) {
+                if ((count + BM11OutputField_Count) > max_columns) {
+                    return -1;
+                }
+                for (int f = 0; f < BM11OutputField_Count; f++) {
+                    columns[count].source = BM11ResultColumnOutput;
+                    columns[count].field  = f;
+                    count++;
+                }
+            } else {
+                if (count >= max_columns) {
+                    return -1;
+                }
+                if (strcmp(name, "status") == 0) {
+                    columns[count].source = BM11ResultColumnStatus;
+                    columns[count].field  = 0;
+                } else if (strcmp(name, "index") == 0) {
+                    columns[count].source = BM11ResultColumnIndex;
+                    columns[count].field  = 0;
+                } else if ((field = BM11FindInputField(name)) >= 0) {
+                    columns[count].source = BM11ResultColumnInput;
+                    columns[count].field  = field;
+                } else if ((field = BM11FindOutputField(name)) >= 0) {
+                    columns[count].source = BM11ResultColumnOutput;
+                    columns[count].field  = field;
+                } else {
+                    return -1;
+                }
+                count++;
+            }
+        }
+        if (!end) {
+            break;
+        }
+        list = end + 1;
+    }
+    return count;
+}
+
+const char *BM11ResultColumnName(const BM11ResultColumn *column)
+{
+    switch (column->source) {
+        case BM11ResultColumnInput:  return BM11InputFieldInfo[column->field].name;
+        case BM11ResultColumnOutput: return BM11OutputFieldInfo[column->field].name;
+        case BM11ResultColumnStatus: return "status";
+        case BM11ResultColumnIndex:  return "index";
+    }
+    return "";
+}
+
+static int formatUInt64(char *buffer, uint64_t value)
+{
+    char digits[20];
+    int  count = 0;
+
+    do {
+        digits[count++] = (char)('0' + (value % 10));
+        value /= 10;
+    } while (value);
+    for (int i = 0; i < count; i++) {
+        buffer[i] = digits[count - 1 - i];
+    }
+    return count;
+}
+
+int BM11FormatFloat(char *buffer, float value, int decimals)
+{
+    static const uint64_t scale[] = {
+        1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull,
+        10000000ull, 100000000ull, 1000000000ull
+    };
+    int length = 0;
+
+    if (isnan(value)) {
+        memcpy(buffer, "nan", 4);
+        return 3;
+    }
+    if (isinf(value)) {
+        strcpy(buffer, (value < 0.0f) ? "-inf" : "inf");
+        return (value < 0.0f) ? 4 : 3;
+    }
+    if (decimals < 0) {
+        decimals = 0;
+    }
+
+    double magnitude = fabs((double)value);
+    if ((decimals > 9) || ((magnitude * (double)scale[decimals]) >= 1e18)) {
+        /* Out of fixed-point range; rare enough to leave to libc */
+        return snprintf(buffer, 49, "%.*g", 9, value);
+    }
+
+    uint64_t scaled   = (uint64_t)(magnitude * (double)scale[decimals] + 0.5);
+    uint64_t integer  = scaled / scale[decimals];
+    uint64_t fraction = scaled % scale[decimals];
+
+    if ((value < 0.0f) && scaled) {
+        buffer[length++] = '-';
+    }
+    length += formatUInt64(buffer + length, integer);
+    if (decimals) {
+        buffer[length++] = '.';
+        for (int i = decimals - 1; i >= 0; i--) {
+            buffer[length + i] = (char)('0' + (fraction % 10));
+            fraction /= 10;
+        }
+        length += decimals;
+    }
+    buffer[length] = 0;
+    return length;
+}
+
+/* Writer */
+
+BM11ResultWriter::BM11ResultWriter(void)
+{
+    _file         = NULL;
+    _format       = BM11ResultBinary;
+    _row_size     = 0;
+    _chunk_rows   = 0;
+    _chunk_fill   = 0;
+    _chunk_first  = 0;
+    _text_fill    = 0;
+    _decimals     = 6;
+    _rows_written = 0;
+    _error        = false;
+}
+
+BM11ResultWriter::~BM11ResultWriter(void)
+{
+    close();
+}
+
+bool BM11ResultWriter::open(const char *path, BM11ResultFormat format,
+                            const BM11ResultColumn *columns, int column_count,
+                            int thread_count, uint32_t chunk_rows)
+{
+    close();
+
+    if ((column_count <= 0) || (thread_count <= 0) || (chunk_rows == 0)) {
+        return false;
+    }
+    _file = fopen(path, "wb");
+    if (!_file) {
+        return false;
+    }
+
+    _format       = format;
+    _chunk_rows   = chunk_rows;
+    _chunk_fill   = 0;
+    _chunk_first  = 0;
+    _text_fill    = 0;
+    _rows_written = 0;
+    _error        = false;
+    _columns.assign(columns, columns + column_count);
+    _row_offset.resize(column_count);
+    _element_size.resize(column_count);
+    _row_size = 0;
+    for (int c = 0; c < column_count; c++) {
+        _element_size[c] = columnElementSize(&columns[c]);
+        _row_offset[c]   = _row_size;
+        _row_size       += _element_size[c];
+    }
+    _staging.resize(thread_count);
+    for (int t = 0; t < thread_count; t++) {
+        _staging[t].rows.resize(_row_size * RESULT_STAGING_ROWS);
+        _staging[t].count = 0;
+    }
+
+    if (format == BM11ResultBinary) {
+        uint8_t header[RESULT_ALIGN];
+        memset(header, 0, sizeof(header));
+        memcpy(header, resultMagic, sizeof(resultMagic));
+        uint32_t fields[4] = {RESULT_VERSION, (uint32_t)column_count, chunk_rows,
+                              (uint32_t)(RESULT_ALIGN + RESULT_ALIGN * column_count)};
+        memcpy(header + 8, fields, sizeof(fields));
+        _error |= (fwrite(header, sizeof(header), 1, _file) != 1);
+
+        for (int c = 0; c < column_count; c++) {
+            uint8_t descriptor[RESULT_ALIGN];
+            memset(descriptor, 0, sizeof(descriptor));
+            strncpy((char *)descriptor, BM11ResultColumnName(&columns[c]), RESULT_NAME_SIZE - 1);
+            uint32_t type[2] = {(uint32_t)columnType(&columns[c]), (uint32_t)_element_size[c]};
+            memcpy(descriptor + RESULT_NAME_SIZE, type, sizeof(type));
+            _error |= (fwrite(descriptor, sizeof(descriptor), 1, _file) != 1);
+        }
+
+        _chunk.resize(column_count);
+        for (int c = 0; c < column_count; c++) {
+            _chunk[c].resize(_element_size[c] * chunk_rows);
+        }
+    } else {
+        _text.resize(RESULT_TEXT_SIZE);
+        for (int c = 0; c < column_count; c++) {
+            fprintf(_file, "%s%s", c ? "," : "", BM11ResultColumnName(&columns[c]));
+        }
+        fputc('\n', _file);
+    }
+
+    return !_error;
+}
+
+void BM11ResultWriter::appendDesign(int thread_index, uint64_t index,
+                                    const BM11Model::InputParameters  *input,
+                                    const BM11Model::OutputParameters *output,
+                                    BM11Model::Status                  status)
+{
+    Staging *staging = &_staging[thread_index];
+    uint8_t *row     = staging->rows.data() + staging->count * _row_size;
+
+    for (size_t c = 0; c < _columns.size(); c++) {
+        uint8_t *slot = row + _row_offset[c];
+        switch (_columns[c].source) {
+            case BM11ResultColumnInput: {
+                float value = BM11GetInputField(input, _columns[c].field);
+                memcpy(slot, &value, sizeof(value));
+                break;
+            }
+            case BM11ResultColumnOutput: {
+                float value = BM11GetOutputField(output, _columns[c].field);
+                memcpy(slot, &value, sizeof(value));
+                break;
+            }
+            case BM11ResultColumnStatus:
+                *slot = (uint8_t)status;
+                break;
+            case BM11ResultColumnIndex:
+                memcpy(slot, &index, sizeof(index));
+                break;
+        }
+    }
+
+    if (++staging->count == RESULT_STAGING_ROWS) {
+        std::lock_guard<std::mutex> guard(_lock);
+        drain(staging);
+    }
+}
+
+/* Called with _lock held */
+void BM11ResultWriter::drain(Staging *staging)
+{
+    const uint8_t *row = staging->rows.data();
+
+    for (size_t r = 0; r < staging->count; r++, row += _row_size) {
+        if (_format == BM11ResultBinary) {
+            for (size_t c = 0; c < _columns.size(); c++) {
+                memcpy(_chunk[c].data() + _chunk_fill * _element_size[c], row + _row_offset[c], _element_size[c]);
+            }
+            if (++_chunk_fill == _chunk_rows) {
+                writeChunk();
+            }
+        } else {
+            writeCSVRow(row);
+        }
+    }
+    _rows_written  += staging->count;
+    staging->count  = 0;
+}
+
+void BM11ResultWriter::writeChunk(void)
+{
+    if (_chunk_fill == 0) {
+        return;
+    }
+
+    uint8_t  header[RESULT_ALIGN];
+    uint64_t counts[2] = {_chunk_fill, _chunk_first};
+    memset(header, 0, sizeof(header));
+    memcpy(header, chunkTag, sizeof(chunkTag));
+    memcpy(header + 8, counts, sizeof(counts));
+    _error |= (fwrite(header, sizeof(header), 1, _file) != 1);
+
+    for (size_t c = 0; c < _columns.size(); c++) {
+        size_t size = _element_size[c] * _chunk_fill;
+        _error |= (fwrite(_chunk[c].data(), 1, size, _file) != size);
+        if (alignUp(size) != size) {
+            _error |= (fwrite(zeroPad, 1, alignUp(size) - size, _file) != alignUp(size) - size);
+        }
+    }
+    _chunk_first += _chunk_fill;
+    _chunk_fill   = 0;
+}
+
+void BM11ResultWriter::writeCSVRow(const uint8_t *row)
+{
+    /* Worst case per column is a 48 byte float plus the separator */
+    if ((_text_fill + _columns.size() * 50 + 1) > _text.size()) {
+        _error    |= (fwrite(_text.data(), 1, _text_fill, _file) != _text_fill);
+        _text_fill = 0;
+    }
+
+    char *out = _text.data() + _text_fill;
+    for (size_t c = 0; c < _columns.size(); c++) {
+        const uint8_t *slot = row + _row_offset[c];
+        if (c) {
+            *out++ = ',';
+        }
+        switch (_columns[c].source) {
+            case BM11ResultColumnStatus:
+                out += formatUInt64(out, *slot);
+                break;
+            case BM11ResultColumnIndex: {
+                uint64_t index;
+                memcpy(&index, slot, sizeof(index));
+                out += formatUInt64(out, index);
+                break;
+            }
+            default: {
+                float value;
+                memcpy(&value, slot, sizeof(value));
+                out += BM11FormatFloat(out, value, _decimals);
+                break;
+            }
+        }
+    }
+    *out++     = '\n';
+    _text_fill = (size_t)(out - _text.data());
+}
+
+bool BM11ResultWriter::close(void)
+{
+    if (!_file) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        for (size_t t = 0; t < _staging.size(); t++) {
+            drain(&_staging[t]);
+        }
+        if (_format == BM11ResultBinary) {
+            writeChunk();
+        } else if (_text_fill) {
+            _error    |= (fwrite(_text.data(), 1, _text_fill, _file) != _text_fill);
+            _text_fill = 0;
+        }
+    }
+
+    _error |= (fclose(_file) != 0);
+    _file   = NULL;
+    _staging.clear();
+    _chunk.clear();
+    _text.clear();
+    return !_error;
+}
+
+/* Reader */
+
+BM11ResultReader::BM11ResultReader(void)
+{
+    _map          = NULL;
+    _map_size     = 0;
+    _column_count = 0;
+    _chunk_rows   = 0;
+    _row_count    = 0;
+}
+
+BM11ResultReader::~BM11ResultReader(void)
+{
+    close();
+}
+
+void BM11ResultReader::close(void)
+{
+    if (_map) {
+        munmap((void *)_map, _map_size);
+    }
+    _map          = NULL;
+    _map_size     = 0;
+    _column_count = 0;
+    _row_count    = 0;
+    _names.clear();
+    _types.clear();
+    _element_size.clear();
+    _chunk_offset.clear();
+}
+
+bool BM11ResultReader::open(const char *path)
+{
+    close();
+
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if ((fstat(fd, &info) != 0) || (info.st_size < RESULT_ALIGN)) {
+        ::close(fd);
+        return false;
+    }
+    _map_size = (size_t)info.st_size;
+    void *map = mmap(NULL, _map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        _map_size = 0;
+        return false;
+    }
+    _map = (const uint8_t *)map;
+
+    uint32_t fields[4];
+    memcpy(fields, _map + 8, sizeof(fields));
+    if ((memcmp(_map, resultMagic, sizeof(resultMagic)) != 0) || (fields[0] != RESULT_VERSION) ||
+        (fields[3] != RESULT_ALIGN + RESULT_ALIGN * (size_t)fields[1]) || (fields[3] > _map_size) || (fields[2] == 0)) {
+        close();
+        return false;
+    }
+    _column_count = (int)fields[1];
+    _chunk_rows   = fields[2];
+
+    for (int c = 0; c < _column_count; c++) {
+        const uint8_t *descriptor = _map + RESULT_ALIGN * (c + 1);
+        uint32_t       type[2];
+        char           name[RESULT_NAME_SIZE + 1];
+        memcpy(name, descriptor, RESULT_NAME_SIZE);
+        name[RESULT_NAME_SIZE] = 0;
+        memcpy(type, descriptor + RESULT_NAME_SIZE, sizeof(type));
+        _names.push_back(name);
+        _types.push_back((BM11ResultType)type[0]);
+        _element_size.push_back(type[1]);
+    }
+
+    /* Index chunks; a truncated trailing chunk (writer killed mid-write) is ignored */
+    size_t offset = fields[3];
+    while ((offset + RESULT_ALIGN) <= _map_size) {
+        uint64_t counts[2];
+        if (memcmp(_map + offset, chunkTag, sizeof(chunkTag)) != 0) {
+            break;
+        }
+        memcpy(counts, _map + offset + 8, sizeof(counts));
+        if ((counts[0] == 0) || (counts[0] > _chunk_rows)) {
+            break;
+        }
+        size_t size = RESULT_ALIGN;
+        for (int c = 0; c < _column_count; c++) {
+            size += alignUp(_element_size[c] * counts[0]);
+        }
+        if ((offset + size) > _map_size) {
+            break;
+        }
+        _chunk_offset.push_back(offset);
+        _row_count += counts[0];
+        offset     += size;
+    }
+    return true;
+}
+
+int BM11ResultReader::findColumn(const char *name)
+{
+    for (int c = 0; c < _column_count; c++) {
+        if (_names[c] == name) {
+            return c;
+        }
+    }
+    return -1;
+}
+
+uint64_t BM11ResultReader::getChunkRowCount(size_t chunk)
+{
+    uint64_t rows;
+    memcpy(&rows, _map + _chunk_offset[chunk] + 8, sizeof(rows));
+    return rows;
+}
+
+uint64_t BM11ResultReader::getChunkFirstRow(size_t chunk)
+{
+    uint64_t first;
+    memcpy(&first, _map + _chunk_offset[chunk] + 16, sizeof(first));
+    return first;
+}
+
+const void *BM11ResultReader::getChunkColumn(size_t chunk, int column)
+{
+    uint64_t rows   = getChunkRowCount(chunk);
+    size_t   offset = _chunk_offset[chunk] + RESULT_ALIGN;
+
+    for (int c = 0; c < column; c++) {
+        offset += alignUp(_element_size[c] * rows);
+    }
+    return _map + offset;
+}
+
+double BM11ResultReader::getValue(uint64_t row, int column)
+{
+    /* Every chunk but the last holds _chunk_rows rows */
+    size_t   chunk = (size_t)(row / _chunk_rows);
+    uint64_t at    = row % _chunk_rows;
+
+    const uint8_t *data = (const uint8_t *)getChunkColumn(chunk, column);
+    switch (_types[column]) {
+        case BM11ResultUInt64: {
+            uint64_t value;
+            memcpy(&value, data + at * sizeof(value), sizeof(value));
+            return (double)value;
+        }
+        case BM11ResultUInt8:
+            return data[at];
+        default:
+            return ((const float *)data)[at];
+    }
+}
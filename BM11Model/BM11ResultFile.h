@@ -0,0 +1,180 @@
+#ifndef BM11_RESULT_FILE_H
+#define BM11_RESULT_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "BM11Fields.h"
+
+/*
+   Streaming writer and memory-mapped reader for sweep results.
+
+   A result file holds a chosen subset of columns: any input or output field,
+   the design index and the BM11Model::Status. Two formats are written:
+
+   BM11ResultBinary, a chunked columnar layout meant to be mmap'ed. All
+   integers are little endian and every offset is a multiple of 64, so
+   column arrays can be used in place:
+
+      File header, 64 bytes
+         char     magic[8]        "BM11COL1"
+         uint32_t version         1
+         uint32_t column_count
+         uint32_t chunk_rows      rows in every chunk but the last
+         uint32_t header_size     64 + 64 * column_count
+         (zero padding)
+      Column descriptors, 64 bytes each
+         char     name[48]        NUL padded field name, e.g. "total.cost"
+         uint32_t type            BM11ResultType
+         uint32_t element_size    bytes per value
+         (zero padding)
+      Chunks, until end of file
+         char     tag[8]          "BM11CHNK"
+         uint64_t row_count
+         uint64_t first_row       row number of the chunk's first row
+         (zero padding to 64 bytes)
+         column_count arrays of row_count values, each padded to 64 bytes
+
+   BM11ResultCSV, a header line of column names followed by one line per
+   design, with floats printed by BM11FormatFloat() rather than printf.
+
+   appendDesign() may be called from several threads at once when the
+   writer was opened with a matching thread_count. Each thread stages rows
+   privately and hands them to the file in blocks under a lock. Rows
+   therefore land in the file in block order, not index order; include an
+   "index" column when order matters.
+ */
+
+typedef enum {
+    BM11ResultBinary,
+    BM11ResultCSV
+} BM11ResultFormat;
+
+typedef enum {
+    BM11ResultFloat32 = 0,
+    BM11ResultUInt64  = 1,
+    BM11ResultUInt8   = 2
+} BM11ResultType;
+
+typedef enum {
+    BM11ResultColumnInput,  /* float32, `field` is a BM11InputField  */
+    BM11ResultColumnOutput, /* float32, `field` is a BM11OutputField */
+    BM11ResultColumnStatus, /* uint8, BM11Model::Status              */
+    BM11ResultColumnIndex   /* uint64, sweep design index            */
+} BM11ResultColumnSource;
+
+typedef struct {
+    BM11ResultColumnSource source;
+    int                    field;
+} BM11ResultColumn;
+
+/* Parse a comma separated list such as "index,squareSideLength,total.cost".
+   Input field names are tried before output field names; "status" and
+   "index" name the extra columns and "outputs" expands to every output
+   field. Returns the column count, or -1 on an unknown name or overflow. */
+int  BM11ParseResultColumns(const char *list, BM11ResultColumn *columns, int max_columns);
+
+const char *BM11ResultColumnName(const BM11ResultColumn *column);
+
+/* Fixed-point float formatting without printf, e.g. (3.14159f, 3) -> "3.142".
+   Writes at most 48 bytes plus a NUL and returns the length. */
+int  BM11FormatFloat(char *buffer, float value, int decimals);
+
+class BM11ResultWriter {
+public:
+    BM11ResultWriter(void);
+    ~BM11ResultWriter(void);
+
+    bool open(const char *path, BM11ResultFormat format,
+              const BM11ResultColumn *columns, int column_count,
+              int thread_count = 1, uint32_t chunk_rows = 65536);
+
+    /* Digits after the decimal point in CSV files (default 6) */
+    void setDecimals(int decimals) { _decimals = decimals; };
+
+    void appendDesign(int thread_index, uint64_t index,
+                      const BM11Model::InputParameters  *input,
+                      const BM11Model::OutputParameters *output,
+                      BM11Model::Status                  status);
+
+    /* Flushes staged rows and the last chunk; returns false on any I/O error */
+    bool close(void);
+
+    uint64_t getRowCount(void) { return _rows_written; };
+
+private:
+    typedef struct {
+        std::vector<uint8_t> rows;
+        size_t               count;
+    } Staging;
+
+    BM11ResultWriter(const BM11ResultWriter &);
+    BM11ResultWriter &operator=(const BM11ResultWriter &);
+
+    void drain(Staging *staging);
+    void writeChunk(void);
+    void writeCSVRow(const uint8_t *row);
+
+    FILE                             *_file;
+    BM11ResultFormat                  _format;
+    std::vector<BM11ResultColumn>     _columns;
+    std::vector<size_t>               _row_offset;   /* Byte offset of each column in a staged row */
+    std::vector<size_t>               _element_size;
+    size_t                            _row_size;
+    std::vector<Staging>              _staging;
+    std::mutex                        _lock;
+    std::vector<std::vector<uint8_t>> _chunk;        /* Binary: one buffer per column */
+    uint32_t                          _chunk_rows;
+    uint32_t                          _chunk_fill;
+    uint64_t                          _chunk_first;  /* Row number of the chunk being filled */
+    std::vector<char>                 _text;         /* CSV output buffer */
+    size_t                            _text_fill;
+    int                               _decimals;
+    uint64_t                          _rows_written;
+    bool                              _error;
+};
+
+class BM11ResultReader {
+public:
+    BM11ResultReader(void);
+    ~BM11ResultReader(void);
+
+    /* Maps a BM11ResultBinary file; returns false if it is missing or malformed */
+    bool           open(const char *path);
+    void           close(void);
+
+    int            getColumnCount(void)      { return _column_count; };
+    const char    *getColumnName(int column) { return _names[column].c_str(); };
+    BM11ResultType getColumnType(int column) { return _types[column]; };
+    int            findColumn(const char *name);
+
+    uint64_t       getRowCount(void)         { return _row_count; };
+    size_t         getChunkCount(void)       { return _chunk_offset.size(); };
+    uint64_t       getChunkRowCount(size_t chunk);
+    uint64_t       getChunkFirstRow(size_t chunk);
+
+    /* Zero-copy pointer to one column of one chunk, 64-byte aligned */
+    const void    *getChunkColumn(size_t chunk, int column);
+
+    /* Convenience random access; converts any column type to double */
+    double         getValue(uint64_t row, int column);
+
+private:
+    BM11ResultReader(const BM11ResultReader &);
+    BM11ResultReader &operator=(const BM11ResultReader &);
+
+    const uint8_t              *_map;
+    size_t                      _map_size;
+    int                         _column_count;
+    uint32_t                    _chunk_rows;
+    uint64_t                    _row_count;
+    std::vector<std::string>    _names;
+    std::vector<BM11ResultType> _types;
+    std::vector<size_t>         _element_size;
+    std::vector<size_t>         _chunk_offset;
+};
+
+#endif /* BM11_RESULT_FILE_H */
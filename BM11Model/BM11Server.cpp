@@ -0,0 +1,863 @@
+#include <errno.h>
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string>
+#include "BM11Batch.h"
+#include "BM11Parallel.h"
+#include "BM11Server.h"
+
+#define SERVER_MAX_COLUMNS  256
+#define SERVER_MAX_DESIGNS  (1u << 20)
+#define SERVER_MAX_LINE     (64u << 20)
+#define SERVER_HEADER_SIZE  32
+#define SERVER_READ_SIZE    65536
+
+void BM11ServerConfigInit(BM11ServerConfig *config)
+{
+    memset(config, 0, sizeof(*config));
+    config->base           = BM11Model::getDefaultInputParameters();
+    config->thread_count   = 0;
+    config->batch_designs  = 1024;
+    config->batch_wait_us  = 0;
+    config->default_fields = "status,outputs";
+}
+
+struct BM11Server::Connection {
+    int                     in_fd;
+    int                     out_fd;
+    bool                    is_socket;
+    bool                    broken;
+    std::mutex              write_lock;
+    std::mutex              pending_lock;
+    std::condition_variable idle;
+    uint32_t                pending;    /* Requests queued but not yet answered */
+
+    Connection(int in, int out, bool socket)
+        : in_fd(in), out_fd(out), is_socket(socket), broken(false), pending(0) {}
+
+    /* Whole responses only; a client that stopped reading loses the rest */
+    void write(const void *data, size_t size)
+    {
+        std::lock_guard<std::mutex> guard(write_lock);
+        const char *p = (const char *)data;
+        while (size > 0 && !broken) {
+            ssize_t n = is_socket ? send(out_fd, p, size, MSG_NOSIGNAL) : ::write(out_fd, p, size);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                broken = true;
+                break;
+            }
+            p    += n;
+            size -= (size_t)n;
+        }
+    }
+};
+
+struct BM11Server::Request {
+    std::shared_ptr<Connection>             connection;
+    bool                                    binary;
+    std::string                             id;            /* JSON: raw id text      */
+    uint32_t                                binary_id;
+    std::vector<BM11ResultColumn>           columns;       /* JSON only              */
+    std::vector<int>                        column_slot;   /* Output column -> slot  */
+    std::vector<int>                        output_fields; /* One slot each          */
+    std::vector<BM11Model::InputParameters> inputs;
+    std::vector<float>                      values;        /* [design][slot]         */
+    std::vector<uint8_t>                    status;
+    std::atomic<uint32_t>                   remaining;     /* Designs not yet done   */
+};
+
+/* JSON */
+
+static void appendJSONString(std::string *out, const char *s, size_t length)
+{
+    out->push_back('"');
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)s[i];
+        if (c == '"' || c == '\\') {
+            out->push_back('\\');
+            out->push_back((char)c);
+        } else if (c < 0x20) {
+            char escape[8];
+            snprintf(escape, sizeof(escape), "\\u%04x", c);
+            out->append(escape);
+        } else {
+            out->push_back((char)c);
+        }
+    }
+    out->push_back('"');
+}
+
+static void appendJSONFloat(std::string *out, float value)
+{
+    if (!isfinite(value)) {
+        out->append("null");
+        return;
+    }
+    char buffer[32];
+    int  length = snprintf(buffer, sizeof(buffer), "%.9g", value);
+    out->append(buffer, (size_t)length);
+}
+
+static void appendJSONInteger(std::string *out, uint64_t value)
+{
+    char buffer[24];
+    int  length = snprintf(buffer, sizeof(buffer), "%llu", (unsigned long long)value);
+    out->append(buffer, (size_t)length);
+}
+
+static void skipSpace(const char **p)
+{
+    while (**p == ' ' || **p == '\t' || **p == '\r' || **p == '\n') {
+        (*p)++;
+    }
+}
+
+static bool expect(const char **p, char c)
+{
+    skipSpace(p);
+    if (**p != c) {
+        return false;
+    }
+    (*p)++;
+    return true;
+}
+
+/* Decodes escapes; \u escapes outside ASCII become '?', which no field name contains */
+static bool parseString(const char **p, std::string *out)
+{
+    skipSpace(p);
+    if (**p != '"') {
+        return false;
+    }
+    const char *s = *p + 1;
+    out->clear();
+    for (;;) {
+        char c = *s++;
+        if (c == '\0') {
+            return false;
+        }
+        if (c == '"') {
+            break;
+        }
+        if (c != '\\') {
+            out->push_back(c);
+            continue;
+        }
+        c = *s++;
+        switch (c) {
+        case 'b': out->push_back('\b'); break;
+        case 'f': out->push_back('\f'); break;
+        case 'n': out->push_back('\n'); break;
+        case 'r': out->push_back('\r'); break;
+        case 't': out->push_back('\t'); break;
+        case 'u': {
+            unsigned code = 0;
+            for (int i = 0; i < 4; i++, s++) {
+                char h = *s;
+                if (h >= '0' && h <= '9')      code = code * 16 + (unsigned)(h - '0');
+                else if (h >= 'a' && h <= 'f') code = code * 16 + (unsigned)(h - 'a' + 10);
+                else if (h >= 'A' && h <= 'F') code = code * 16 + (unsigned)(h - 'A' + 10);
+                else return false;
+            }
+            out->push_back(code < 0x80 ? (char)code : '?');
+            break;
+        }
+        case '"': case '\\': case '/':
+            out->push_back(c);
+            break;
+        default:
+            return false;
+        }
+    }
+    *p = s;
+    return true;
+}
+
+static bool parseNumber(const char **p, double *value)
+{
+    skipSpace(p);
+    char *end;
+    *value = strtod(*p, &end);
+    if (end == *p) {
+        return false;
+    }
+    *p = end;
+    return true;
+}
+
+static bool skipValue(const char **p, int depth)
+{
+    skipSpace(p);
+    if (depth > 64) {
+        return false;
+    }
+    char c = **p;
+    if (c == '"') {
+        std::string ignored;
+        return parseString(p, &ignored);
+    }
+    if (c == '{' || c == '[') {
+        char close = (c == '{') ? '}' : ']';
+        (*p)++;
+        if (expect(p, close)) {
+            return true;
+        }
+        do {
+            if (c == '{') {
+                std::string ignored;
+                if (!parseString(p, &ignored) || !expect(p, ':')) {
+                    return false;
+                }
+            }
+            if (!skipValue(p, depth + 1)) {
+                return false;
+            }
+        } while (expect(p, ','));
+        return expect(p, close);
+    }
+    static const char *const words[] = { "true", "false", "null" };
+    for (int i = 0; i < 3; i++) {
+        size_t length = strlen(words[i]);
+        if (strncmp(*p, words[i], length) == 0) {
+            *p += length;
+            return true;
+        }
+    }
+    double ignored;
+    return parseNumber(p, &ignored);
+}
+
+/* {"name": value, ...} over `base`; on failure `error` says why */
+static bool parseDesign(const char **p, const BM11Model::InputParameters *base,
+                        BM11Model::InputParameters *design, std::string *error)
+{
+    *design = *base;
+    if (!expect(p, '{')) {
+        *error = "a design must be an object";
+        return false;
+    }
+    if (expect(p, '}')) {
+        return true;
+    }
+    std::string name;
+    do {
+        double value;
+        if (!parseString(p, &name) || !expect(p, ':')) {
+            *error = "malformed design";
+            return false;
+        }
+        int field = BM11FindInputField(name.c_str());
+        if (field < 0) {
+            *error = "unknown input field '" + name + "'";
+            return false;
+        }
+        if (!parseNumber(p, &value)) {
+            *error = "'" + name + "' must be a number";
+            return false;
+        }
+        BM11SetInputField(design, field, (float)value);
+    } while (expect(p, ','));
+    if (!expect(p, '}')) {
+        *error = "malformed design";
+        return false;
+    }
+    return true;
+}
+
+/* "a,b" or ["a", "b"] into a comma separated list */
+static bool parseFieldList(const char **p, std::string *list)
+{
+    skipSpace(p);
+    if (**p == '"') {
+        return parseString(p, list);
+    }
+    if (!expect(p, '[')) {
+        return false;
+    }
+    list->clear();
+    if (expect(p, ']')) {
+        return true;
+    }
+    std::string name;
+    do {
+        if (!parseString(p, &name)) {
+            return false;
+        }
+        if (!list->empty()) {
+            list->push_back(',');
+        }
+        list->append(name);
+    } while (expect(p, ','));
+    return expect(p, ']');
+}
+
+/* Server */
+
+BM11Server::BM11Server(const BM11ServerConfig *config)
+    : _config(*config), _queued(0), _stopping(false),
+      _listen_fd(-1), _listening(false), _requests(0), _designs(0), _batches(0)
+{
+    if (_config.batch_designs == 0) {
+        _config.batch_designs = 1;
+    }
+    BM11ResultColumn columns[SERVER_MAX_COLUMNS];
+    int column_count = BM11ParseResultColumns(_config.default_fields ? _config.default_fields : "",
+                                              columns, SERVER_MAX_COLUMNS);
+    if (column_count > 0) {
+        _default_columns.assign(columns, columns + column_count);
+    }
+
+    int thread_count = (_config.thread_count > 0) ? _config.thread_count : BM11ParallelThreadCount();
+    for (int t = 0; t < thread_count; t++) {
+        _workers.push_back(std::thread(&BM11Server::worker, this));
+    }
+}
+
+BM11Server::~BM11Server(void)
+{
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _stopping = true;
+    }
+    _ready.notify_all();
+    for (size_t t = 0; t < _workers.size(); t++) {
+        _workers[t].join();
+    }
+}
+
+void BM11Server::worker(void)
+{
+    const uint32_t batch = _config.batch_designs;
+    const std::chrono::microseconds wait(_config.batch_wait_us);
+
+    /* Kept across batches; only columns some request wants are stored */
+    std::vector<float>   input_buffer((size_t)BM11InputField_Count * batch);
+    std::vector<float>   output_buffer((size_t)BM11OutputField_Count * batch);
+    std::vector<uint8_t> status_buffer(batch);
+    std::vector<Work>    taken;
+
+    BM11BatchInput  batch_input;
+    BM11BatchOutput batch_output;
+    for (int f = 0; f < BM11InputField_Count; f++) {
+        batch_input.column[f] = &input_buffer[(size_t)f * batch];
+    }
+    batch_output.status = &status_buffer[0];
+
+    std::unique_lock<std::mutex> lock(_lock);
+    for (;;) {
+        if (_queue.empty()) {
+            if (_stopping) {
+                return;
+            }
+            _ready.wait(lock);
+            continue;
+        }
+        if (_queued < batch && !_stopping) {
+            std::chrono::steady_clock::time_point deadline = _queue.front().queued + wait;
+            if (std::chrono::steady_clock::now() < deadline) {
+                _ready.wait_until(lock, deadline);
+                continue;
+            }
+        }
+
+        /* Take up to a batch from the front, splitting the last request taken */
+        taken.clear();
+        uint32_t count = 0;
+        while (!_queue.empty() && count < batch) {
+            Work    &front = _queue.front();
+            uint32_t n     = std::min(front.end - front.begin, batch - count);
+            Work     part  = front;
+            part.end = part.begin + n;
+            taken.push_back(part);
+            count += n;
+            if (part.end == front.end) {
+                _queue.pop_front();
+            } else {
+                front.begin = part.end;
+            }
+        }
+        _queued -= count;
+        if (!_queue.empty()) {
+            _ready.notify_one();
+        }
+        lock.unlock();
+
+        bool want[BM11OutputField_Count] = { false };
+        uint32_t row = 0;
+        for (size_t w = 0; w < taken.size(); w++) {
+            const Request *request = taken[w].request;
+            for (size_t k = 0; k < request->output_fields.size(); k++) {
+                want[request->output_fields[k]] = true;
+            }
+            for (uint32_t d = taken[w].begin; d < taken[w].end; d++, row++) {
+                const BM11Model::InputParameters *design = &request->inputs[d];
+                for (int f = 0; f < BM11InputField_Count; f++) {
+                    input_buffer[(size_t)f * batch + row] = BM11GetInputField(design, f);
+                }
+            }
+        }
+        for (int f = 0; f < BM11OutputField_Count; f++) {
+            batch_output.column[f] = want[f] ? &output_buffer[(size_t)f * batch] : NULL;
+        }
+        BM11EvaluateBatch(&batch_input, &batch_output, count);
+        _batches++;
+
+        row = 0;
+        for (size_t w = 0; w < taken.size(); w++) {
+            Request *request = taken[w].request;
+            size_t   slots   = request->output_fields.size();
+            for (uint32_t d = taken[w].begin; d < taken[w].end; d++, row++) {
+                float *values = slots ? &request->values[d * slots] : NULL;
+                for (size_t k = 0; k < slots; k++) {
+                    values[k] = output_buffer[(size_t)request->output_fields[k] * batch + row];
+                }
+                request->status[d] = status_buffer[row];
+            }
+            uint32_t n = taken[w].end - taken[w].begin;
+            if (request->remaining.fetch_sub(n) == n) {
+                finish(request);
+            }
+        }
+
+        lock.lock();
+    }
+}
+
+void BM11Server::submit(Request *request)
+{
+    uint32_t count = (uint32_t)request->inputs.size();
+    request->status.resize(count);
+    request->values.resize((size_t)count * request->output_fields.size());
+    request->remaining = count;
+    {
+        std::lock_guard<std::mutex> guard(request->connection->pending_lock);
+        request->connection->pending++;
+    }
+    _requests++;
+    _designs += count;
+    if (count == 0) {
+        finish(request);
+        return;
+    }
+
+    Work work;
+    work.request = request;
+    work.begin   = 0;
+    work.end     = count;
+    work.queued  = std::chrono::steady_clock::now();
+
+    bool full;
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _queue.push_back(work);
+        _queued += count;
+        full = (_queued >= _config.batch_designs);
+    }
+    if (full) {
+        _ready.notify_all();
+    } else {
+        _ready.notify_one();
+    }
+}
+
+void BM11Server::finish(Request *request)
+{
+    std::shared_ptr<Connection> connection = request->connection;
+    uint32_t count = (uint32_t)request->inputs.size();
+    size_t   slots = request->output_fields.size();
+
+    if (request->binary) {
+        size_t status_size = (count + 3u) & ~3u;
+        std::vector<uint8_t> response(SERVER_HEADER_SIZE + status_size + sizeof(float) * count * slots, 0);
+        uint32_t header[4] = { request->binary_id, count, (uint32_t)slots, 0 };
+        memcpy(&response[0], "BM11RES1", 8);
+        memcpy(&response[8], header, sizeof(header));
+        if (count > 0) {
+            memcpy(&response[SERVER_HEADER_SIZE], &request->status[0], count);
+        }
+        if (count > 0 && slots > 0) {
+            memcpy(&response[SERVER_HEADER_SIZE + status_size], &request->values[0], sizeof(float) * count * slots);
+        }
+        connection->write(&response[0], response.size());
+    } else {
+        std::string response;
+        response.reserve(64 + (size_t)count * (2 + request->columns.size() * 32));
+        response.append("{\"id\":");
+        response.append(request->id);
+        response.append(",\"results\":[");
+        for (uint32_t d = 0; d < count; d++) {
+            response.append(d ? ",{" : "{");
+            for (size_t c = 0; c < request->columns.size(); c++) {
+                const BM11ResultColumn *column = &request->columns[c];
+                if (c) {
+                    response.push_back(',');
+                }
+                const char *name = BM11ResultColumnName(column);
+                appendJSONString(&response, name, strlen(name));
+                response.push_back(':');
+                switch (column->source) {
+                case BM11ResultColumnInput:
+                    appendJSONFloat(&response, BM11GetInputField(&request->inputs[d], column->field));
+                    break;
+                case BM11ResultColumnOutput:
+                    appendJSONFloat(&response, request->values[d * slots + request->column_slot[c]]);
+                    break;
+                case BM11ResultColumnStatus:
+                    appendJSONInteger(&response, request->status[d]);
+                    break;
+                case BM11ResultColumnIndex:
+                    appendJSONInteger(&response, d);
+                    break;
+                }
+            }
+            response.push_back('}');
+        }
+        response.append("]}\n");
+        connection->write(response.data(), response.size());
+    }
+    delete request;
+
+    std::lock_guard<std::mutex> guard(connection->pending_lock);
+    if (--connection->pending == 0) {
+        connection->idle.notify_all();
+    }
+}
+
+bool BM11Server::handleJSON(std::shared_ptr<Connection> connection, const char *line)
+{
+    const char *p = line;
+    std::string id = "null";
+    std::string error;
+    std::string key, list;
+    bool have_fields  = false;
+    bool have_designs = false;
+    std::vector<BM11ResultColumn> columns;
+    std::vector<BM11Model::InputParameters> inputs;
+
+    if (!expect(&p, '{')) {
+        error = "a request must be an object";
+    } else if (!expect(&p, '}')) {
+        do {
+            if (!parseString(&p, &key) || !expect(&p, ':')) {
+                error = "malformed request";
+                break;
+            }
+            if (key == "id") {
+                skipSpace(&p);
+                const char *start = p;
+                if (!skipValue(&p, 0)) {
+                    error = "malformed id";
+                    break;
+                }
+                id.assign(start, (size_t)(p - start));
+            } else if (key == "fields") {
+                BM11ResultColumn parsed[SERVER_MAX_COLUMNS];
+                int column_count;
+                if (!parseFieldList(&p, &list)) {
+                    error = "fields must be a string or a list of strings";
+                    break;
+                }
+                column_count = BM11ParseResultColumns(list.c_str(), parsed, SERVER_MAX_COLUMNS);
+                if (column_count < 0) {
+                    error = "unknown field in '" + list + "'";
+                    break;
+                }
+                columns.assign(parsed, parsed + column_count);
+                have_fields = true;
+            } else if (key == "input") {
+                /* A repeated "input" counts towards the same limit */
+                if (inputs.size() >= SERVER_MAX_DESIGNS) {
+                    error = "too many designs";
+                    break;
+                }
+                BM11Model::InputParameters design;
+                if (!parseDesign(&p, &_config.base, &design, &error)) {
+                    break;
+                }
+                inputs.push_back(design);
+                have_designs = true;
+            } else if (key == "designs") {
+                have_designs = true;
+                if (!expect(&p, '[')) {
+                    error = "designs must be a list";
+                    break;
+                }
+                if (!expect(&p, ']')) {
+                    do {
+                        /* Refused before parsing the rest, however long the list */
+                        if (inputs.size() >= SERVER_MAX_DESIGNS) {
+                            error = "too many designs";
+                            break;
+                        }
+                        BM11Model::InputParameters design;
+                        if (!parseDesign(&p, &_config.base, &design, &error)) {
+                            break;
+                        }
+                        inputs.push_back(design);
+                    } while (expect(&p, ','));
+                    if (error.empty() && !expect(&p, ']')) {
+                        error = "malformed designs";
+                    }
+                }
+                if (!error.empty()) {
+                    break;
+                }
+            } else if (!skipValue(&p, 0)) {
+                error = "malformed request";
+                break;
+            }
+        } while (expect(&p, ','));
+        if (error.empty() && !expect(&p, '}')) {
+            error = "malformed request";
+        }
+    }
+
+    if (!error.empty()) {
+        std::string response = "{\"id\":" + id + ",\"error\":";
+        appendJSONString(&response, error.data(), error.size());
+        response.append("}\n");
+        connection->write(response.data(), response.size());
+        return false;
+    }
+
+    Request *request = new Request;
+    request->connection = connection;
+    request->binary     = false;
+    request->id         = id;
+    request->binary_id  = 0;
+    request->columns    = have_fields ? columns : _default_columns;
+    request->column_slot.assign(request->columns.size(), -1);
+    for (size_t c = 0; c < request->columns.size(); c++) {
+        if (request->columns[c].source != BM11ResultColumnOutput) {
+            continue;
+        }
+        int field = request->columns[c].field;
+        std::vector<int>::iterator slot = std::find(request->output_fields.begin(), request->output_fields.end(), field);
+        request->column_slot[c] = (int)(slot - request->output_fields.begin());
+        if (slot == request->output_fields.end()) {
+            request->output_fields.push_back(field);
+        }
+    }
+    if (!have_designs) {
+        inputs.push_back(_config.base);
+    }
+    request->inputs.swap(inputs);
+    submit(request);
+    return true;
+}
+
+size_t BM11Server::handleBinary(std::shared_ptr<Connection> connection, const uint8_t *data, size_t size)
+{
+    if (size < SERVER_HEADER_SIZE) {
+        return 0;
+    }
+    uint32_t header[4];
+    memcpy(header, data + 8, sizeof(header));
+    uint32_t id = header[0], design_count = header[1], input_count = header[2], output_count = header[3];
+
+    uint8_t error[SERVER_HEADER_SIZE] = { 0 };
+    uint32_t error_header[4] = { id, 0, 0, 1 };
+    memcpy(error, "BM11RES1", 8);
+    memcpy(error + 8, error_header, sizeof(error_header));
+
+    /* A bad header leaves no way to find the next request */
+    if (memcmp(data, "BM11REQ1", 8) != 0 || design_count > SERVER_MAX_DESIGNS ||
+        input_count > BM11InputField_Count || output_count > BM11OutputField_Count) {
+        connection->write(error, sizeof(error));
+        return SIZE_MAX;
+    }
+    size_t fields_size = sizeof(uint32_t) * (input_count + output_count);
+    size_t total       = SERVER_HEADER_SIZE + fields_size + sizeof(float) * (size_t)design_count * input_count;
+    if (size < total) {
+        return 0;
+    }
+
+    std::vector<uint32_t> fields(input_count + output_count);
+    if (!fields.empty()) {
+        memcpy(&fields[0], data + SERVER_HEADER_SIZE, fields_size);
+    }
+    for (uint32_t i = 0; i < input_count + output_count; i++) {
+        uint32_t limit = (i < input_count) ? (uint32_t)BM11InputField_Count : (uint32_t)BM11OutputField_Count;
+        if (fields[i] >= limit) {
+            connection->write(error, sizeof(error));
+            return total;
+        }
+    }
+
+    Request *request = new Request;
+    request->connection = connection;
+    request->binary     = true;
+    request->binary_id  = id;
+    request->output_fields.assign(fields.begin() + input_count, fields.end());
+    request->inputs.assign(design_count, _config.base);
+    const uint8_t *values = data + SERVER_HEADER_SIZE + fields_size;
+    for (uint32_t d = 0; d < design_count; d++) {
+        for (uint32_t i = 0; i < input_count; i++, values += sizeof(float)) {
+            float value;
+            memcpy(&value, values, sizeof(value));
+            BM11SetInputField(&request->inputs[d], (int)fields[i], value);
+        }
+    }
+    submit(request);
+    return total;
+}
+
+void BM11Server::readClient(std::shared_ptr<Connection> connection)
+{
+    std::vector<char> buffer;
+    size_t fill = 0;
+    bool   done = false;
+
+    while (!done) {
+        if (buffer.size() - fill < SERVER_READ_SIZE) {
+            buffer.resize(fill + SERVER_READ_SIZE);
+        }
+        ssize_t n = read(connection->in_fd, &buffer[fill], buffer.size() - fill);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        bool eof = (n <= 0);
+        if (!eof) {
+            fill += (size_t)n;
+        }
+
+        size_t start = 0;
+        for (;;) {
+            while (start < fill && (buffer[start] == ' ' || buffer[start] == '\t' ||
+                                    buffer[start] == '\r' || buffer[start] == '\n')) {
+                start++;
+            }
+            if (start == fill) {
+                break;
+            }
+            if (buffer[start] == 'B') {
+                size_t used = handleBinary(connection, (const uint8_t *)&buffer[start], fill - start);
+                if (used == SIZE_MAX) {
+                    done = true;
+                    break;
+                }
+                if (used == 0) {
+                    break;
+                }
+                start += used;
+                continue;
+            }
+            char *newline = (char *)memchr(&buffer[start], '\n', fill - start);
+            if (newline == NULL) {
+                if (!eof && fill - start < SERVER_MAX_LINE) {
+                    break;
+                }
+                /* Last line without a newline, or a line too long to keep */
+                buffer.resize(std::max(buffer.size(), fill + 1));
+                buffer[fill] = '\0';
+                handleJSON(connection, &buffer[start]);
+                start = fill;
+                done  = true;
+                break;
+            }
+            *newline = '\0';
+            handleJSON(connection, &buffer[start]);
+            start = (size_t)(newline - &buffer[0]) + 1;
+        }
+        if (start > 0) {
+            memmove(&buffer[0], &buffer[start], fill - start);
+            fill -= start;
+        }
+        if (eof) {
+            done = true;
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(connection->pending_lock);
+    while (connection->pending > 0) {
+        connection->idle.wait(lock);
+    }
+}
+
+bool BM11Server::serveStream(int in_fd, int out_fd)
+{
+    signal(SIGPIPE, SIG_IGN);
+    readClient(std::make_shared<Connection>(in_fd, out_fd, false));
+    return true;
+}
+
+bool BM11Server::serveSocket(const char *path)
+{
+    struct sockaddr_un address;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        return false;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        return false;
+    }
+    unlink(path);
+    if (bind(listen_fd, (struct sockaddr *)&address, sizeof(address)) < 0 || listen(listen_fd, 64) < 0) {
+        close(listen_fd);
+        return false;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    _listen_fd = listen_fd;
+    _listening = true;
+
+    while (_listening) {
+        int fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0) {
+            if (_listening && (errno == EINTR || errno == ECONNABORTED)) {
+                continue;
+            }
+            break;
+        }
+        std::shared_ptr<Connection> connection = std::make_shared<Connection>(fd, fd, true);
+        {
+            std::lock_guard<std::mutex> guard(_clients_lock);
+            _clients.push_back(connection);
+        }
+        std::thread([this, connection]() {
+            readClient(connection);
+            std::lock_guard<std::mutex> guard(_clients_lock);
+            _clients.erase(std::find(_clients.begin(), _clients.end(), connection));
+            close(connection->in_fd);
+            _clients_done.notify_all();
+        }).detach();
+    }
+    _listening = false;
+
+    /* Clients see end of input, get their outstanding responses and close */
+    std::unique_lock<std::mutex> lock(_clients_lock);
+    for (size_t c = 0; c < _clients.size(); c++) {
+        shutdown(_clients[c]->in_fd, SHUT_RD);
+    }
+    while (!_clients.empty()) {
+        _clients_done.wait(lock);
+    }
+    lock.unlock();
+
+    _listen_fd = -1;
+    close(listen_fd);
+    unlink(path);
+    return true;
+}
+
+void BM11Server::stop(void)
+{
+    _listening = false;
+    int fd = _listen_fd;
+    if (fd >= 0) {
+        shutdown(fd, SHUT_RDWR);
+    }
+}
@@ -0,0 +1,150 @@
+#ifndef BM11_SERVER_H
+#define BM11_SERVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "BM11Fields.h"
+#include "BM11ResultFile.h"
+
+/*
+   Long-running evaluation server.
+
+   Clients talk to it over a Unix domain socket (serveSocket()) or a pair
+   of file descriptors such as stdin/stdout (serveStream()). Each request
+   carries one or many designs, given as overrides of the config's base
+   inputs, and names the fields it wants back. Requests from every client
+   are queued as designs; a pool of worker threads takes them in batches
+   of up to batch_designs, waiting at most batch_wait_us for a batch to
+   fill, and evaluates each batch with BM11EvaluateBatch() into buffers
+   the worker keeps between batches. Requests that arrive while every
+   worker is busy share the next batch even without a wait, so the wait
+   only pays off with many workers and many small requests. A request may
+   be split across batches; its response is written once all of its
+   designs are done. Responses to requests on one connection can
+   therefore come back out of order; the request id tells them apart.
+
+   Results are the batch path's, so they match BM11Model to float
+   tolerance (see BM11Batch.h).
+
+   JSON requests are one object per line:
+
+      {"id": 1, "fields": ["total.cost", "status"], "input": {"squareSideLength": 14}}
+      {"id": "b", "fields": "index,total.cost", "designs": [{"angle_ABC": 1.9}, {}]}
+
+   "fields" is a list or a comma separated string of names as accepted by
+   BM11ParseResultColumns(): input and output fields, "status", "index"
+   (the design's position in the request) and "outputs"; when missing,
+   default_fields is used. "input" is a single design and "designs" a list
+   of them; with neither, the base design is evaluated. "id" is echoed
+   verbatim. The response is one line,
+
+      {"id": 1, "results": [{"total.cost": 6877.72217, "status": 0}]}
+
+   with non-finite values as null, or {"id": 1, "error": "..."}.
+
+   Binary requests start with their magic instead of "{". All integers are
+   native (little endian) uint32_t:
+
+      Request, 32 byte header
+         char     magic[8]        "BM11REQ1"
+         uint32_t id
+         uint32_t design_count    at most 2^20
+         uint32_t input_count     overridden input fields
+         uint32_t output_count    returned output fields
+         (zero padding)
+      uint32_t input_field[input_count]    BM11InputField
+      uint32_t output_field[output_count]  BM11OutputField
+      float    input[design_count][input_count]
+
+      Response, 32 byte header
+         char     magic[8]        "BM11RES1"
+         uint32_t id
+         uint32_t design_count    at most 2^20
+         uint32_t output_count
+         uint32_t error           0, or 1 for a malformed request (no body)
+         (zero padding)
+      uint8_t  status[design_count], zero padded to a multiple of 4 bytes
+      float    output[design_count][output_count]
+ */
+
+typedef struct {
+    BM11Model::InputParameters base;           /* Inputs a request doesn't override       */
+    int                        thread_count;   /* Batch workers, 0 = all hardware threads */
+    uint32_t                   batch_designs;  /* A batch this large goes at once         */
+    uint32_t                   batch_wait_us;  /* Longest a design waits for company      */
+    const char                *default_fields; /* For JSON requests without "fields"      */
+} BM11ServerConfig;
+
+/* Default inputs, all threads, batches of up to 1024 designs without
+   waiting, every output field and the status */
+void BM11ServerConfigInit(BM11ServerConfig *config);
+
+class BM11Server {
+public:
+    BM11Server(const BM11ServerConfig *config);
+    ~BM11Server(void);
+
+    /* Serves one client until end of input and its last response */
+    bool     serveStream(int in_fd, int out_fd);
+
+    /* Listens on `path`, replacing any stale socket, until stop() */
+    bool     serveSocket(const char *path);
+
+    /* Makes serveSocket() return after closing its clients; safe from any thread */
+    void     stop(void);
+
+    uint64_t getRequestCount(void) const { return _requests; };
+    uint64_t getDesignCount(void) const  { return _designs; };
+    uint64_t getBatchCount(void) const   { return _batches; };
+
+private:
+    struct Connection;
+    struct Request;
+
+    typedef struct {
+        Request                              *request;
+        uint32_t                              begin;
+        uint32_t                              end;
+        std::chrono::steady_clock::time_point queued;
+    } Work;
+
+    BM11Server(const BM11Server &);
+    BM11Server &operator=(const BM11Server &);
+
+    void     worker(void);
+    void     submit(Request *request);
+    void     finish(Request *request);
+    void     readClient(std::shared_ptr<Connection> connection);
+    bool     handleJSON(std::shared_ptr<Connection> connection, const char *line);
+    size_t   handleBinary(std::shared_ptr<Connection> connection, const uint8_t *data, size_t size);
+
+    BM11ServerConfig                        _config;
+    std::vector<BM11ResultColumn>           _default_columns;
+
+    std::mutex                              _lock;
+    std::condition_variable                 _ready;
+    std::deque<Work>                        _queue;
+    size_t                                  _queued;            /* Designs in _queue        */
+    bool                                    _stopping;
+    std::vector<std::thread>                _workers;
+
+    std::mutex                              _clients_lock;
+    std::condition_variable                 _clients_done;
+    std::vector<std::shared_ptr<Connection>> _clients;
+    std::atomic<int>                        _listen_fd;
+    std::atomic<bool>                       _listening;
+
+    std::atomic<uint64_t>                   _requests;
+    std::atomic<uint64_t>                   _designs;
+    std::atomic<uint64_t>                   _batches;
+};
+
+#endif /* BM11_SERVER_H */
@@ -0,0 +1,430 @@
+#include <math.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+#include "BM11Parallel.h"
+#include "BM11Surrogate.h"
+
+#define SURROGATE_MAGIC   "BM11SUR1"
+#define SURROGATE_VERSION 1
+#define HEADER_SIZE       128
+
+typedef struct {
+    char     magic[8];
+    uint32_t version;
+    uint32_t field_count;
+    uint32_t axis_field[BM11_SURROGATE_AXES];
+    uint32_t axis_count[BM11_SURROGATE_AXES];
+    float    axis_min[BM11_SURROGATE_AXES];
+    float    axis_max[BM11_SURROGATE_AXES];
+    uint64_t node_count;
+    uint64_t status_offset;
+    uint64_t value_offset;
+    uint64_t file_size;
+} SurrogateHeader;
+
+static_assert(sizeof(SurrogateHeader) <= HEADER_SIZE, "Surrogate header doesn't fit");
+
+static const int axisField[BM11_SURROGATE_AXES] = {
+    BM11InputField_squareSideLength,
+    BM11InputField_baseCutBackLength,
+    BM11InputField_angle_ABC,
+};
+
+/* The stages query() runs on interpolated geometry */
+static const unsigned int derivedStages = (1u << BM11Model::StageOverallStructure) |
+                                          (1u << BM11Model::StageFrame)            |
+                                          (1u << BM11Model::StageMirror)           |
+                                          (1u << BM11Model::StageTotals);
+
+/* Outputs of the stages that only depend on the axes */
+static bool isStoredField(int field)
+{
+    return ((field >= BM11OutputField_edge_length_OB) && (field <= BM11OutputField_vertex_coord_C1_z)) ||
+           (field == BM11OutputField_dihedral_angle_angle_BOA_BOC) ||
+           (field == BM11OutputField_dihedral_angle_angle_BOA_ABC) ||
+           (field == BM11OutputField_wind_total_surface_area_XY)   ||
+           (field == BM11OutputField_wind_total_surface_area_YZ);
+}
+
+static inline uint64_t align64(uint64_t offset)
+{
+    return (offset + 63) & ~(uint64_t)63;
+}
+
+static inline float axisValue(float min, float max, uint32_t count, uint32_t i)
+{
+    return min + (max - min) * ((float)i / (float)(count - 1));
+}
+
+void BM11SurrogateConfigInit(BM11SurrogateConfig *config)
+{
+    memset(config, 0, sizeof(*config));
+    config->base     = BM11Model::getDefaultInputParameters();
+    config->count[0] = 33;
+    config->min[0]   = 8.0f;
+    config->max[0]   = 24.0f;
+    config->count[1] = 25;
+    config->min[1]   = 0.0f;
+    config->max[1]   = 6.0f;
+    config->count[2] = 31;
+    config->min[2]   = BMMathDegreesToRadians(90.0f);
+    config->max[2]   = BMMathDegreesToRadians(150.0f);
+}
+
+/* Builder */
+
+typedef struct {
+    const BM11SurrogateConfig *config;
+    const uint32_t            *field;
+    int                        field_count;
+    uint8_t                   *status;
+    float                     *value;
+    BM11Model                 *models;
+} BuildJob;
+
+static void buildRange(void *context, uint64_t begin, uint64_t end, int thread_index)
+{
+    BuildJob                  *job    = (BuildJob *)context;
+    const BM11SurrogateConfig *config = job->config;
+    BM11Model                 *model  = &job->models[thread_index];
+    BM11Model::InputParameters input  = config->base;
+
+    for (uint64_t n = begin; n < end; n++) {
+        uint32_t i2 = (uint32_t)(n % config->count[2]);
+        uint32_t i1 = (uint32_t)((n / config->count[2]) % config->count[1]);
+        uint32_t i0 = (uint32_t)(n / ((uint64_t)config->count[2] * config->count[1]));
+        BM11SetInputField(&input, axisField[0], axisValue(config->min[0], config->max[0], config->count[0], i0));
+        BM11SetInputField(&input, axisField[1], axisValue(config->min[1], config->max[1], config->count[1], i1));
+        BM11SetInputField(&input, axisField[2], axisValue(config->min[2], config->max[2], config->count[2], i2));
+        model->setInputParameters(input);
+
+        BM11Model::OutputParameters output = model->getOutputParameters();
+        float                      *value  = &job->value[n * job->field_count];
+        job->status[n] = (uint8_t)model->getStatus();
+        for (int f = 0; f < job->field_count; f++) {
+            value[f] = BM11GetOutputField(&output, job->field[f]);
+        }
+    }
+}
+
+bool BM11SurrogateBuild(const BM11SurrogateConfig *config, const char *path)
+{
+    uint64_t node_count = 1;
+    for (int a = 0; a < BM11_SURROGATE_AXES; a++) {
+        if ((config->count[a] < 2) || !(config->min[a] < config->max[a])) {
+            return false;
+        }
+        node_count *= config->count[a];
+    }
+
+    uint32_t fields[BM11OutputField_Count];
+    int      field_count = 0;
+    for (int f = 0; f < BM11OutputField_Count; f++) {
+        if (isStoredField(f)) {
+            fields[field_count++] = (uint32_t)f;
+        }
+    }
+
+    SurrogateHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SURROGATE_MAGIC, 8);
+    header.version       = SURROGATE_VERSION;
+    header.field_count   = (uint32_t)field_count;
+    for (int a = 0; a < BM11_SURROGATE_AXES; a++) {
+        header.axis_field[a] = (uint32_t)axisField[a];
+        header.axis_count[a] = config->count[a];
+        header.axis_min[a]   = config->min[a];
+        header.axis_max[a]   = config->max[a];
+    }
+    header.node_count    = node_count;
+    header.status_offset = align64(HEADER_SIZE + sizeof(uint32_t) * field_count);
+    header.value_offset  = align64(header.status_offset + node_count);
+    header.file_size     = align64(header.value_offset + sizeof(float) * field_count * node_count);
+
+    int fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    if (ftruncate(fd, (off_t)header.file_size) != 0) {
+        ::close(fd);
+        return false;
+    }
+    void *map = mmap(NULL, header.file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+
+    uint8_t *base = (uint8_t *)map;
+    memcpy(base, &header, sizeof(header));
+    memcpy(base + HEADER_SIZE, fields, sizeof(uint32_t) * field_count);
+
+    int thread_count = (config->thread_count > 0) ? config->thread_count : BM11ParallelThreadCount();
+    std::vector<BM11Model> models(thread_count);
+    BuildJob job;
+    job.config      = config;
+    job.field       = fields;
+    job.field_count = field_count;
+    job.status      = base + header.status_offset;
+    job.value       = (float *)(base + header.value_offset);
+    job.models      = models.data();
+    BM11ParallelFor(node_count, 0, thread_count, buildRange, &job);
+
+    bool ok = (msync(map, header.file_size, MS_SYNC) == 0);
+    munmap(map, header.file_size);
+    return ok;
+}
+
+/* Reader */
+
+BM11Surrogate::BM11Surrogate(void)
+{
+    _map         = NULL;
+    _map_size    = 0;
+    _field       = NULL;
+    _status      = NULL;
+    _value       = NULL;
+    _field_count = 0;
+    for (int a = 0; a < BM11_SURROGATE_AXES; a++) {
+        _count[a] = 0;
+        _min[a]   = 0.0f;
+        _max[a]   = 0.0f;
+    }
+}
+
+BM11Surrogate::~BM11Surrogate(void)
+{
+    close();
+}
+
+bool BM11Surrogate::open(const char *path)
+{
+    close();
+
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || ((size_t)st.st_size < HEADER_SIZE)) {
+        ::close(fd);
+        return false;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    _map      = (const uint8_t *)map;
+    _map_size = (size_t)st.st_size;
+
+    SurrogateHeader header;
+    memcpy(&header, _map, sizeof(header));
+    bool valid = (memcmp(header.magic, SURROGATE_MAGIC, 8) == 0) &&
+                 (header.version == SURROGATE_VERSION) &&
+                 (header.file_size <= _map_size) &&
+                 (header.field_count <= BM11OutputField_Count);
+    uint64_t node_count = 1;
+    for (int a = 0; valid && (a < BM11_SURROGATE_AXES); a++) {
+        valid       = (header.axis_field[a] == (uint32_t)axisField[a]) && (header.axis_count[a] >= 2);
+        node_count *= header.axis_count[a];
+    }
+    valid = valid && (node_count == header.node_count) &&
+            (header.status_offset >= HEADER_SIZE + sizeof(uint32_t) * header.field_count) &&
+            (header.status_offset + node_count <= header.value_offset) &&
+            (header.value_offset + sizeof(float) * header.field_count * node_count <= header.file_size);
+    if (!valid) {
+        close();
+        return false;
+    }
+
+    _field       = (const uint32_t *)(_map + HEADER_SIZE);
+    _status      = _map + header.status_offset;
+    _value       = (const float *)(_map + header.value_offset);
+    _field_count = (int)header.field_count;
+    for (int a = 0; a < BM11_SURROGATE_AXES; a++) {
+        _count[a] = header.axis_count[a];
+        _min[a]   = header.axis_min[a];
+        _max[a]   = header.axis_max[a];
+    }
+    for (int f = 0; f < _field_count; f++) {
+        if ((_field[f] >= BM11OutputField_Count) || !isStoredField((int)_field[f])) {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void BM11Surrogate::close(void)
+{
+    if (_map) {
+        munmap((void *)_map, _map_size);
+    }
+    _map         = NULL;
+    _map_size    = 0;
+    _field       = NULL;
+    _status      = NULL;
+    _value       = NULL;
+    _field_count = 0;
+}
+
+/* Query */
+
+static inline void catmullRomWeights(float t, float w[4])
+{
+    float t2 = t * t, t3 = t2 * t;
+    w[0] = 0.5f * (-t3 + 2.0f * t2 - t);
+    w[1] = 0.5f * (3.0f * t3 - 5.0f * t2 + 2.0f);
+    w[2] = 0.5f * (-3.0f * t3 + 4.0f * t2 + t);
+    w[3] = 0.5f * (t3 - t2);
+}
+
+BM11Model::Status BM11Surrogate::query(const BM11Model::InputParameters *input,
+                                       BM11Model::OutputParameters      *output,
+                                       BM11Model::OutputParameters      *error,
+                                       BM11SurrogateMode                 mode) const
+{
+    const int F = _field_count;
+    uint32_t  cell[BM11_SURROGATE_AXES];
+    float     t[BM11_SURROGATE_AXES];
+    bool      exact = !_map || (BM11Model::checkFeasibility(input) != BM11Model::StatusOK);
+
+    for (int a = 0; !exact && (a < BM11_SURROGATE_AXES); a++) {
+        float u = (BM11GetInputField(input, axisField[a]) - _min[a]) / (_max[a] - _min[a]) * (float)(_count[a] - 1);
+        if (!(u >= 0.0f) || !(u <= (float)(_count[a] - 1))) {
+            exact = true;
+            break;
+        }
+        cell[a] = std::min((uint32_t)u, _count[a] - 2);
+        t[a]    = u - (float)cell[a];
+    }
+
+    auto node = [&](uint32_t i0, uint32_t i1, uint32_t i2) {
+        return ((uint64_t)i0 * _count[1] + i1) * _count[2] + i2;
+    };
+
+    /* Every corner of the cell must be a valid design */
+    for (int c = 0; !exact && (c < 8); c++) {
+        exact = (_status[node(cell[0] + (c >> 2), cell[1] + ((c >> 1) & 1), cell[2] + (c & 1))] != BM11Model::StatusOK);
+    }
+    if (exact) {
+        BM11Model model;
+        model.setInputParameters(*input);
+        *output = model.getOutputParameters();
+        if (error) {
+            memset(error, 0, sizeof(*error));
+        }
+        return model.getStatus();
+    }
+
+    /* Trilinear */
+    float linear[BM11OutputField_Count] = { 0.0f };
+    for (int c = 0; c < 8; c++) {
+        float w = ((c & 4) ? t[0] : 1.0f - t[0]) * ((c & 2) ? t[1] : 1.0f - t[1]) * ((c & 1) ? t[2] : 1.0f - t[2]);
+        const float *v = &_value[node(cell[0] + (c >> 2), cell[1] + ((c >> 1) & 1), cell[2] + (c & 1)) * F];
+        for (int f = 0; f < F; f++) {
+            linear[f] += w * v[f];
+        }
+    }
+
+    /* Catmull-Rom stencil, clamped at the table edges */
+    uint32_t stencil[BM11_SURROGATE_AXES][4];
+    bool     cubic = (mode == BM11SurrogateCubic);
+    for (int a = 0; a < BM11_SURROGATE_AXES; a++) {
+        for (int s = 0; s < 4; s++) {
+            int64_t i = (int64_t)cell[a] + s - 1;
+            stencil[a][s] = (uint32_t)std::min(std::max(i, (int64_t)0), (int64_t)_count[a] - 1);
+        }
+    }
+    for (int s = 0; cubic && (s < 64); s++) {
+        cubic = (_status[node(stencil[0][s >> 4], stencil[1][(s >> 2) & 3], stencil[2][s & 3])] == BM11Model::StatusOK);
+    }
+
+    float value[BM11OutputField_Count];
+    float correction[BM11OutputField_Count] = { 0.0f }; /* Estimated exact value minus value */
+    if (cubic) {
+        float w[BM11_SURROGATE_AXES][4];
+        for (int a = 0; a < BM11_SURROGATE_AXES; a++) {
+            catmullRomWeights(t[a], w[a]);
+        }
+        std::fill(value, value + F, 0.0f);
+        for (int s = 0; s < 64; s++) {
+            float        ws = w[0][s >> 4] * w[1][(s >> 2) & 3] * w[2][s & 3];
+            const float *v  = &_value[node(stencil[0][s >> 4], stencil[1][(s >> 2) & 3], stencil[2][s & 3]) * F];
+            for (int f = 0; f < F; f++) {
+                value[f] += ws * v[f];
+            }
+        }
+        for (int f = 0; f < F; f++) {
+            correction[f] = value[f] - linear[f];
+        }
+    } else {
+        std::copy(linear, linear + F, value);
+        /* Second differences along each axis at both ends of the cell, at
+           the nearest node on the other axes */
+        for (int a = 0; (a < BM11_SURROGATE_AXES) && error; a++) {
+            if (_count[a] < 3) {
+                continue;
+            }
+            uint32_t near[BM11_SURROGATE_AXES];
+            for (int b = 0; b < BM11_SURROGATE_AXES; b++) {
+                near[b] = cell[b] + ((t[b] >= 0.5f) ? 1 : 0);
+            }
+            float curvature[2][BM11OutputField_Count] = { { 0.0f } };
+            for (uint32_t end = 0; end < 2; end++) {
+                uint32_t center = std::min(std::max(cell[a] + end, 1u), _count[a] - 2);
+                uint64_t at[3];
+                bool     valid = true;
+                for (int k = 0; k < 3; k++) {
+                    near[a] = center + k - 1;
+                    at[k]   = node(near[0], near[1], near[2]);
+                    valid  &= (_status[at[k]] == BM11Model::StatusOK);
+                }
+                if (!valid) {
+                    continue;
+                }
+                const float *v0 = &_value[at[0] * F];
+                const float *v1 = &_value[at[1] * F];
+                const float *v2 = &_value[at[2] * F];
+                for (int f = 0; f < F; f++) {
+                    curvature[end][f] = v0[f] - 2.0f * v1[f] + v2[f];
+                }
+            }
+            /* Linear interpolation overshoots by t(1 - t)/2 h^2 f'' */
+            float scale = 0.5f * t[a] * (1.0f - t[a]);
+            for (int f = 0; f < F; f++) {
+                correction[f] -= scale * ((1.0f - t[a]) * curvature[0][f] + t[a] * curvature[1][f]);
+            }
+        }
+    }
+
+    memset(output, 0, sizeof(*output));
+    for (int f = 0; f < F; f++) {
+        BM11SetOutputField(output, (int)_field[f], value[f]);
+    }
+    BM11Model::evaluateDerivedStages(derivedStages, input, output);
+
+    if (error) {
+        /* Derived fields: how far the correction moves them */
+        BM11Model::OutputParameters corrected;
+        memset(error, 0, sizeof(*error));
+        memset(&corrected, 0, sizeof(corrected));
+        for (int f = 0; f < F; f++) {
+            BM11SetOutputField(error,       (int)_field[f], fabsf(correction[f]));
+            BM11SetOutputField(&corrected,  (int)_field[f], value[f] + correction[f]);
+        }
+        BM11Model::evaluateDerivedStages(derivedStages, input, &corrected);
+        for (int o = 0; o < BM11OutputField_Count; o++) {
+            if (!isStoredField(o)) {
+                BM11SetOutputField(error, o, fabsf(BM11GetOutputField(&corrected, o) - BM11GetOutputField(output, o)));
+            }
+        }
+    }
+    return BM11Model::StatusOK;
+}
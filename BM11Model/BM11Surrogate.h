@@ -0,0 +1,114 @@
+#ifndef BM11_SURROGATE_H
+#define BM11_SURROGATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "BM11Fields.h"
+
+/*
+   Precomputed geometry table for interactive queries.
+
+   The geometry stages (edges, vertex angles, vertex coordinates, dihedral
+   angles and projected wind areas) only read squareSideLength,
+   baseCutBackLength and angle_ABC. BM11SurrogateBuild() evaluates them in
+   parallel on an evenly spaced grid over those three inputs and writes the
+   results to a file that BM11Surrogate maps read-only, so opening it costs
+   one mmap() however large it is.
+
+   query() interpolates the stored fields between grid nodes, either
+   trilinearly or with Catmull-Rom splines (tricubic), then runs the
+   overall structure, frame, mirror and totals stages on the result with the
+   query's own inputs (BM11Model::evaluateDerivedStages()). Shoulder height,
+   cross sections and every unit cost can therefore change freely without
+   rebuilding the table.
+
+   The error estimate is per output field. For trilinear interpolation it is
+   t(1 - t)/2 times the grid's second difference along each axis (at most
+   h^2/8 |f''|), summed over the axes with signs; for tricubic it is the
+   difference between the tricubic and trilinear values, which mostly
+   overstates the tricubic error. Derived fields get the change caused by
+   applying those signed corrections to the stored fields.
+
+   Queries outside the table, failing BM11Model::checkFeasibility(), or in
+   a cell that touches a rejected grid node are evaluated exactly with
+   BM11Model instead, with a zero error. Tricubic queries whose 4x4x4
+   stencil touches a rejected node fall back to trilinear.
+
+   File layout, native byte order, all offsets multiples of 64:
+
+      Header, 128 bytes
+         char     magic[8]        "BM11SUR1"
+         uint32_t version         1
+         uint32_t field_count     stored output fields
+         uint32_t axis_field[3]   BM11InputField of each axis
+         uint32_t axis_count[3]   grid nodes along each axis (>= 2)
+         float    axis_min[3]
+         float    axis_max[3]
+         uint64_t node_count      product of the axis counts
+         uint64_t status_offset
+         uint64_t value_offset
+         uint64_t file_size
+         (zero padding)
+      uint32_t field[field_count]             BM11OutputField of each stored field
+      uint8_t  status[node_count]             BM11Model::Status of each node
+      float    value[node_count][field_count] node index (i0 * count1 + i1) * count2 + i2
+ */
+
+#define BM11_SURROGATE_AXES 3
+
+typedef struct {
+    BM11Model::InputParameters base;                      /* Inputs that aren't axes; don't affect the table */
+    uint32_t                   count[BM11_SURROGATE_AXES]; /* squareSideLength, baseCutBackLength, angle_ABC */
+    float                      min[BM11_SURROGATE_AXES];
+    float                      max[BM11_SURROGATE_AXES];
+    int                        thread_count;              /* 0 = all hardware threads */
+} BM11SurrogateConfig;
+
+typedef enum {
+    BM11SurrogateLinear,
+    BM11SurrogateCubic
+} BM11SurrogateMode;
+
+/* Squares of 8 to 24 ft, cut backs of 0 to 6 ft and angles of 90 to 150
+   degrees, on a 33 x 25 x 31 grid (4 MB) */
+void BM11SurrogateConfigInit(BM11SurrogateConfig *config);
+
+/* Returns false on an invalid grid or an I/O error */
+bool BM11SurrogateBuild(const BM11SurrogateConfig *config, const char *path);
+
+class BM11Surrogate {
+public:
+    BM11Surrogate(void);
+    ~BM11Surrogate(void);
+
+    /* Maps a table; returns false if it is missing or malformed */
+    bool              open(const char *path);
+    void              close(void);
+
+    /* Fills every output field. `error` may be NULL. Thread-safe. */
+    BM11Model::Status query(const BM11Model::InputParameters *input,
+                            BM11Model::OutputParameters      *output,
+                            BM11Model::OutputParameters      *error,
+                            BM11SurrogateMode                 mode = BM11SurrogateCubic) const;
+
+    uint32_t          getAxisCount(int axis) const { return _count[axis]; };
+    float             getAxisMin(int axis) const   { return _min[axis]; };
+    float             getAxisMax(int axis) const   { return _max[axis]; };
+    int               getFieldCount(void) const    { return _field_count; };
+
+private:
+    BM11Surrogate(const BM11Surrogate &);
+    BM11Surrogate &operator=(const BM11Surrogate &);
+
+    const uint8_t  *_map;
+    size_t          _map_size;
+    const uint32_t *_field;
+    const uint8_t  *_status;
+    const float    *_value;
+    int             _field_count;
+    uint32_t        _count[BM11_SURROGATE_AXES];
+    float           _min[BM11_SURROGATE_AXES];
+    float           _max[BM11_SURROGATE_AXES];
+};
+
+#endif /* BM11_SURROGATE_H */
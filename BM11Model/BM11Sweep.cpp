@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include "BM11Parallel.h"
+#include "BM11Profile.h"
+#include "BM11Sweep.h"
+
+typedef std::chrono::steady_clock Clock;
+
+typedef struct {
+    const BM11SweepConfig *config;
+    BM11Model             *models;
+    uint64_t               total;
+    int                    thread_count;
+    Clock::time_point      start;
+    std::atomic<uint64_t>  done;
+    std::atomic<int64_t>   next_report_ns;
+    std::atomic<uint64_t>  status_count[BM11Model::StatusCount];
+} SweepJob;
+
+static float axisValue(const BM11SweepAxis *axis, uint32_t i)
+{
+    if (axis->values) {
+        return axis->values[i];
+    }
+    if (axis->count <= 1) {
+        return axis->start;
+    }
+    return (float)(axis->start + (((double)axis->stop - axis->start) * i) / (axis->count - 1));
+}
+
+void BM11SweepConfigInit(BM11SweepConfig *config)
+{
+    memset(config, 0, sizeof(*config));
+    config->base          = BM11Model::getDefaultInputParameters();
+    config->mode          = BM11SweepGrid;
+    config->print_profile = true;
+}
+
+bool BM11SweepAddAxis(BM11SweepConfig *config, int field, float start, float stop, uint32_t count)
+{
+    if (config->axis_count >= BM11_SWEEP_MAX_AXES) {
+        return false;
+    }
+    BM11SweepAxis *axis = &config->axes[config->axis_count++];
+    axis->field  = field;
+    axis->start  = start;
+    axis->stop   = stop;
+    axis->count  = count;
+    axis->values = NULL;
+    return true;
+}
+
+uint64_t BM11SweepDesignCount(const BM11SweepConfig *config)
+{
+    if (config->axis_count == 0) {
+        return 1;
+    }
+    uint64_t count = config->axes[0].count;
+    if (config->mode == BM11SweepZip) {
+        /* Axes step together, so the shortest one ends the sweep */
+        for (int a = 1; a < config->axis_count; a++) {
+            if (config->axes[a].count < count) {
+                count = config->axes[a].count;
+            }
+        }
+        return count;
+    }
+    count = 1;
+    for (int a = 0; a < config->axis_count; a++) {
+        count *= config->axes[a].count;
+    }
+    return count;
+}
+
+void BM11SweepGetDesign(const BM11SweepConfig *config, uint64_t index, BM11Model::InputParameters *input)
+{
+    *input = config->base;
+
+    if (config->mode == BM11SweepZip) {
+        for (int a = 0; a < config->axis_count; a++) {
+            BM11SetInputField(input, config->axes[a].field, axisValue(&config->axes[a], (uint32_t)index));
+        }
+        return;
+    }
+    /* Last axis varies fastest */
+    for (int a = config->axis_count - 1; a >= 0; a--) {
+        const BM11SweepAxis *axis = &config->axes[a];
+        BM11SetInputField(input, axis->field, axisValue(axis, (uint32_t)(index % axis->count)));
+        index /= axis->count;
+    }
+}
+
+static void printProgress(void *context, const BM11SweepStats *stats)
+{
+    (void)context;
+    fprintf(stderr, "sweep: %5.1f%% (%llu/%llu), %.3f M designs/s on %d threads\n",
+            (100.0 * stats->designs_done) / stats->designs_total,
+            (unsigned long long)stats->designs_done, (unsigned long long)stats->designs_total,
+            stats->designs_per_second * 1e-6, stats->thread_count);
+}
+
+static BM11SweepStats currentStats(SweepJob *job)
+{
+    BM11SweepStats stats;
+    stats.designs_done       = job->done.load();
+    stats.designs_total      = job->total;
+    stats.seconds            = std::chrono::duration<double>(Clock::now() - job->start).count();
+    stats.designs_per_second = (stats.seconds > 0.0) ? (stats.designs_done / stats.seconds) : 0.0;
+    stats.thread_count       = job->thread_count;
+    for (int s = 0; s < BM11Model::StatusCount; s++) {
+        stats.status_count[s] = job->status_count[s].load();
+    }
+    return stats;
+}
+
+static void sweepRange(void *context, uint64_t begin, uint64_t end, int thread_index)
+{
+    SweepJob                  *job    = (SweepJob *)context;
+    const BM11SweepConfig     *config = job->config;
+    BM11Model                 *model  = &job->models[thread_index];
+    BM11Model::InputParameters input;
+    uint64_t                   status_count[BM11Model::StatusCount] = { 0 };
+
+    for (uint64_t i = begin; i < end; i++) {
+        BM11SweepGetDesign(config, i, &input);
+        model->setInputParameters(input);
+        BM11Model::OutputParameters output = model->getOutputParameters();
+        BM11Model::Status           status = model->getStatus();
+        status_count[status]++;
+        if (config->result && ((status == BM11Model::StatusOK) || !config->skip_invalid)) {
+            config->result(config->result_context, i, &input, &output, status, thread_index);
+        }
+    }
+    for (int s = 0; s < BM11Model::StatusCount; s++) {
+        if (status_count[s]) {
+            job->status_count[s].fetch_add(status_count[s]);
+        }
+    }
+    job->done.fetch_add(end - begin);
+
+    if (config->progress_interval > 0.0) {
+        int64_t now  = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - job->start).count();
+        int64_t next = job->next_report_ns.load();
+        if ((now >= next) &&
+            job->next_report_ns.compare_exchange_strong(next, now + (int64_t)(config->progress_interval * 1e9))) {
+            BM11SweepStats stats = currentStats(job);
+            if (config->progress) {
+                config->progress(config->progress_context, &stats);
+            } else {
+                printProgress(NULL, &stats);
+            }
+        }
+    }
+}
+
+BM11SweepStats BM11RunSweep(const BM11SweepConfig *config)
+{
+    SweepJob job;
+    job.config         = config;
+    job.total          = BM11SweepDesignCount(config);
+    job.thread_count   = (config->thread_count > 0) ? config->thread_count : BM11ParallelThreadCount();
+    if ((uint64_t)job.thread_count > job.total) {
+        job.thread_count = (job.total > 0) ? (int)job.total : 1;
+    }
+    job.start          = Clock::now();
+    job.done           = 0;
+    job.next_report_ns = (int64_t)(config->progress_interval * 1e9);
+    for (int s = 0; s < BM11Model::StatusCount; s++) {
+        job.status_count[s] = 0;
+    }
+
+    std::vector<BM11Model> models(job.thread_count);
+    job.models = models.data();
+    for (size_t t = 0; t < models.size(); t++) {
+        models[t].setResultCache(config->cache);
+    }
+
+    BM11ProfileStats before;
+    BM11ProfileGetStats(&before);
+
+    BM11ParallelFor(job.total, config->grain, job.thread_count, sweepRange, &job);
+
+    if (config->print_profile && BM11ProfileEnabled()) {
+        BM11ProfileStats after, stats;
+        BM11ProfileGetStats(&after);
+        BM11ProfileSubtract(&after, &before, &stats);
+        BM11ProfilePrint(stderr, &stats);
+    }
+
+    return currentStats(&job);
+}
@@ -0,0 +1,89 @@
+#ifndef BM11_SWEEP_H
+#define BM11_SWEEP_H
+
+#include <stdint.h>
+#include "BM11Fields.h"
+#include "BM11ResultCache.h"
+
+/*
+   N-dimensional parameter sweeps over any InputParameters fields.
+
+   BM11SweepGrid visits the Cartesian product of all axes, with the last
+   axis varying fastest. BM11SweepZip steps every axis together and stops at
+   the end of the shortest one, which covers "a list of ranges".
+
+   Designs are split across threads with BM11ParallelFor(). Every thread
+   owns its own BM11Model, since getOutputParameters() caches through
+   non-atomic dirty-stage state. The result callback therefore runs concurrently
+   on several threads, in no particular order; `thread_index` can be used to
+   index per-thread accumulators without locking. Setting `cache` lets the
+   workers reuse each other's results.
+ */
+
+#define BM11_SWEEP_MAX_AXES 16
+
+typedef struct {
+    int          field;  /* BM11InputField to vary                                  */
+    float        start;  /* First value                                             */
+    float        stop;   /* Last value (inclusive)                                  */
+    uint32_t     count;  /* Number of points, start..stop evenly spaced; 1 = start  */
+    const float *values; /* Optional explicit list of `count` values, overrides start/stop */
+} BM11SweepAxis;
+
+typedef enum {
+    BM11SweepGrid,
+    BM11SweepZip
+} BM11SweepMode;
+
+typedef struct {
+    uint64_t designs_done;
+    uint64_t designs_total;
+    double   seconds;
+    double   designs_per_second;
+    int      thread_count;
+    uint64_t status_count[BM11Model::StatusCount]; /* Designs per BM11Model::Status */
+} BM11SweepStats;
+
+typedef void (*BM11SweepResultFunc)(void *context, uint64_t index,
+                                    const BM11Model::InputParameters  *input,
+                                    const BM11Model::OutputParameters *output,
+                                    BM11Model::Status status, int thread_index);
+typedef void (*BM11SweepProgressFunc)(void *context, const BM11SweepStats *stats);
+
+typedef struct {
+    BM11Model::InputParameters base;        /* Values for every field not on an axis   */
+    BM11SweepAxis              axes[BM11_SWEEP_MAX_AXES];
+    int                        axis_count;
+    BM11SweepMode              mode;
+
+    int                        thread_count; /* 0 = all hardware threads                */
+    uint64_t                   grain;        /* Designs per work item, 0 = automatic    */
+    BM11ResultCache           *cache;        /* Shared by every worker's model, may be NULL */
+
+    BM11SweepResultFunc        result;       /* Called once per design, may be NULL     */
+    void                      *result_context;
+    bool                       skip_invalid; /* Don't call `result` for rejected designs */
+
+    double                     progress_interval; /* Seconds between reports, 0 = never */
+    BM11SweepProgressFunc      progress;          /* NULL prints a line to stderr       */
+    void                      *progress_context;
+
+    bool                       print_profile;     /* Stage profile to stderr at the end,
+                                                     only in BM11_PROFILE builds       */
+} BM11SweepConfig;
+
+/* Config with default inputs, no axes, all threads, no progress reports and
+   the profile summary on */
+void           BM11SweepConfigInit(BM11SweepConfig *config);
+
+/* Append an axis, returns false when BM11_SWEEP_MAX_AXES is reached */
+bool           BM11SweepAddAxis(BM11SweepConfig *config, int field, float start, float stop, uint32_t count);
+
+uint64_t       BM11SweepDesignCount(const BM11SweepConfig *config);
+
+/* Inputs of design `index` */
+void           BM11SweepGetDesign(const BM11SweepConfig *config, uint64_t index, BM11Model::InputParameters *input);
+
+BM11SweepStats BM11RunSweep(const BM11SweepConfig *config);
+
+#endif /* BM11_SWEEP_H */
@@ -0,0 +1,658 @@
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include "BM11Parallel.h"
+#include "BM11Truss.h"
+#include "BM11Wind.h"
+
+#define ELASTIC_MODULUS 29.0e6 /* psi */
+#define SHEAR_MODULUS   11.2e6 /* psi */
+#define FT              12.0   /* in  */
+
+void BM11FrameConfigInit(BM11FrameConfig *config)
+{
+    config->subdivisions = 3;
+    config->crossbar     = true;
+}
+
+void BM11TrussConfigInit(BM11TrussConfig *config)
+{
+    memset(config, 0, sizeof(*config));
+    BM11FrameConfigInit(&config->frame);
+    config->wind_heading     = 0.0f;
+    config->wind_speed_mph   = 100.0f;
+    config->drag_coefficient = 1.0f;
+    config->gravity          = true;
+    config->panel_weight     = 0.0f;
+}
+
+/* Layout */
+
+static void addMember(BM11FrameLayout *layout, int a, int b, int panel, BM11FrameMemberKind kind, BMVector3 normal)
+{
+    BM11FrameMember *member = &layout->member[layout->member_count++];
+    member->node[0] = a;
+    member->node[1] = b;
+    member->panel   = panel;
+    member->kind    = kind;
+    member->normal  = normal;
+}
+
+void BM11FrameLayoutBuild(const BM11FrameConfig *config, const BM11Model::OutputParameters *output, BM11FrameLayout *layout)
+{
+    /* O, A0, B0, C0, A1, B1, C1 */
+    const int subdivisions = std::min(std::max(config->subdivisions, 0), BM11_FRAME_MAX_SUBDIVISIONS);
+    const int corner[BM11_FRAME_PANELS][4] = {
+        /* O, A, B and the opposite vertex */
+        { 0, 1, 2, 3 },
+        { 0, 3, 2, 1 },
+        { 0, 4, 5, 6 },
+        { 0, 6, 5, 4 },
+    };
+
+    layout->node_count = 7;
+    layout->node[0]    = output->vertex_coord.O;
+    layout->node[1]    = output->vertex_coord.A0;
+    layout->node[2]    = output->vertex_coord.B0;
+    layout->node[3]    = output->vertex_coord.C0;
+    layout->node[4]    = output->vertex_coord.A1;
+    layout->node[5]    = output->vertex_coord.B1;
+    layout->node[6]    = output->vertex_coord.C1;
+    for (int n = 0; n < 7; n++) {
+        layout->ground[n] = (n != 0);
+    }
+
+    layout->member_count = 0;
+    for (int p = 0; p < BM11_FRAME_PANELS; p++) {
+        int       O = corner[p][0], A = corner[p][1], B = corner[p][2];
+        BMVector3 OA = BMVector3Subtract(layout->node[A], layout->node[O]);
+        BMVector3 OB = BMVector3Subtract(layout->node[B], layout->node[O]);
+        BMVector3 normal = BMVector3Normalize(BMVector3CrossProduct(OA, OB));
+        if (BMVector3DotProduct(normal, BMVector3Subtract(layout->node[corner[p][3]], layout->node[O])) > 0.0f) {
+            normal = BMVector3Negate(normal);
+        }
+        layout->panel_node[p][0] = O;
+        layout->panel_node[p][1] = A;
+        layout->panel_node[p][2] = B;
+        layout->panel_normal[p]  = normal;
+
+        /* OA in subdivisions + 1 segments, each inner point braced to B */
+        int previous = O;
+        for (int i = 1; i <= subdivisions; i++) {
+            int point = layout->node_count++;
+            layout->node[point]   = BMVector3Add(layout->node[O], BMVector3MultiplyScalar(OA, (float)i / (subdivisions + 1)));
+            layout->ground[point] = false;
+            addMember(layout, previous, point, p, BM11FrameMemberPerimeter, normal);
+            addMember(layout, point, B, p, BM11FrameMemberReinforce, normal);
+            previous = point;
+        }
+        addMember(layout, previous, A, p, BM11FrameMemberPerimeter, normal);
+        addMember(layout, A, B, p, BM11FrameMemberPerimeter, normal);
+        addMember(layout, O, B, p, BM11FrameMemberPerimeter, normal);
+    }
+    if (config->crossbar) {
+        addMember(layout, 2, 5, -1, BM11FrameMemberCrossbar, BMVector3Make(0.0f, 1.0f, 0.0f));
+    }
+}
+
+/* Elements */
+
+typedef struct {
+    double A;  /* in^2 */
+    double Iy; /* in^4, bending out of the panel */
+    double Iz; /* in^4, bending in the panel plane */
+    double J;  /* in^4 */
+    double Sy; /* in^3 */
+    double Sz; /* in^3 */
+} Section;
+
+static Section boxSection(const BM11Model::InputParameters *input)
+{
+    Section s;
+    double  h  = input->frameCrossSection.x; /* Along the panel normal, local z */
+    double  b  = input->frameCrossSection.y; /* In the panel plane, local y     */
+    double  t  = input->frameWallThickness;
+    double  hi = h - 2.0 * t, bi = b - 2.0 * t;
+    double  hm = h - t,       bm = b - t;     /* Mid-wall line */
+
+    s.A  = (b * h) - (bi * hi);
+    s.Iy = ((b * h * h * h) - (bi * hi * hi * hi)) / 12.0;
+    s.Iz = ((h * b * b * b) - (hi * bi * bi * bi)) / 12.0;
+    s.J  = (4.0 * (bm * hm) * (bm * hm) * t) / (2.0 * (bm + hm));
+    s.Sy = s.Iy / (0.5 * h);
+    s.Sz = s.Iz / (0.5 * b);
+    return s;
+}
+
+/* Local stiffness (x along the member, z along its section normal) and the
+   rotation whose rows are the local axes */
+void BM11TrussSolver::elementStiffness(int member, const BM11Model::InputParameters *input,
+                                       double K[12][12], double R[3][3], double *length) const
+{
+    const BM11FrameMember *m = &_layout.member[member];
+    const BMVector3        a = _layout.node[m->node[0]];
+    const BMVector3        b = _layout.node[m->node[1]];
+    double                 d[3] = { (b.x - a.x) * FT, (b.y - a.y) * FT, (b.z - a.z) * FT };
+    double                 L = sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+    double                 n[3] = { m->normal.x, m->normal.y, m->normal.z };
+
+    for (int i = 0; i < 3; i++) {
+        R[0][i] = d[i] / L;
+    }
+    double dot = n[0] * R[0][0] + n[1] * R[0][1] + n[2] * R[0][2];
+    for (int i = 0; i < 3; i++) {
+        R[2][i] = n[i] - dot * R[0][i];
+    }
+    double nz = sqrt(R[2][0] * R[2][0] + R[2][1] * R[2][1] + R[2][2] * R[2][2]);
+    for (int i = 0; i < 3; i++) {
+        R[2][i] /= nz;
+    }
+    /* y = z x x */
+    R[1][0] = R[2][1] * R[0][2] - R[2][2] * R[0][1];
+    R[1][1] = R[2][2] * R[0][0] - R[2][0] * R[0][2];
+    R[1][2] = R[2][0] * R[0][1] - R[2][1] * R[0][0];
+
+    Section s  = boxSection(input);
+    double  E  = ELASTIC_MODULUS, G = SHEAR_MODULUS;
+    double  L2 = L * L, L3 = L2 * L;
+    memset(K, 0, sizeof(double) * 144);
+
+    double ea = E * s.A / L, gj = G * s.J / L;
+    K[0][0] = K[6][6] = ea;  K[0][6] = K[6][0] = -ea;
+    K[3][3] = K[9][9] = gj;  K[3][9] = K[9][3] = -gj;
+
+    /* Bending in the xy plane: v (1, 7) and theta z (5, 11) */
+    double bz = E * s.Iz / L3;
+    const int vz[4] = { 1, 5, 7, 11 };
+    const double kz[4][4] = {
+        {  12.0,      6.0 * L, -12.0,      6.0 * L },
+        {  6.0 * L,   4.0 * L2, -6.0 * L,  2.0 * L2 },
+        { -12.0,     -6.0 * L,  12.0,     -6.0 * L },
+        {  6.0 * L,   2.0 * L2, -6.0 * L,  4.0 * L2 },
+    };
+    /* Bending in the xz plane: w (2, 8) and theta y (4, 10) */
+    double by = E * s.Iy / L3;
+    const int vy[4] = { 2, 4, 8, 10 };
+    const double ky[4][4] = {
+        {  12.0,     -6.0 * L, -12.0,     -6.0 * L },
+        { -6.0 * L,   4.0 * L2,  6.0 * L,  2.0 * L2 },
+        { -12.0,      6.0 * L,  12.0,      6.0 * L },
+        { -6.0 * L,   2.0 * L2,  6.0 * L,  4.0 * L2 },
+    };
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            K[vz[i]][vz[j]] = bz * kz[i][j];
+            K[vy[i]][vy[j]] = by * ky[i][j];
+        }
+    }
+    *length = L;
+}
+
+/* R^T B R for the 3 x 3 block at (row, column) of Kl */
+static void rotateBlock(const double Kl[12][12], int row, int column, const double R[3][3], double out[3][3])
+{
+    double tmp[3][3];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            tmp[i][j] = Kl[row + i][column + 0] * R[0][j] + Kl[row + i][column + 1] * R[1][j] + Kl[row + i][column + 2] * R[2][j];
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            out[i][j] = R[0][i] * tmp[0][j] + R[1][i] * tmp[1][j] + R[2][i] * tmp[2][j];
+        }
+    }
+}
+
+/* Kg = T^T Kl T with T four copies of R on the diagonal. The 16 blocks of a
+   frame element are all +-B00, +-B01, +-B01^T, B11 or B13, so only those
+   four are rotated. */
+static void toGlobal(const double Kl[12][12], const double R[3][3], double Kg[12][12])
+{
+    double B[4][3][3];
+    rotateBlock(Kl, 0, 0, R, B[0]); /* Translation, translation */
+    rotateBlock(Kl, 0, 3, R, B[1]); /* Translation, rotation    */
+    rotateBlock(Kl, 3, 3, R, B[2]); /* Rotation, same end       */
+    rotateBlock(Kl, 3, 9, R, B[3]); /* Rotation, other end      */
+
+    /* Block, transposed, sign for each of the 4 x 4 blocks */
+    static const int layout[4][4][3] = {
+        { { 0, 0,  1 }, { 1, 0,  1 }, { 0, 0, -1 }, { 1, 0,  1 } },
+        { { 1, 1,  1 }, { 2, 0,  1 }, { 1, 1, -1 }, { 3, 0,  1 } },
+        { { 0, 0, -1 }, { 1, 0, -1 }, { 0, 0,  1 }, { 1, 0, -1 } },
+        { { 1, 1,  1 }, { 3, 0,  1 }, { 1, 1, -1 }, { 2, 0,  1 } },
+    };
+    for (int I = 0; I < 4; I++) {
+        for (int J = 0; J < 4; J++) {
+            const double (*b)[3] = B[layout[I][J][0]];
+            double       sign    = layout[I][J][2];
+            for (int i = 0; i < 3; i++) {
+                for (int j = 0; j < 3; j++) {
+                    Kg[I * 3 + i][J * 3 + j] = sign * (layout[I][J][1] ? b[j][i] : b[i][j]);
+                }
+            }
+        }
+    }
+}
+
+/* Symbolic analysis */
+
+BM11TrussSolver::BM11TrussSolver(const BM11TrussConfig *config)
+{
+    _config = *config;
+
+    /* Any design will do: the topology only depends on the frame config */
+    BM11Model                   model;
+    BM11Model::OutputParameters output = model.getOutputParameters();
+    BM11FrameLayoutBuild(&_config.frame, &output, &_layout);
+    symbolic();
+}
+
+void BM11TrussSolver::symbolic(void)
+{
+    const int nodes = _layout.node_count;
+
+    /* Minimum degree order on the node graph */
+    std::vector<std::vector<char>> adjacent(nodes, std::vector<char>(nodes, 0));
+    for (int m = 0; m < _layout.member_count; m++) {
+        adjacent[_layout.member[m].node[0]][_layout.member[m].node[1]] = 1;
+        adjacent[_layout.member[m].node[1]][_layout.member[m].node[0]] = 1;
+    }
+    std::vector<char> eliminated(nodes, 0);
+    std::vector<int>  order;
+    for (int step = 0; step < nodes; step++) {
+        int best = -1, best_degree = nodes + 1;
+        for (int v = 0; v < nodes; v++) {
+            if (eliminated[v]) {
+                continue;
+            }
+            int degree = 0;
+            for (int u = 0; u < nodes; u++) {
+                degree += (!eliminated[u] && adjacent[v][u]);
+            }
+            if (degree < best_degree) {
+                best        = v;
+                best_degree = degree;
+            }
+        }
+        /* Eliminating a node joins its neighbours into a clique */
+        for (int u = 0; u < nodes; u++) {
+            for (int w = 0; w < nodes; w++) {
+                if ((u != w) && !eliminated[u] && !eliminated[w] && adjacent[best][u] && adjacent[best][w]) {
+                    adjacent[u][w] = 1;
+                }
+            }
+        }
+        eliminated[best] = 1;
+        order.push_back(best);
+    }
+
+    _dof.assign(nodes * 6, -1);
+    _n = 0;
+    for (int i = 0; i < nodes; i++) {
+        int v = order[i];
+        for (int k = 0; k < 6; k++) {
+            if (!(_layout.ground[v] && (k < 3))) {
+                _dof[v * 6 + k] = _n++;
+            }
+        }
+    }
+
+    /* Upper triangle pattern */
+    std::vector<std::vector<int>> column(_n);
+    for (int j = 0; j < _n; j++) {
+        column[j].push_back(j);
+    }
+    for (int m = 0; m < _layout.member_count; m++) {
+        for (int i = 0; i < 12; i++) {
+            for (int j = 0; j < 12; j++) {
+                int r = _dof[_layout.member[m].node[i / 6] * 6 + (i % 6)];
+                int c = _dof[_layout.member[m].node[j / 6] * 6 + (j % 6)];
+                if ((r >= 0) && (c >= 0) && (r < c)) {
+                    column[c].push_back(r);
+                }
+            }
+        }
+    }
+    _Ap.assign(_n + 1, 0);
+    _Ai.clear();
+    for (int j = 0; j < _n; j++) {
+        std::sort(column[j].begin(), column[j].end());
+        column[j].erase(std::unique(column[j].begin(), column[j].end()), column[j].end());
+        _Ai.insert(_Ai.end(), column[j].begin(), column[j].end());
+        _Ap[j + 1] = (int)_Ai.size();
+    }
+    _Ax.assign(_Ai.size(), 0.0);
+
+    _slot.assign((size_t)_layout.member_count * 144, -1);
+    for (int m = 0; m < _layout.member_count; m++) {
+        for (int i = 0; i < 12; i++) {
+            for (int j = 0; j < 12; j++) {
+                int r = _dof[_layout.member[m].node[i / 6] * 6 + (i % 6)];
+                int c = _dof[_layout.member[m].node[j / 6] * 6 + (j % 6)];
+                if ((r >= 0) && (c >= 0) && (r <= c)) {
+                    _slot[m * 144 + i * 12 + j] =
+                        (int)(std::lower_bound(_Ai.begin() + _Ap[c], _Ai.begin() + _Ap[c + 1], r) - _Ai.begin());
+                }
+            }
+        }
+    }
+
+    /* Elimination tree */
+    std::vector<int> ancestor(_n, -1);
+    _parent.assign(_n, -1);
+    for (int k = 0; k < _n; k++) {
+        for (int p = _Ap[k]; p < _Ap[k + 1]; p++) {
+            int next;
+            for (int i = _Ai[p]; (i != -1) && (i < k); i = next) {
+                next        = ancestor[i];
+                ancestor[i] = k;
+                if (next == -1) {
+                    _parent[i] = k;
+                }
+            }
+        }
+    }
+
+    /* Row patterns of L by walking up the tree from each entry of A(:, k),
+       kept in topological order for the numeric factorization */
+    std::vector<int> mark(_n, -1), stack(_n), count(_n, 1);
+    _reach_p.assign(_n + 1, 0);
+    _reach.clear();
+    for (int k = 0; k < _n; k++) {
+        int top = _n;
+        mark[k] = k;
+        for (int p = _Ap[k]; p < _Ap[k + 1]; p++) {
+            int len = 0;
+            for (int i = _Ai[p]; mark[i] != k; i = _parent[i]) {
+                stack[len++] = i;
+                mark[i]      = k;
+            }
+            while (len > 0) {
+                stack[--top] = stack[--len];
+            }
+        }
+        for (int p = top; p < _n; p++) {
+            _reach.push_back(stack[p]);
+            count[stack[p]]++;
+        }
+        _reach_p[k + 1] = (int)_reach.size();
+    }
+
+    _Lp.assign(_n + 1, 0);
+    for (int j = 0; j < _n; j++) {
+        _Lp[j + 1] = _Lp[j] + count[j];
+    }
+    _Li.assign(_Lp[_n], 0);
+    _Lx.assign(_Lp[_n], 0.0);
+    _x.assign(_n, 0.0);
+    _u.assign(nodes * 6, 0.0);
+    _load.assign(nodes * 6, 0.0);
+    _reaction.assign(nodes * 3, 0.0);
+    _element.resize(_layout.member_count);
+    _force.assign(_layout.member_count, BM11TrussMemberForce());
+}
+
+/* Numeric */
+
+bool BM11TrussSolver::solve(const BM11Model::InputParameters  *input,
+                            const BM11Model::OutputParameters *output,
+                            BM11TrussSummary                  *summary)
+{
+    const int nodes = _layout.node_count;
+
+    memset(summary, 0, sizeof(*summary));
+    summary->max_displacement_node = -1;
+    summary->max_stress_member     = -1;
+    if (!(output->vertex_coord.O.y > 0.0f)) {
+        return false;
+    }
+    BM11FrameLayoutBuild(&_config.frame, output, &_layout);
+
+    /* Assemble */
+    const Section section = boxSection(input);
+    std::fill(_Ax.begin(), _Ax.end(), 0.0);
+    std::fill(_load.begin(), _load.end(), 0.0);
+    for (int m = 0; m < _layout.member_count; m++) {
+        Element *element = &_element[m];
+        double   Kg[12][12], L;
+        elementStiffness(m, input, element->K, element->R, &L);
+        toGlobal(element->K, element->R, Kg);
+        const int *slot = &_slot[m * 144];
+        for (int i = 0; i < 144; i++) {
+            if (slot[i] >= 0) {
+                _Ax[slot[i]] += Kg[i / 12][i % 12];
+            }
+        }
+        if (_config.gravity) {
+            double weight = section.A * L * input->metalDensity;
+            _load[_layout.member[m].node[0] * 6 + 1] -= 0.5 * weight;
+            _load[_layout.member[m].node[1] * 6 + 1] -= 0.5 * weight;
+        }
+    }
+
+    /* Panel loads: mirror weight and BM11Wind's force shared by projected area */
+    double heading = BMMathDegreesToRadians(_config.wind_heading);
+    double wind[3] = { cos(heading), 0.0, sin(heading) };
+    double share[BM11_FRAME_PANELS], share_total = 0.0;
+    double area[BM11_FRAME_PANELS];
+    for (int p = 0; p < BM11_FRAME_PANELS; p++) {
+        const int *c  = _layout.panel_node[p];
+        BMVector3  n  = BMVector3CrossProduct(BMVector3Subtract(_layout.node[c[1]], _layout.node[c[0]]),
+                                              BMVector3Subtract(_layout.node[c[2]], _layout.node[c[0]]));
+        area[p]       = 0.5 * BMVector3Length(n);
+        share[p]      = 0.5 * fabs(n.x * wind[0] + n.z * wind[2]);
+        share_total  += share[p];
+    }
+    BMVector3 An      = BMVector3MultiplyScalar(BMVector3CrossProduct(BMVector3Subtract(output->vertex_coord.B0, output->vertex_coord.A0),
+                                                                      BMVector3Subtract(output->vertex_coord.B0, output->vertex_coord.O)), 0.5f);
+    double wind_force = 2.0 * fabs(An.x * wind[0] + An.z * wind[2]) *
+                        BM11WindPressure(_config.wind_speed_mph) * _config.drag_coefficient;
+    for (int p = 0; p < BM11_FRAME_PANELS; p++) {
+        double force = (share_total > 0.0) ? (wind_force * share[p] / share_total) : 0.0;
+        for (int c = 0; c < 3; c++) {
+            double *load = &_load[_layout.panel_node[p][c] * 6];
+            load[0] += force * wind[0] / 3.0;
+            load[2] += force * wind[2] / 3.0;
+            load[1] -= _config.panel_weight * area[p] / 3.0;
+        }
+    }
+
+    /* Up-looking Cholesky on the fixed pattern */
+    std::vector<int> next(_Lp.begin(), _Lp.end() - 1);
+    for (int k = 0; k < _n; k++) {
+        for (int p = _Ap[k]; p < _Ap[k + 1]; p++) {
+            _x[_Ai[p]] = _Ax[p];
+        }
+        double d = _x[k];
+        _x[k] = 0.0;
+        for (int r = _reach_p[k]; r < _reach_p[k + 1]; r++) {
+            int    i   = _reach[r];
+            double lki = _x[i] / _Lx[_Lp[i]];
+            _x[i] = 0.0;
+            for (int p = _Lp[i] + 1; p < next[i]; p++) {
+                _x[_Li[p]] -= _Lx[p] * lki;
+            }
+            d -= lki * lki;
+            int p  = next[i]++;
+            _Li[p] = k;
+            _Lx[p] = lki;
+        }
+        if (!(d > 0.0)) {
+            std::fill(_x.begin(), _x.end(), 0.0);
+            return false;
+        }
+        int p  = next[k]++;
+        _Li[p] = k;
+        _Lx[p] = sqrt(d);
+    }
+
+    /* L L^T u = f */
+    for (int v = 0; v < nodes * 6; v++) {
+        if (_dof[v] >= 0) {
+            _x[_dof[v]] = _load[v];
+        }
+    }
+    for (int j = 0; j < _n; j++) {
+        _x[j] /= _Lx[_Lp[j]];
+        for (int p = _Lp[j] + 1; p < _Lp[j + 1]; p++) {
+            _x[_Li[p]] -= _Lx[p] * _x[j];
+        }
+    }
+    for (int j = _n - 1; j >= 0; j--) {
+        for (int p = _Lp[j] + 1; p < _Lp[j + 1]; p++) {
+            _x[j] -= _Lx[p] * _x[_Li[p]];
+        }
+        _x[j] /= _Lx[_Lp[j]];
+    }
+    for (int v = 0; v < nodes * 6; v++) {
+        _u[v] = (_dof[v] >= 0) ? _x[_dof[v]] : 0.0;
+    }
+    std::fill(_x.begin(), _x.end(), 0.0);
+
+    /* Member end forces and ground reactions */
+    std::fill(_reaction.begin(), _reaction.end(), 0.0);
+    for (int v = 0; v < nodes; v++) {
+        if (_layout.ground[v]) {
+            for (int k = 0; k < 3; k++) {
+                _reaction[v * 3 + k] = -_load[v * 6 + k];
+            }
+        }
+    }
+    summary->solved = true;
+    for (int m = 0; m < _layout.member_count; m++) {
+        const double (*Kl)[12] = _element[m].K;
+        const double (*R)[3]   = _element[m].R;
+        double                 ul[12], f[12];
+        for (int e = 0; e < 2; e++) {
+            for (int block = 0; block < 2; block++) {
+                const double *ug = &_u[_layout.member[m].node[e] * 6 + block * 3];
+                for (int i = 0; i < 3; i++) {
+                    ul[e * 6 + block * 3 + i] = R[i][0] * ug[0] + R[i][1] * ug[1] + R[i][2] * ug[2];
+                }
+            }
+        }
+        for (int i = 0; i < 12; i++) {
+            f[i] = 0.0;
+            for (int j = 0; j < 12; j++) {
+                f[i] += Kl[i][j] * ul[j];
+            }
+        }
+        for (int e = 0; e < 2; e++) {
+            int v = _layout.member[m].node[e];
+            if (_layout.ground[v]) {
+                for (int k = 0; k < 3; k++) {
+                    _reaction[v * 3 + k] += R[0][k] * f[e * 6 + 0] + R[1][k] * f[e * 6 + 1] + R[2][k] * f[e * 6 + 2];
+                }
+            }
+        }
+
+        BM11TrussMemberForce *force = &_force[m];
+        double stress[2];
+        for (int e = 0; e < 2; e++) {
+            stress[e] = (fabs(f[6]) / section.A) + (fabs(f[e * 6 + 4]) / section.Sy) + (fabs(f[e * 6 + 5]) / section.Sz);
+        }
+        force->axial   = (float)f[6];
+        force->shear   = (float)std::max(hypot(f[1], f[2]), hypot(f[7], f[8]));
+        force->torsion = (float)fabs(f[9]);
+        force->moment  = (float)std::max(hypot(f[4], f[5]), hypot(f[10], f[11]));
+        force->stress  = (float)std::max(stress[0], stress[1]);
+
+        if (force->stress > summary->max_stress) {
+            summary->max_stress        = force->stress;
+            summary->max_stress_member = m;
+        }
+        summary->max_tension     = std::max(summary->max_tension, force->axial);
+        summary->max_compression = std::max(summary->max_compression, -force->axial);
+    }
+    for (int v = 0; v < nodes; v++) {
+        float d = (float)sqrt(_u[v * 6] * _u[v * 6] + _u[v * 6 + 1] * _u[v * 6 + 1] + _u[v * 6 + 2] * _u[v * 6 + 2]);
+        if (d > summary->max_displacement) {
+            summary->max_displacement      = d;
+            summary->max_displacement_node = v;
+        }
+    }
+    return true;
+}
+
+BMVector3 BM11TrussSolver::getDisplacement(int node) const
+{
+    return BMVector3Make((float)_u[node * 6], (float)_u[node * 6 + 1], (float)_u[node * 6 + 2]);
+}
+
+BMVector3 BM11TrussSolver::getReaction(int node) const
+{
+    return BMVector3Make((float)_reaction[node * 3], (float)_reaction[node * 3 + 1], (float)_reaction[node * 3 + 2]);
+}
+
+BMVector3 BM11TrussSolver::getLoad(int node) const
+{
+    return BMVector3Make((float)_load[node * 6], (float)_load[node * 6 + 1], (float)_load[node * 6 + 2]);
+}
+
+/* Batch */
+
+typedef struct {
+    const BM11Model::InputParameters  *inputs;
+    const BM11Model::OutputParameters *outputs;
+    BM11TrussSummary                  *summaries;
+    BM11TrussSolver                  **solvers;
+} TrussJob;
+
+static void trussRange(void *context, uint64_t begin, uint64_t end, int thread_index)
+{
+    TrussJob        *job    = (TrussJob *)context;
+    BM11TrussSolver *solver = job->solvers[thread_index];
+
+    for (uint64_t i = begin; i < end; i++) {
+        solver->solve(&job->inputs[i], &job->outputs[i], &job->summaries[i]);
+    }
+}
+
+void BM11TrussSolveBatch(const BM11TrussConfig *config,
+                         const BM11Model::InputParameters  *inputs,
+                         const BM11Model::OutputParameters *outputs,
+                         size_t count, BM11TrussSummary *summaries, int thread_count)
+{
+    if (thread_count <= 0) {
+        thread_count = BM11ParallelThreadCount();
+    }
+    std::vector<BM11TrussSolver *> solvers(thread_count);
+    for (int t = 0; t < thread_count; t++) {
+        solvers[t] = new BM11TrussSolver(config);
+    }
+
+    TrussJob job;
+    job.inputs    = inputs;
+    job.outputs   = outputs;
+    job.summaries = summaries;
+    job.solvers   = solvers.data();
+    BM11ParallelFor(count, 0, thread_count, trussRange, &job);
+
+    for (int t = 0; t < thread_count; t++) {
+        delete solvers[t];
+    }
+}
+
+void BM11TrussPrint(FILE *file, const BM11TrussSolver *solver, const BM11TrussSummary *summary)
+{
+    static const char *kindName[] = { "perimeter", "reinforce", "crossbar" };
+    const BM11FrameLayout *layout = solver->getLayout();
+
+    if (!summary->solved) {
+        fprintf(file, "Truss: not solved\n");
+        return;
+    }
+    fprintf(file, "Truss: %d equations, %zu nonzeros in L\n", solver->getEquationCount(), solver->getFactorNonzeroCount());
+    fprintf(file, "   Max displacement = %.4f in at node %d\n", summary->max_displacement, summary->max_displacement_node);
+    fprintf(file, "   Max stress       = %.0f psi in member %d\n", summary->max_stress, summary->max_stress_member);
+    fprintf(file, "   Max tension      = %.1f lb\n", summary->max_tension);
+    fprintf(file, "   Max compression  = %.1f lb\n", summary->max_compression);
+    fprintf(file, "   %-6s %-10s %5s %5s %12s %12s %12s %12s\n", "member", "kind", "from", "to", "axial (lb)", "shear (lb)", "moment", "stress (psi)");
+    for (int m = 0; m < layout->member_count; m++) {
+        const BM11FrameMember      *member = &layout->member[m];
+        const BM11TrussMemberForce *force  = solver->getMemberForce(m);
+        fprintf(file, "   %-6d %-10s %5d %5d %12.1f %12.1f %12.1f %12.0f\n", m, kindName[member->kind],
+                member->node[0], member->node[1], force->axial, force->shear, force->moment, force->stress);
+    }
+}
@@ -0,0 +1,176 @@
+#ifndef BM11_TRUSS_H
+#define BM11_TRUSS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+#include "BM11Model.h"
+
+/*
+   Structural analysis of the frame under wind and gravity.
+
+   BM11FrameLayoutBuild() turns vertex_coord into the members of the frame.
+   Each of the four mirror panels (O A0 B0, O C0 B0, O A1 B1 and O C1 B1)
+   has its own perimeter, OA, AB and OB, so the OB edges, shared by two
+   panels, carry two members, as in frame.perimeter_length. Reinforcement
+   runs from `subdivisions` evenly spaced points on OA to B, optionally with
+   a crossbar between B0 and B1. The topology depends only on
+   BM11FrameConfig, never on the design. BM11Mesh builds on the same layout.
+
+   BM11TrussSolver models every member as a 3D frame (beam) element with
+   the box section of frameCrossSection and frameWallThickness: x across
+   the panel (along its normal), y in the panel plane. The torsion constant
+   is Bredt's, 4 Am^2 t / perimeter, for the mid-wall line. Units are inches
+   and pounds, E = 29e6 psi and G = 11.2e6 psi (steel). Ground nodes (A, B
+   and C) are pinned: translations fixed, rotations free.
+
+   Loads are lumped at the nodes:
+      - gravity: each member's weight (metalDensity) split between its
+        ends, plus an optional mirror weight per panel area split between
+        the panel corners;
+      - wind: the force of BM11Wind at one heading, area(t) * pressure *
+        drag coefficient, split between the panels in proportion to their
+        projected areas and then between each panel's corners.
+
+   The stiffness matrix is assembled over the free degrees of freedom in
+   minimum degree order and factored by an up-looking sparse Cholesky
+   (elimination tree and row reaches, as in CSparse). Ordering, elimination
+   tree, the pattern of L and each element's slots in the matrix are
+   computed once in the constructor; solve() only assembles values and
+   refactors, so one solver per thread handles a whole sweep.
+ */
+
+#define BM11_FRAME_PANELS           4
+#define BM11_FRAME_MAX_SUBDIVISIONS 8
+#define BM11_FRAME_MAX_NODES        (7 + BM11_FRAME_PANELS * BM11_FRAME_MAX_SUBDIVISIONS)
+#define BM11_FRAME_MAX_MEMBERS      (BM11_FRAME_PANELS * (2 * BM11_FRAME_MAX_SUBDIVISIONS + 3) + 1)
+
+typedef struct {
+    int  subdivisions; /* Reinforcing members per panel, from points on OA to B */
+    bool crossbar;     /* Member between B0 and B1                              */
+} BM11FrameConfig;
+
+typedef enum {
+    BM11FrameMemberPerimeter,
+    BM11FrameMemberReinforce,
+    BM11FrameMemberCrossbar
+} BM11FrameMemberKind;
+
+typedef struct {
+    int                 node[2];
+    int                 panel;  /* 0-3, -1 for the crossbar                       */
+    BM11FrameMemberKind kind;
+    BMVector3           normal; /* Unit section x axis: the panel normal, or up   */
+} BM11FrameMember;
+
+typedef struct {
+    int             node_count;
+    BMVector3       node[BM11_FRAME_MAX_NODES];  /* ft; 0 = O, then A0 B0 C0 A1 B1 C1, then points on OA */
+    bool            ground[BM11_FRAME_MAX_NODES];
+    int             member_count;
+    BM11FrameMember member[BM11_FRAME_MAX_MEMBERS];
+    int             panel_node[BM11_FRAME_PANELS][3]; /* O, A (or C), B                     */
+    BMVector3       panel_normal[BM11_FRAME_PANELS];  /* Unit, pointing out of the tetrahedron */
+} BM11FrameLayout;
+
+/* Three reinforcing members per panel and the crossbar, the frame the
+   model's reinforce_length estimate describes */
+void BM11FrameConfigInit(BM11FrameConfig *config);
+
+void BM11FrameLayoutBuild(const BM11FrameConfig *config, const BM11Model::OutputParameters *output, BM11FrameLayout *layout);
+
+typedef struct {
+    BM11FrameConfig frame;
+    float           wind_heading;     /* Degrees from +X towards +Z, as BM11Wind  */
+    float           wind_speed_mph;
+    float           drag_coefficient;
+    bool            gravity;
+    float           panel_weight;     /* Mirror lb/ft^2, 0 leaves it out as total.mass does */
+} BM11TrussConfig;
+
+typedef struct {
+    float axial;   /* lb, tension positive                           */
+    float shear;   /* lb, largest resultant at either end            */
+    float torsion; /* lb in                                          */
+    float moment;  /* lb in, largest bending resultant at either end */
+    float stress;  /* psi, |axial| / A + |My| / Sy + |Mz| / Sz bound */
+} BM11TrussMemberForce;
+
+typedef struct {
+    bool  solved;                /* False for rejected designs or a singular frame */
+    float max_displacement;      /* in */
+    int   max_displacement_node;
+    float max_stress;            /* psi */
+    int   max_stress_member;
+    float max_tension;           /* lb */
+    float max_compression;       /* lb, as a positive number */
+} BM11TrussSummary;
+
+/* Wind from 0 degrees at 100 MPH with Cd 1, gravity on, no mirror weight */
+void BM11TrussConfigInit(BM11TrussConfig *config);
+
+class BM11TrussSolver {
+public:
+    BM11TrussSolver(const BM11TrussConfig *config);
+
+    bool                        solve(const BM11Model::InputParameters  *input,
+                                      const BM11Model::OutputParameters *output,
+                                      BM11TrussSummary                  *summary);
+
+    /* Results of the last successful solve() */
+    const BM11FrameLayout      *getLayout(void) const               { return &_layout; };
+    BMVector3                   getDisplacement(int node) const;    /* in */
+    BMVector3                   getReaction(int node) const;        /* lb, zero off the ground */
+    BMVector3                   getLoad(int node) const;            /* lb */
+    const BM11TrussMemberForce *getMemberForce(int member) const    { return &_force[member]; };
+
+    int                         getEquationCount(void) const        { return _n; };
+    size_t                      getFactorNonzeroCount(void) const   { return _Li.size(); };
+
+private:
+    BM11TrussSolver(const BM11TrussSolver &);
+    BM11TrussSolver &operator=(const BM11TrussSolver &);
+
+    void symbolic(void);
+    void elementStiffness(int member, const BM11Model::InputParameters *input, double K[12][12], double R[3][3], double *length) const;
+
+    typedef struct {
+        double K[12][12]; /* Local stiffness */
+        double R[3][3];   /* Rows are the local axes */
+    } Element;
+
+    BM11TrussConfig                   _config;
+    BM11FrameLayout                   _layout;
+
+    /* Symbolic analysis */
+    int                               _n;          /* Free degrees of freedom */
+    std::vector<int>                  _dof;        /* node * 6 + k -> equation, -1 if fixed */
+    std::vector<int>                  _Ap, _Ai;    /* Upper triangle of K, compressed columns */
+    std::vector<int>                  _slot;       /* Per member, 12 x 12 positions in _Ax or -1 */
+    std::vector<int>                  _parent;     /* Elimination tree */
+    std::vector<int>                  _Lp;         /* Column pointers of L */
+    std::vector<int>                  _reach_p;    /* Row k of L: _reach[_reach_p[k] .. _reach_p[k + 1]) */
+    std::vector<int>                  _reach;
+
+    /* Numeric */
+    std::vector<Element>              _element;
+    std::vector<double>               _Ax;
+    std::vector<int>                  _Li;
+    std::vector<double>               _Lx;
+    std::vector<double>               _x;          /* Work vector */
+    std::vector<double>               _u;          /* node * 6 + k displacements and rotations */
+    std::vector<double>               _load;       /* node * 6 + k */
+    std::vector<double>               _reaction;   /* node * 3 + k */
+    std::vector<BM11TrussMemberForce> _force;
+};
+
+/* Solves `count` designs across threads, one solver each */
+void BM11TrussSolveBatch(const BM11TrussConfig *config,
+                         const BM11Model::InputParameters  *inputs,
+                         const BM11Model::OutputParameters *outputs,
+                         size_t count, BM11TrussSummary *summaries, int thread_count);
+
+void BM11TrussPrint(FILE *file, const BM11TrussSolver *solver, const BM11TrussSummary *summary);
+
+#endif /* BM11_TRUSS_H */
@@ -0,0 +1,119 @@
+#include <math.h>
+#include <vector>
+#include "BM11Lanes.h"
+#include "BM11Wind.h"
+
+static const float defaultSpeeds[] = {
+     5.0f, 10.0f, 15.0f, 20.0f, 25.0f, 30.0f, 35.0f, 40.0f, 45.0f, 50.0f,
+    55.0f, 60.0f, 65.0f, 70.0f, 75.0f, 80.0f, 85.0f, 90.0f, 95.0f, 100.0f
+};
+static const float defaultDrag = 1.0f;
+
+void BM11WindGridInit(BM11WindGrid *grid)
+{
+    grid->direction_count  = 360;
+    grid->speed_count      = sizeof(defaultSpeeds) / sizeof(defaultSpeeds[0]);
+    grid->speed_mph        = defaultSpeeds;
+    grid->drag_count       = 1;
+    grid->drag_coefficient = &defaultDrag;
+}
+
+size_t BM11WindAreaCount(const BM11WindGrid *grid)
+{
+    return grid->direction_count;
+}
+
+size_t BM11WindForceCount(const BM11WindGrid *grid)
+{
+    return (size_t)grid->drag_count * grid->direction_count * grid->speed_count;
+}
+
+float BM11WindPressure(float mph)
+{
+    float ft_per_sec = mph * 1.46667f;
+    return (float)((ft_per_sec * ft_per_sec) * 0.00256);
+}
+
+/* dst[i] = |nx * cosine[i] + nz * sine[i]| * 2 for i in [0, count) */
+template <typename V> static size_t areaLanes(float nx, float nz, const float *cosine, const float *sine,
+                                              float *dst, size_t begin, size_t count)
+{
+    const size_t width = (size_t)bmWidth<V>();
+    size_t       i;
+
+    for (i = begin; (i + width) <= count; i += width) {
+        V projected = (V(nx) * bmLoad<V>(cosine + i)) + (V(nz) * bmLoad<V>(sine + i));
+        bmStore(dst + i, bmAbs(projected) * V(2.0f));
+    }
+    return i;
+}
+
+/* dst[i] = area * k[i] for i in [0, count) */
+template <typename V> static size_t forceLanes(float area, const float *k, float *dst, size_t begin, size_t count)
+{
+    const size_t width = (size_t)bmWidth<V>();
+    size_t       i;
+
+    for (i = begin; (i + width) <= count; i += width) {
+        bmStore(dst + i, V(area) * bmLoad<V>(k + i));
+    }
+    return i;
+}
+
+void BM11WindEvaluate(const BM11WindGrid *grid, const BM11Model::OutputParameters *designs, size_t design_count,
+                      float *area, float *force)
+{
+    const size_t directions = grid->direction_count;
+    const size_t speeds     = grid->speed_count;
+    const size_t per_drag   = directions * speeds;
+
+    /* Heading and pressure terms are shared by every design */
+    std::vector<float> cosine(directions), sine(directions);
+    for (size_t d = 0; d < directions; d++) {
+        double radians = (2.0 * M_PI * (double)d) / (double)directions;
+        double c       = cos(radians);
+        double s       = sin(radians);
+        /* Exact zeros on the axes so 0 and 90 degrees reproduce the YZ and XY areas */
+        cosine[d] = (fabs(c) < 1e-12) ? 0.0f : (float)c;
+        sine[d]   = (fabs(s) < 1e-12) ? 0.0f : (float)s;
+    }
+    std::vector<float> k((size_t)grid->drag_count * speeds);
+    for (uint32_t c = 0; c < grid->drag_count; c++) {
+        for (size_t s = 0; s < speeds; s++) {
+            k[c * speeds + s] = BM11WindPressure(grid->speed_mph[s]) * grid->drag_coefficient[c];
+        }
+    }
+
+    std::vector<float> scratch(area ? 0 : directions);
+    for (size_t i = 0; i < design_count; i++) {
+        const BM11Model::OutputParameters *op = &designs[i];
+        float *design_area = area ? (area + i * directions) : scratch.data();
+
+        /* Area vector of triangle OBA (times two, halved below) */
+        BMVector3 n = BMVector3CrossProduct(BMVector3Subtract(op->vertex_coord.B0, op->vertex_coord.A0),
+                                            BMVector3Subtract(op->vertex_coord.B0, op->vertex_coord.O));
+        float     nx = n.x * 0.5f;
+        float     nz = n.z * 0.5f;
+
+        size_t done = 0;
+        if (sizeof(BMLane) != sizeof(float)) {
+            done = areaLanes<BMLane>(nx, nz, cosine.data(), sine.data(), design_area, 0, directions);
+        }
+        areaLanes<float>(nx, nz, cosine.data(), sine.data(), design_area, done, directions);
+
+        if (!force) {
+            continue;
+        }
+        float *design_force = force + i * BM11WindForceCount(grid);
+        for (uint32_t c = 0; c < grid->drag_count; c++) {
+            for (size_t d = 0; d < directions; d++) {
+                float *dst = design_force + c * per_drag + d * speeds;
+                done = 0;
+                if (sizeof(BMLane) != sizeof(float)) {
+                    done = forceLanes<BMLane>(design_area[d], &k[c * speeds], dst, 0, speeds);
+                }
+                forceLanes<float>(design_area[d], &k[c * speeds], dst, done, speeds);
+            }
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef BM11_WIND_H
+#define BM11_WIND_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "BM11Model.h"
+
+/*
+   Wind load tables for any heading and speed.
+
+   Headings lie in the ground (XZ) plane, measured from +X towards +Z:
+   0 degrees blows along X and loads the YZ projection, 90 degrees blows
+   along Z and loads the XY projection, matching wind.total_surface_area_YZ
+   and wind.total_surface_area_XY. The loaded area at heading t is that of
+   triangle OBA (twice, as in the model) projected on the plane normal to
+   the wind,
+
+      area(t) = 2 |n.x cos(t) + n.z sin(t)|,   n = (B0 - A0) x (B0 - O) / 2
+
+   and the force is area * pressure(speed) * drag coefficient, with the
+   same pressure formula the model's report has always used.
+
+   BM11WindEvaluate() fills the tables for many designs in one pass, in
+   lanes of BMLane across headings and speeds. Nothing is printed.
+ */
+
+typedef struct {
+    uint32_t     direction_count;  /* Headings i * 360 / direction_count degrees  */
+    uint32_t     speed_count;
+    const float *speed_mph;        /* speed_count wind speeds                     */
+    uint32_t     drag_count;
+    const float *drag_coefficient; /* drag_count coefficients, one table each     */
+} BM11WindGrid;
+
+/* 1 degree headings, 5..100 MPH in 5 MPH steps and a drag coefficient of 1 */
+void   BM11WindGridInit(BM11WindGrid *grid);
+
+/* Floats per design in the `area` and `force` tables */
+size_t BM11WindAreaCount(const BM11WindGrid *grid);
+size_t BM11WindForceCount(const BM11WindGrid *grid);
+
+/* Dynamic pressure in lb/ft^2 */
+float  BM11WindPressure(float mph);
+
+/* For each design, `area` receives direction_count projected areas (ft^2) and
+   `force` receives [drag][direction][speed] forces (lb); either may be NULL.
+   Only vertex_coord is read, so rejected designs (all zero) give zero loads. */
+void   BM11WindEvaluate(const BM11WindGrid *grid, const BM11Model::OutputParameters *designs, size_t design_count,
+                        float *area, float *force);
+
+#endif /* BM11_WIND_H */
@@ -0,0 +1,112 @@
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include "BM11Batch.h"
+#include "BM11Fields.h"
+#include "BM11Model.h"
+#include "BM11Test.h"
+
+/*
+   BM11EvaluateBatch() against BM11Model over random designs: statuses
+   agree, outputs agree to float tolerance, rejected designs are zeroed
+   and NULL output columns change nothing else.
+ */
+
+#define DESIGN_COUNT 4099 /* Not a multiple of any lane width */
+
+/* The polynomial trig of the batch path is good to a few 1e-7. Positions
+   and heights of flat tetrahedra are ill conditioned, so lengths and areas
+   are compared on the scale of the edges; walkway widths also cancel in
+   (O.y - shoulderHeight) on both paths. */
+static double outputTolerance(int field, float expected, float edge)
+{
+    const char *name  = BM11OutputFieldInfo[field].name;
+    double      scale = fabs(expected) > 1 ? fabs(expected) : 1;
+    if (field == BM11OutputField_overall_structure_walkway_base_width ||
+        field == BM11OutputField_overall_structure_walkway_shoulder_width) {
+        return 5e-3 * scale;
+    }
+    if (strncmp(name, "vertex_coord.", 13) == 0 || field == BM11OutputField_overall_structure_height) {
+        scale = fmax(scale, edge);
+    } else if (strncmp(name, "wind.", 5) == 0) {
+        scale = fmax(scale, edge * edge);
+    }
+    return 2e-5 * scale;
+}
+
+int main(void)
+{
+    std::vector<BM11Model::InputParameters> designs(DESIGN_COUNT);
+    uint64_t state = 2;
+    for (int d = 0; d < DESIGN_COUNT; d++) {
+        designs[d] = BM11TestRandomInputs(&state);
+    }
+
+    std::vector<float> inputs((size_t)BM11InputField_Count * DESIGN_COUNT);
+    std::vector<float> outputs((size_t)BM11OutputField_Count * DESIGN_COUNT);
+    std::vector<uint8_t> status(DESIGN_COUNT);
+    BM11BatchInput  input;
+    BM11BatchOutput output;
+    for (int f = 0; f < BM11InputField_Count; f++) {
+        input.column[f] = &inputs[(size_t)f * DESIGN_COUNT];
+        for (int d = 0; d < DESIGN_COUNT; d++) {
+            inputs[(size_t)f * DESIGN_COUNT + d] = BM11GetInputField(&designs[d], f);
+        }
+    }
+    for (int f = 0; f < BM11OutputField_Count; f++) {
+        output.column[f] = &outputs[(size_t)f * DESIGN_COUNT];
+    }
+    output.status = &status[0];
+    BM11EvaluateBatch(&input, &output, DESIGN_COUNT);
+
+    int    accepted = 0, rejected = 0, status_mismatches = 0;
+    double cost_error = 0;
+    for (int d = 0; d < DESIGN_COUNT; d++) {
+        BM11Model model;
+        model.setInputParameters(designs[d]);
+        BM11Model::OutputParameters expected = model.getOutputParameters();
+        BM11Model::Status expected_status = model.getStatus();
+
+        if (status[d] != (uint8_t)expected_status) {
+            status_mismatches++;
+            continue;
+        }
+        if (expected_status != BM11Model::StatusOK) {
+            rejected++;
+            for (int f = BM11OutputField_vertex_coord_A0_x; f < BM11OutputField_Count; f++) {
+                BM11_CHECK(outputs[(size_t)f * DESIGN_COUNT + d] == 0.0f);
+            }
+            continue;
+        }
+        accepted++;
+        float cost = outputs[(size_t)BM11OutputField_total_cost * DESIGN_COUNT + d];
+        cost_error = fmax(cost_error, fabs(cost - expected.total.cost) / expected.total.cost);
+        for (int f = 0; f < BM11OutputField_Count; f++) {
+            float value = outputs[(size_t)f * DESIGN_COUNT + d];
+            float reference = BM11GetOutputField(&expected, f);
+            if (!BM11_CHECK_NEAR(value, reference, outputTolerance(f, reference, expected.edge_length.OA))) {
+                fprintf(stderr, "    design %d, %s\n", d, BM11OutputFieldInfo[f].name);
+            }
+        }
+    }
+    printf("%d accepted, %d rejected, %d status mismatches, total.cost relative error %.2g\n",
+           accepted, rejected, status_mismatches, cost_error);
+    BM11_CHECK(cost_error < 1e-6);
+    BM11_CHECK(accepted > DESIGN_COUNT / 4);
+    BM11_CHECK(rejected > 0);
+    /* Only designs at the float rounding edge of a feasibility threshold */
+    BM11_CHECK(status_mismatches <= 2);
+
+    /* Totals only: the skipped columns don't change what is computed */
+    std::vector<float> cost(DESIGN_COUNT);
+    std::vector<uint8_t> cost_status(DESIGN_COUNT);
+    BM11BatchOutput totals;
+    memset(&totals, 0, sizeof(totals));
+    totals.column[BM11OutputField_total_cost] = &cost[0];
+    totals.status = &cost_status[0];
+    BM11EvaluateBatch(&input, &totals, DESIGN_COUNT);
+    BM11_CHECK(memcmp(&cost[0], output.column[BM11OutputField_total_cost], sizeof(float) * DESIGN_COUNT) == 0);
+    BM11_CHECK(memcmp(&cost_status[0], &status[0], DESIGN_COUNT) == 0);
+
+    return BM11TestFinish("BM11BatchTests");
+}
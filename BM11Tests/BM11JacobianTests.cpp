@@ -0,0 +1,148 @@
+#include <math.h>
+#include "BM11Dual.h"
+#include "BM11Fields.h"
+#include "BM11Jacobian.h"
+#include "BM11Kernel.h"
+#include "BM11Model.h"
+#include "BM11Test.h"
+
+/*
+   BM11EvaluateJacobian() against central differences of the same kernel
+   run in double precision, on the default design and random ones; its
+   outputs against BM11Model, and rejected designs with zero derivatives.
+ */
+
+/* The kernel in double precision, inputs given exactly */
+static void evaluateDouble(const double *inputs, double *outputs)
+{
+    BM11Dual in[BM11InputField_Count];
+    BM11Dual out[BM11OutputField_Count];
+    for (int f = 0; f < BM11InputField_Count; f++) {
+        in[f]   = BM11Dual(0.0f);
+        in[f].v = inputs[f];
+    }
+    bm11KernelEvaluate(in, out);
+    for (int o = 0; o < BM11OutputField_Count; o++) {
+        outputs[o] = out[o].v;
+    }
+}
+
+/* Largest relative error of the derivatives of one design. Entries that
+   are zero or tiny against the rest of their row are compared on the
+   row's scale, and rounding in the differences is discounted. */
+static double checkDesign(const BM11Model::InputParameters *input)
+{
+    BM11Model::OutputParameters output;
+    BM11Jacobian                jacobian;
+    BM11EvaluateJacobian(input, &output, &jacobian);
+
+    double x[BM11InputField_Count];
+    for (int f = 0; f < BM11InputField_Count; f++) {
+        x[f] = BM11GetInputField(input, f);
+    }
+
+    static double difference[BM11OutputField_Count][BM11InputField_Count];
+    for (int i = 0; i < BM11InputField_Count; i++) {
+        double h = 1e-5 * fmax(fabs(x[i]), 1.0);
+        double plus[BM11OutputField_Count], minus[BM11OutputField_Count];
+        double xi = x[i];
+        x[i] = xi + h;
+        evaluateDouble(x, plus);
+        x[i] = xi - h;
+        evaluateDouble(x, minus);
+        x[i] = xi;
+        for (int o = 0; o < BM11OutputField_Count; o++) {
+            difference[o][i] = (plus[o] - minus[o]) / (2.0 * h);
+        }
+    }
+
+    double worst = 0;
+    for (int o = 0; o < BM11OutputField_Count; o++) {
+        double row = 0;
+        for (int i = 0; i < BM11InputField_Count; i++) {
+            row = fmax(row, fabs(jacobian.d[o][i]) * fmax(fabs(x[i]), 1.0));
+        }
+        double value = fmax(fabs(BM11GetOutputField(&output, o)), 1.0);
+        for (int i = 0; i < BM11InputField_Count; i++) {
+            double size  = fmax(fabs(x[i]), 1.0);
+            double noise = 1e-9 * value / size; /* Rounding of the differences */
+            double scale = fmax(fabs(jacobian.d[o][i]), 1e-3 * row / size);
+            double error = fabs(jacobian.d[o][i] - difference[o][i]) - noise;
+            if (error > 0) {
+                worst = fmax(worst, error / scale);
+            }
+        }
+    }
+    return worst;
+}
+
+static void testDerivatives(void)
+{
+    BM11Model::InputParameters defaults = BM11Model::getDefaultInputParameters();
+    double error = checkDesign(&defaults);
+    printf("default design: derivative relative error %.2g\n", error);
+    BM11_CHECK(error < 1e-8);
+
+    uint64_t state = 12;
+    double   worst = 0;
+    int      checked = 0;
+    for (int d = 0; d < 200; d++) {
+        BM11Model::InputParameters input = BM11TestRandomInputs(&state);
+        if (BM11Model::checkFeasibility(&input) != BM11Model::StatusOK) {
+            continue;
+        }
+        BM11Model model;
+        model.setInputParameters(input);
+        if (model.getStatus() != BM11Model::StatusOK) {
+            continue;
+        }
+        worst = fmax(worst, checkDesign(&input));
+        checked++;
+    }
+    printf("%d random designs: derivative relative error %.2g\n", checked, worst);
+    BM11_CHECK(checked > 50);
+    BM11_CHECK(worst < 1e-5);
+}
+
+static void testOutputs(void)
+{
+    uint64_t state = 13;
+    int      wrong = 0;
+    for (int d = 0; d < 500; d++) {
+        BM11Model::InputParameters input = BM11TestRandomInputs(&state);
+        if ((d % 10) == 0) {
+            input.baseCutBackLength = input.squareSideLength;
+        }
+        BM11Model model;
+        model.setInputParameters(input);
+        BM11Model::OutputParameters expected = model.getOutputParameters();
+
+        BM11Model::OutputParameters output;
+        BM11Jacobian                jacobian;
+        BM11Model::Status status = BM11EvaluateJacobian(&input, &output, &jacobian);
+        if (status != model.getStatus()) {
+            wrong++;
+            continue;
+        }
+        for (int o = 0; o < BM11OutputField_Count; o++) {
+            double value     = BM11GetOutputField(&output, o);
+            double reference = BM11GetOutputField(&expected, o);
+            if (fabs(value - reference) > 1e-4 * fmax(fabs(reference), expected.edge_length.OA)) {
+                wrong++;
+            }
+            if (status != BM11Model::StatusOK) {
+                for (int i = 0; i < BM11InputField_Count; i++) {
+                    wrong += (o >= BM11OutputField_vertex_coord_A0_x && jacobian.d[o][i] != 0.0);
+                }
+            }
+        }
+    }
+    BM11_CHECK(wrong == 0);
+}
+
+int main(void)
+{
+    testDerivatives();
+    testOutputs();
+    return BM11TestFinish("BM11JacobianTests");
+}
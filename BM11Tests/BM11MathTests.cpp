@@ -0,0 +1,164 @@
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include "BM11Math.h"
+#include "BM11Test.h"
+
+/*
+   BM11Math.h against double precision references, under whichever backend
+   the build selected. GLKit semantics: add, subtract and multiply are exact
+   per component; dot and cross round like the float expression; normalize
+   is v * (1 / length) without a zero-length guard, so the zero vector
+   normalizes to NaN; degree/radian conversions round the double result.
+ */
+
+#if defined(BM_MATH_USE_SSE)
+#  define BACKEND "sse"
+#elif defined(BM_MATH_USE_NEON)
+#  define BACKEND "neon"
+#else
+#  define BACKEND "scalar"
+#endif
+
+#if defined(BM11_EXPECT_MATH_SIMD) && defined(BM_MATH_USE_SCALAR)
+#  error "BM11MathTests expects a SIMD backend on this target"
+#endif
+
+static const float samples[][3] = {
+    {  0.0f,     0.0f,      1.0f     },
+    {  1.0f,     2.0f,      3.0f     },
+    { -4.5f,     0.25f,     7.0f     },
+    {  1e-3f,   -2e-3f,     3e-3f    },
+    {  1234.5f, -987.25f,   42.0f    },
+    { -0.3f,     0.7f,     -0.1f     },
+    {  16.0f,    8.6602545f, 5.0f    },
+    {  3.0f,    -3.0f,      3.0f     },
+};
+static const int sample_count = (int)(sizeof(samples) / sizeof(samples[0]));
+
+static BMVector3 sampleVector3(int i)
+{
+    return BMVector3Make(samples[i][0], samples[i][1], samples[i][2]);
+}
+
+/* Float results of sums of products may differ from the double reference
+   by a few ulps of the largest term */
+static double productTolerance(double a, double b, double c)
+{
+    return 4 * FLT_EPSILON * (fabs(a) + fabs(b) + fabs(c)) + 1e-30;
+}
+
+static void testLayout(void)
+{
+    BMVector3 v = BMVector3Make(1.0f, 2.0f, 3.0f);
+    BM11_CHECK(sizeof(BMVector2) == 8);
+    BM11_CHECK(sizeof(BMVector3) == 12);
+    BM11_CHECK(v.x == 1.0f && v.y == 2.0f && v.z == 3.0f);
+    BM11_CHECK(v.r == v.x && v.g == v.y && v.b == v.z);
+    BM11_CHECK(v.s == v.x && v.t == v.y && v.p == v.z);
+    BM11_CHECK(v.v[0] == v.x && v.v[1] == v.y && v.v[2] == v.z);
+
+    BMVector2 w = BMVector2Make(4.0f, 5.0f);
+    BM11_CHECK(w.x == 4.0f && w.y == 5.0f && w.s == w.x && w.t == w.y && w.v[1] == 5.0f);
+}
+
+static void testVector2(void)
+{
+    for (int i = 0; i < sample_count; i++) {
+        for (int j = 0; j < sample_count; j++) {
+            BMVector2 a = BMVector2Make(samples[i][0], samples[i][1]);
+            BMVector2 b = BMVector2Make(samples[j][1], samples[j][2]);
+
+            BMVector2 sum = BMVector2Add(a, b);
+            BMVector2 difference = BMVector2Subtract(a, b);
+            BMVector2 product = BMVector2Multiply(a, b);
+            BM11_CHECK(sum.x == a.x + b.x && sum.y == a.y + b.y);
+            BM11_CHECK(difference.x == a.x - b.x && difference.y == a.y - b.y);
+            BM11_CHECK(product.x == a.x * b.x && product.y == a.y * b.y);
+
+            double dot = (double)a.x * b.x + (double)a.y * b.y;
+            BM11_CHECK_NEAR(BMVector2DotProduct(a, b), dot,
+                            productTolerance((double)a.x * b.x, (double)a.y * b.y, 0));
+        }
+        BMVector2 a = BMVector2Make(samples[i][0], samples[i][1]);
+        double length = sqrt((double)a.x * a.x + (double)a.y * a.y);
+        BM11_CHECK_NEAR(BMVector2Length(a), length, 2 * FLT_EPSILON * length);
+    }
+}
+
+static void testVector3(void)
+{
+    for (int i = 0; i < sample_count; i++) {
+        for (int j = 0; j < sample_count; j++) {
+            BMVector3 a = sampleVector3(i);
+            BMVector3 b = sampleVector3((j + 3) % sample_count);
+
+            BMVector3 sum = BMVector3Add(a, b);
+            BMVector3 difference = BMVector3Subtract(a, b);
+            BMVector3 product = BMVector3Multiply(a, b);
+            BMVector3 scaled = BMVector3MultiplyScalar(a, b.y);
+            BMVector3 negated = BMVector3Negate(a);
+            for (int k = 0; k < 3; k++) {
+                BM11_CHECK(sum.v[k] == a.v[k] + b.v[k]);
+                BM11_CHECK(difference.v[k] == a.v[k] - b.v[k]);
+                BM11_CHECK(product.v[k] == a.v[k] * b.v[k]);
+                BM11_CHECK(scaled.v[k] == a.v[k] * b.y);
+                BM11_CHECK(negated.v[k] == -a.v[k]);
+            }
+
+            double ax = a.x, ay = a.y, az = a.z, bx = b.x, by = b.y, bz = b.z;
+            BM11_CHECK_NEAR(BMVector3DotProduct(a, b), ax * bx + ay * by + az * bz,
+                            productTolerance(ax * bx, ay * by, az * bz));
+
+            BMVector3 cross = BMVector3CrossProduct(a, b);
+            BM11_CHECK_NEAR(cross.x, ay * bz - az * by, productTolerance(ay * bz, az * by, 0));
+            BM11_CHECK_NEAR(cross.y, az * bx - ax * bz, productTolerance(az * bx, ax * bz, 0));
+            BM11_CHECK_NEAR(cross.z, ax * by - ay * bx, productTolerance(ax * by, ay * bx, 0));
+
+            double distance = sqrt((bx - ax) * (bx - ax) + (by - ay) * (by - ay) + (bz - az) * (bz - az));
+            BM11_CHECK_NEAR(BMVector3Distance(a, b), distance, 4 * FLT_EPSILON * distance);
+        }
+
+        BMVector3 a = sampleVector3(i);
+        double length = sqrt((double)a.x * a.x + (double)a.y * a.y + (double)a.z * a.z);
+        BM11_CHECK_NEAR(BMVector3Length(a), length, 2 * FLT_EPSILON * length);
+
+        BMVector3 unit = BMVector3Normalize(a);
+        for (int k = 0; k < 3; k++) {
+            BM11_CHECK_NEAR(unit.v[k], a.v[k] / length, 4 * FLT_EPSILON);
+        }
+    }
+
+    /* Unit-axis crosses are exact */
+    BMVector3 x = BMVector3Make(1, 0, 0), y = BMVector3Make(0, 1, 0), z = BMVector3Make(0, 0, 1);
+    BMVector3 xy = BMVector3CrossProduct(x, y), yz = BMVector3CrossProduct(y, z), zx = BMVector3CrossProduct(z, x);
+    BM11_CHECK(memcmp(&xy, &z, sizeof(z)) == 0);
+    BM11_CHECK(memcmp(&yz, &x, sizeof(x)) == 0);
+    BM11_CHECK(memcmp(&zx, &y, sizeof(y)) == 0);
+
+    /* GLKVector3Normalize has no zero guard: 0 * (1 / 0) is NaN */
+    BMVector3 zero = BMVector3Normalize(BMVector3Make(0, 0, 0));
+    BM11_CHECK(isnan(zero.x) && isnan(zero.y) && isnan(zero.z));
+}
+
+static void testConversions(void)
+{
+    static const float degrees[] = { 0.0f, 1.0f, 30.0f, 45.0f, 90.0f, 109.4712f, 180.0f, -270.0f, 360.0f };
+    for (size_t i = 0; i < sizeof(degrees) / sizeof(degrees[0]); i++) {
+        float d = degrees[i];
+        BM11_CHECK(BMMathDegreesToRadians(d) == (float)(d * (M_PI / 180)));
+        BM11_CHECK_NEAR(BMMathRadiansToDegrees(BMMathDegreesToRadians(d)), d, 2 * FLT_EPSILON * fabs(d));
+    }
+    BM11_CHECK(BMMathDegreesToRadians(180.0f) == (float)M_PI);
+    BM11_CHECK(BMMathRadiansToDegrees((float)M_PI) == 180.0f);
+    BM11_CHECK(BMMathRadiansToDegrees(1.0f) == (float)(180 / M_PI));
+}
+
+int main(void)
+{
+    testLayout();
+    testVector2();
+    testVector3();
+    testConversions();
+    return BM11TestFinish("BM11MathTests (" BACKEND ")");
+}
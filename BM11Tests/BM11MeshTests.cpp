@@ -0,0 +1,185 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <map>
+#include <utility>
+#include <vector>
+#include "BM11Mesh.h"
+#include "BM11Model.h"
+#include "BM11Test.h"
+#include "BM11Truss.h"
+
+/*
+   BM11MeshBuild(): every member prism is closed, wound outwards and has
+   the volume of its section, mirror faces point out of and into the
+   tetrahedron, rejected designs give empty meshes. BM11MeshWriter's STL
+   and OBJ files hold every triangle of several appended meshes.
+ */
+
+#define DESIGN_COUNT 200
+#define STL_PATH     "BM11MeshTests.stl"
+#define OBJ_PATH     "BM11MeshTests.obj"
+
+static BM11Mesh mesh;
+
+/* Relative to one of the prism's own vertices, which keeps the sum from
+   cancelling far from the origin */
+static double signedVolume(const BM11Mesh *m, uint32_t first, uint32_t count)
+{
+    BMVector3 origin = m->vertex[m->triangle[first][0]];
+    double    volume = 0;
+    for (uint32_t t = first; t < first + count; t++) {
+        BMVector3 a = BMVector3Subtract(m->vertex[m->triangle[t][0]], origin);
+        BMVector3 b = BMVector3Subtract(m->vertex[m->triangle[t][1]], origin);
+        BMVector3 c = BMVector3Subtract(m->vertex[m->triangle[t][2]], origin);
+        volume += BMVector3DotProduct(a, BMVector3CrossProduct(b, c)) / 6.0;
+    }
+    return volume;
+}
+
+/* Each directed edge once, and its reverse once */
+static bool closed(const BM11Mesh *m, uint32_t first, uint32_t count)
+{
+    std::map<std::pair<uint32_t, uint32_t>, int> edges;
+    for (uint32_t t = first; t < first + count; t++) {
+        for (int k = 0; k < 3; k++) {
+            edges[std::make_pair(m->triangle[t][k], m->triangle[t][(k + 1) % 3])]++;
+        }
+    }
+    for (std::map<std::pair<uint32_t, uint32_t>, int>::const_iterator e = edges.begin(); e != edges.end(); ++e) {
+        std::map<std::pair<uint32_t, uint32_t>, int>::const_iterator r =
+            edges.find(std::make_pair(e->first.second, e->first.first));
+        if (e->second != 1 || r == edges.end() || r->second != 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void testMeshes(void)
+{
+    BM11MeshConfig config;
+    BM11MeshConfigInit(&config);
+    uint64_t state = 17;
+    int      built = 0, open = 0, inverted = 0, wrong_volume = 0, wrong_faces = 0;
+
+    for (int d = 0; d < DESIGN_COUNT; d++) {
+        BM11Model::InputParameters input = BM11TestRandomInputs(&state);
+        if ((d % 9) == 0) {
+            input.baseCutBackLength = input.squareSideLength;
+        }
+        BM11Model model;
+        model.setInputParameters(input);
+        BM11Model::OutputParameters output = model.getOutputParameters();
+
+        bool ok = BM11MeshBuild(&config, &input, &output, &mesh);
+        if (model.getStatus() != BM11Model::StatusOK) {
+            BM11_CHECK(!ok && mesh.triangle_count == 0 && mesh.vertex_count == 0);
+            continue;
+        }
+        BM11_CHECK(ok);
+        built++;
+
+        BM11FrameLayout layout;
+        BM11FrameLayoutBuild(&config.frame, &output, &layout);
+        BM11_CHECK(mesh.member_triangle_count == (uint32_t)layout.member_count * 12);
+        BM11_CHECK(mesh.triangle_count == mesh.member_triangle_count + BM11_MESH_MIRRORS);
+
+        double depth = input.frameCrossSection.x / 12.0 * config.scale;
+        double width = input.frameCrossSection.y / 12.0 * config.scale;
+        for (int m = 0; m < layout.member_count; m++) {
+            open += !closed(&mesh, m * 12, 12);
+            double volume = signedVolume(&mesh, m * 12, 12);
+            inverted += (volume <= 0);
+            BMVector3 a = layout.node[layout.member[m].node[0]];
+            BMVector3 b = layout.node[layout.member[m].node[1]];
+            double expected = depth * width * BMVector3Length(BMVector3Subtract(b, a)) * config.scale;
+            wrong_volume += (fabs(volume - expected) > 1e-3 * expected);
+        }
+
+        /* Outer face then inner face of each panel */
+        for (int p = 0; p < BM11_FRAME_PANELS; p++) {
+            for (int face = 0; face < 2; face++) {
+                const uint32_t *t = mesh.triangle[mesh.member_triangle_count + 2 * p + face];
+                BMVector3 n = BMVector3CrossProduct(BMVector3Subtract(mesh.vertex[t[1]], mesh.vertex[t[0]]),
+                                                    BMVector3Subtract(mesh.vertex[t[2]], mesh.vertex[t[0]]));
+                float facing = BMVector3DotProduct(n, layout.panel_normal[p]);
+                wrong_faces += face ? (facing >= 0) : (facing <= 0);
+            }
+        }
+    }
+    printf("%d meshes: %d open prisms, %d inverted, %d wrong volumes, %d misfacing mirrors\n",
+           built, open, inverted, wrong_volume, wrong_faces);
+    BM11_CHECK(built > DESIGN_COUNT / 2);
+    BM11_CHECK(open == 0 && inverted == 0 && wrong_volume == 0 && wrong_faces == 0);
+}
+
+static void testWriters(void)
+{
+    BM11MeshConfig config;
+    BM11MeshConfigInit(&config);
+    BM11Model model;
+    BM11Model::InputParameters  input  = model.getInputParameters();
+    BM11Model::OutputParameters output = model.getOutputParameters();
+    BM11_CHECK(BM11MeshBuild(&config, &input, &output, &mesh));
+
+    /* A small buffer forces flushes in the middle of a mesh */
+    BM11MeshWriter stl(4096);
+    BM11_CHECK(stl.open(STL_PATH, BM11MeshSTL));
+    for (int i = 0; i < 3; i++) {
+        stl.append(&mesh, NULL);
+    }
+    BM11_CHECK(stl.close());
+    BM11_CHECK(stl.getTriangleCount() == 3 * mesh.triangle_count);
+
+    FILE *file = fopen(STL_PATH, "rb");
+    BM11_CHECK(file != NULL);
+    if (file) {
+        uint32_t count = 0;
+        fseek(file, 80, SEEK_SET);
+        BM11_CHECK(fread(&count, sizeof(count), 1, file) == 1 && count == 3 * mesh.triangle_count);
+        fseek(file, 0, SEEK_END);
+        BM11_CHECK(ftell(file) == 84 + 50 * (long)count);
+        fclose(file);
+    }
+    unlink(STL_PATH);
+
+    BM11MeshWriter obj(4096);
+    BM11_CHECK(obj.open(OBJ_PATH, BM11MeshOBJ));
+    obj.append(&mesh, "first");
+    obj.append(&mesh, "second");
+    BM11_CHECK(obj.close());
+
+    file = fopen(OBJ_PATH, "r");
+    BM11_CHECK(file != NULL);
+    if (file) {
+        char     line[256];
+        uint32_t vertices = 0, faces = 0, objects = 0, bad_index = 0;
+        while (fgets(line, sizeof(line), file)) {
+            if (line[0] == 'v' && line[1] == ' ') {
+                vertices++;
+            } else if (line[0] == 'f' && line[1] == ' ') {
+                char *p = line + 1;
+                for (int k = 0; k < 3; k++) {
+                    unsigned long index = strtoul(p, &p, 10);
+                    bad_index += (index < 1 || index > vertices);
+                }
+                faces++;
+            } else if (line[0] == 'o' && line[1] == ' ') {
+                objects++;
+            }
+        }
+        fclose(file);
+        BM11_CHECK(vertices == 2 * mesh.vertex_count && faces == 2 * mesh.triangle_count);
+        BM11_CHECK(objects == 2 && bad_index == 0);
+    }
+    unlink(OBJ_PATH);
+}
+
+int main(void)
+{
+    testMeshes();
+    testWriters();
+    return BM11TestFinish("BM11MeshTests");
+}
@@ -0,0 +1,158 @@
+#include <math.h>
+#include <string.h>
+#include "BM11Fields.h"
+#include "BM11Model.h"
+#include "BM11Test.h"
+
+/*
+   Staged evaluation: a model edited one field at a time re-runs only the
+   dirty stages and still matches a freshly built model bit for bit.
+
+   Feasibility: the algebraic pre-check and the law of sines agree with the
+   geometry, accepted designs have finite outputs and a positive volume,
+   rejected ones are zeroed.
+ */
+
+#define EDIT_COUNT 20000
+
+static bool sameOutputs(BM11Model *model, const BM11Model::InputParameters *input)
+{
+    BM11Model fresh;
+    fresh.setInputParameters(*input);
+    BM11Model::OutputParameters expected = fresh.getOutputParameters();
+    BM11Model::OutputParameters actual   = model->getOutputParameters();
+    return model->getStatus() == fresh.getStatus() && memcmp(&actual, &expected, sizeof(actual)) == 0;
+}
+
+static void testStagedEdits(void)
+{
+    BM11Model::InputParameters defaults = BM11Model::getDefaultInputParameters();
+    BM11Model model;
+    uint64_t  state = 4;
+    int       mismatches = 0;
+
+    for (int e = 0; e < EDIT_COUNT; e++) {
+        int   field = (int)(BM11TestRandom(&state) * BM11InputField_Count);
+        float value = BM11GetInputField(&defaults, field) * (float)(0.5 + BM11TestRandom(&state));
+        model.setInputParameter(field, value);
+        BM11Model::InputParameters input = model.getInputParameters();
+        BM11_CHECK(BM11GetInputField(&input, field) == value);
+
+        /* Read back after most edits, so some edits pile up dirty stages */
+        if ((e % 4) != 3 && !sameOutputs(&model, &input)) {
+            mismatches++;
+        }
+    }
+    BM11_CHECK(mismatches == 0);
+
+    /* Whole-struct edits, including ones that change nothing */
+    uint64_t rstate = 5;
+    mismatches = 0;
+    for (int e = 0; e < 2000; e++) {
+        BM11Model::InputParameters input = BM11TestRandomInputs(&rstate);
+        model.setInputParameters(input);
+        if (!sameOutputs(&model, &input)) {
+            mismatches++;
+        }
+        model.setInputParameters(input);
+        if (!sameOutputs(&model, &input)) {
+            mismatches++;
+        }
+    }
+    BM11_CHECK(mismatches == 0);
+}
+
+static void testStageGraph(void)
+{
+    const unsigned all = BM11Model::AllStages;
+    BM11_CHECK(BM11Model::getStagesAffectedBy(BM11InputField_squareSideLength) == all);
+    BM11_CHECK(BM11Model::getStagesAffectedBy(BM11InputField_angle_ABC) == all);
+
+    unsigned mirror = BM11Model::getStagesAffectedBy(BM11InputField_unit_cost_mirror);
+    BM11_CHECK(mirror & (1u << BM11Model::StageMirror));
+    BM11_CHECK(mirror & (1u << BM11Model::StageTotals));
+    BM11_CHECK(!(mirror & (1u << BM11Model::StageEdges)));
+    BM11_CHECK(!(mirror & (1u << BM11Model::StageFrame)));
+
+    unsigned frame = BM11Model::getStagesAffectedBy(BM11InputField_unit_cost_frameMetal);
+    BM11_CHECK(frame & (1u << BM11Model::StageFrame));
+    BM11_CHECK(!(frame & (1u << BM11Model::StageVertexCoords)));
+
+    /* Every field feeds the totals */
+    for (int f = 0; f < BM11InputField_Count; f++) {
+        unsigned stages = BM11Model::getStagesAffectedBy(f);
+        BM11_CHECK(stages != 0);
+        BM11_CHECK(stages & (1u << BM11Model::StageTotals));
+    }
+}
+
+static void testFeasibility(void)
+{
+    int      status_count[BM11Model::StatusCount] = { 0 };
+    uint64_t state = 7;
+
+    for (int d = 0; d < 20000; d++) {
+        BM11Model::InputParameters input = BM11TestRandomInputs(&state);
+        input.baseCutBackLength = (float)(input.squareSideLength * 1.2 * BM11TestRandom(&state));
+        input.angle_ABC         = (float)(M_PI * BM11TestRandom(&state));
+
+        BM11Model model;
+        model.setInputParameters(input);
+        BM11Model::OutputParameters output = model.getOutputParameters();
+        BM11Model::Status status = model.getStatus();
+        BM11Model::Status pre    = BM11Model::checkFeasibility(&input);
+        status_count[status]++;
+
+        if (pre != BM11Model::StatusOK) {
+            BM11_CHECK(status == pre);
+        } else {
+            BM11_CHECK(status == BM11Model::StatusOK || status == BM11Model::StatusLawOfSines);
+        }
+
+        if (status != BM11Model::StatusOK) {
+            int nonzero = 0;
+            for (int f = BM11OutputField_vertex_coord_A0_x; f < BM11OutputField_Count; f++) {
+                nonzero += (BM11GetOutputField(&output, f) != 0.0f);
+            }
+            BM11_CHECK(nonzero == 0);
+            continue;
+        }
+
+        int nonfinite = 0;
+        for (int f = 0; f < BM11OutputField_Count; f++) {
+            nonfinite += !isfinite(BM11GetOutputField(&output, f));
+        }
+        BM11_CHECK(nonfinite == 0);
+
+        BMVector3 OA = BMVector3Subtract(output.vertex_coord.A0, output.vertex_coord.O);
+        BMVector3 OB = BMVector3Subtract(output.vertex_coord.B0, output.vertex_coord.O);
+        BMVector3 OC = BMVector3Subtract(output.vertex_coord.C0, output.vertex_coord.O);
+        double volume = fabs(BMVector3DotProduct(OA, BMVector3CrossProduct(OB, OC))) / 6;
+        BM11_CHECK(volume > 0);
+    }
+
+    /* The sample reaches the pre-check failures and accepts a good share */
+    BM11_CHECK(status_count[BM11Model::StatusOK] > 1000);
+    BM11_CHECK(status_count[BM11Model::StatusNonPositiveEdge] > 0);
+    BM11_CHECK(status_count[BM11Model::StatusTriangleInequality] + status_count[BM11Model::StatusDegenerateVolume] > 0);
+
+    BM11Model::InputParameters input = BM11Model::getDefaultInputParameters();
+    input.baseCutBackLength = input.squareSideLength;
+    BM11_CHECK(BM11Model::checkFeasibility(&input) == BM11Model::StatusNonPositiveEdge);
+
+    for (int s = 0; s < BM11Model::StatusCount; s++) {
+        const char *name = BM11Model::getStatusString((BM11Model::Status)s);
+        BM11_CHECK(name != NULL && name[0] != '\0');
+        for (int t = 0; t < s; t++) {
+            BM11_CHECK(strcmp(name, BM11Model::getStatusString((BM11Model::Status)t)) != 0);
+        }
+    }
+}
+
+int main(void)
+{
+    testStagedEdits();
+    testStageGraph();
+    testFeasibility();
+    return BM11TestFinish("BM11ModelTests");
+}
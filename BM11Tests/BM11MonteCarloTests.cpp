@@ -0,0 +1,144 @@
+#include <math.h>
+#include <string.h>
+#include "BM11Fields.h"
+#include "BM11Model.h"
+#include "BM11MonteCarlo.h"
+#include "BM11Test.h"
+
+/*
+   BM11RunMonteCarlo(): results are reproducible from the seed on any
+   thread count, fixed inputs reproduce the base design, an output list
+   longer than BM11_MONTE_CARLO_MAX_OUTPUTS is clamped and a repeated field
+   gets the same statistics as its first listing. BM11QuantileSketch keeps
+   its relative accuracy.
+ */
+
+static void setupConfig(BM11MonteCarloConfig *config)
+{
+    BM11MonteCarloConfigInit(config);
+    config->sample_count = 20000;
+    config->distribution[BM11InputField_squareSideLength]  = BM11DistributionMakeNormal(16.0f, 0.05f);
+    config->distribution[BM11InputField_baseCutBackLength] = BM11DistributionMakeTriangular(1.9f, 2.0f, 2.2f);
+    config->distribution[BM11InputField_unit_cost_mirror]  = BM11DistributionMakeUniform(5.0f, 8.0f);
+}
+
+static bool sameOutput(const BM11MonteCarloOutput *a, const BM11MonteCarloOutput *b, double tolerance)
+{
+    return a->field == b->field && a->count == b->count &&
+           a->min == b->min && a->max == b->max &&
+           a->p05 == b->p05 && a->p50 == b->p50 && a->p95 == b->p95 && a->p99 == b->p99 &&
+           fabs(a->mean - b->mean) <= tolerance * fabs(a->mean) &&
+           fabs(a->stddev - b->stddev) <= tolerance * a->stddev;
+}
+
+static void testThreadCounts(void)
+{
+    BM11MonteCarloConfig config;
+    setupConfig(&config);
+    config.thread_count = 1;
+    BM11MonteCarloResult one = BM11RunMonteCarlo(&config);
+    config.thread_count = 4;
+    BM11MonteCarloResult four = BM11RunMonteCarlo(&config);
+
+    BM11_CHECK(one.samples == 20000 && one.output_count == config.output_count);
+    BM11_CHECK(memcmp(one.status_count, four.status_count, sizeof(one.status_count)) == 0);
+    uint64_t statuses = 0;
+    for (int s = 0; s < BM11Model::StatusCount; s++) {
+        statuses += one.status_count[s];
+    }
+    BM11_CHECK(statuses == one.samples);
+
+    /* Only the moment merge order differs between thread counts */
+    for (int o = 0; o < one.output_count; o++) {
+        const BM11MonteCarloOutput *out = &one.output[o];
+        BM11_CHECK(sameOutput(out, &four.output[o], 1e-9));
+        BM11_CHECK(out->count == one.status_count[BM11Model::StatusOK]);
+        BM11_CHECK(out->min <= out->p05 && out->p05 <= out->p50 && out->p50 <= out->p95 &&
+                   out->p95 <= out->p99 && out->p99 <= out->max);
+    }
+    BM11_CHECK(one.output[0].stddev > 0);
+
+    config.seed++;
+    BM11MonteCarloResult other = BM11RunMonteCarlo(&config);
+    BM11_CHECK(other.output[0].mean != one.output[0].mean);
+}
+
+static void testFixed(void)
+{
+    BM11MonteCarloConfig config;
+    BM11MonteCarloConfigInit(&config);
+    config.sample_count = 3000;
+    BM11MonteCarloResult result = BM11RunMonteCarlo(&config);
+
+    BM11Model model;
+    BM11Model::OutputParameters base = model.getOutputParameters();
+    for (int o = 0; o < result.output_count; o++) {
+        const BM11MonteCarloOutput *out = &result.output[o];
+        double value = BM11GetOutputField(&base, out->field);
+        BM11_CHECK(out->count == 3000 && out->stddev == 0.0);
+        BM11_CHECK(out->min == out->max && out->p05 == out->min && out->p99 == out->min);
+        BM11_CHECK_NEAR(out->mean, value, 1e-5 * fmax(fabs(value), 1.0));
+    }
+}
+
+static void testOutputList(void)
+{
+    BM11MonteCarloConfig config;
+    setupConfig(&config);
+    config.thread_count = 1;
+    BM11MonteCarloResult defaults = BM11RunMonteCarlo(&config);
+
+    /* Past the maximum: the extra entries are ignored */
+    for (int o = 0; o < BM11_MONTE_CARLO_MAX_OUTPUTS; o++) {
+        config.output[o] = BM11OutputField_Count - 1 - o;
+    }
+    config.output[0]    = BM11OutputField_total_cost;
+    config.output_count = 10 * BM11_MONTE_CARLO_MAX_OUTPUTS;
+    BM11MonteCarloResult clamped = BM11RunMonteCarlo(&config);
+    BM11_CHECK(clamped.output_count == BM11_MONTE_CARLO_MAX_OUTPUTS);
+    BM11_CHECK(sameOutput(&clamped.output[0], &defaults.output[0], 0.0));
+    for (int o = 0; o < clamped.output_count; o++) {
+        BM11_CHECK(clamped.output[o].count == defaults.output[0].count);
+    }
+
+    /* Repeats: every listing of a field gets that field's statistics */
+    static const int repeated[] = {
+        BM11OutputField_total_cost, BM11OutputField_total_mass, BM11OutputField_total_cost,
+        BM11OutputField_total_mass, BM11OutputField_total_cost,
+    };
+    memcpy(config.output, repeated, sizeof(repeated));
+    config.output_count = sizeof(repeated) / sizeof(repeated[0]);
+    BM11MonteCarloResult duplicates = BM11RunMonteCarlo(&config);
+    BM11_CHECK(duplicates.output_count == 5);
+    BM11_CHECK(sameOutput(&duplicates.output[0], &defaults.output[0], 0.0));
+    BM11_CHECK(sameOutput(&duplicates.output[1], &defaults.output[1], 0.0));
+    BM11_CHECK(sameOutput(&duplicates.output[2], &defaults.output[0], 0.0));
+    BM11_CHECK(sameOutput(&duplicates.output[3], &defaults.output[1], 0.0));
+    BM11_CHECK(sameOutput(&duplicates.output[4], &defaults.output[0], 0.0));
+}
+
+static void testSketch(void)
+{
+    const double       accuracy = 0.01;
+    BM11QuantileSketch a(accuracy), b(accuracy);
+    for (int i = 1; i <= 100000; i++) {
+        double value = (i % 2) ? (double)i : -(double)i * 1e-3;
+        ((i % 3) ? a : b).add(value);
+    }
+    a.merge(b);
+    BM11_CHECK(a.getCount() == 100000);
+
+    /* The negative half runs -100 .. -0.002, the positive half 1 .. 99999 */
+    BM11_CHECK_NEAR(a.getQuantile(0.25), -50.0, 50.0 * accuracy + 0.01);
+    BM11_CHECK_NEAR(a.getQuantile(0.75), 50000.0, 50000.0 * accuracy + 2.0);
+    BM11_CHECK_NEAR(a.getQuantile(1.0), 99999.0, 99999.0 * accuracy);
+}
+
+int main(void)
+{
+    testThreadCounts();
+    testFixed();
+    testOutputList();
+    testSketch();
+    return BM11TestFinish("BM11MonteCarloTests");
+}
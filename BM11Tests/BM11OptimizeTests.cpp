@@ -0,0 +1,85 @@
+#include <math.h>
+#include <string.h>
+#include "BM11Fields.h"
+#include "BM11Model.h"
+#include "BM11Optimize.h"
+#include "BM11Test.h"
+
+/*
+   BM11RunOptimize(): the constrained demo problem gives the same feasible
+   design on any thread count, no worse than the base design and within
+   the box; with no variables the base design comes back as is.
+ */
+
+static void setupProblem(BM11OptimizeConfig *config)
+{
+    BM11OptimizeConfigInit(config);
+    config->start_count     = 8;
+    config->max_evaluations = 600;
+    BM11OptimizeAddVariable(config, BM11InputField_squareSideLength, 8.0f, 24.0f);
+    BM11OptimizeAddVariable(config, BM11InputField_baseCutBackLength, 0.0f, 6.0f);
+    BM11OptimizeAddVariable(config, BM11InputField_angle_ABC,
+                            BMMathDegreesToRadians(90.0f), BMMathDegreesToRadians(150.0f));
+    BM11OptimizeAddConstraint(config, BM11OutputField_overall_structure_walkway_shoulder_width, BM11ConstraintAtLeast, 4.5f);
+    BM11OptimizeAddConstraint(config, BM11OutputField_overall_structure_height, BM11ConstraintAtLeast, 14.0f);
+    BM11OptimizeAddConstraint(config, BM11OutputField_overall_structure_footprint_area, BM11ConstraintAtMost, 600.0f);
+}
+
+static void testProblem(void)
+{
+    BM11OptimizeConfig config;
+    setupProblem(&config);
+    config.thread_count = 1;
+    BM11OptimizeResult one = BM11RunOptimize(&config);
+    config.thread_count = 3;
+    BM11OptimizeResult three = BM11RunOptimize(&config);
+
+    BM11_CHECK(memcmp(&one.input, &three.input, sizeof(one.input)) == 0);
+    BM11_CHECK(one.objective == three.objective && one.evaluations == three.evaluations);
+    BM11_CHECK(one.starts_feasible == three.starts_feasible);
+
+    BM11_CHECK(one.feasible && one.violation == 0.0);
+    BM11_CHECK(one.output.overall_structure.walkway_shoulder_width >= 4.5f);
+    BM11_CHECK(one.output.overall_structure.height >= 14.0f);
+    BM11_CHECK(one.output.overall_structure.footprint_area <= 600.0f);
+    BM11_CHECK(one.objective == one.output.total.cost);
+    for (int v = 0; v < config.variable_count; v++) {
+        float value = BM11GetInputField(&one.input, config.variable[v].field);
+        BM11_CHECK(value >= config.variable[v].min && value <= config.variable[v].max);
+    }
+
+    /* The result is a real design, not just a score */
+    BM11Model model;
+    model.setInputParameters(one.input);
+    BM11_CHECK(model.getStatus() == BM11Model::StatusOK);
+    BM11_CHECK(model.getOutputParameters().total.cost == one.output.total.cost);
+}
+
+static void testNoVariables(void)
+{
+    BM11OptimizeConfig config;
+    BM11OptimizeConfigInit(&config);
+    config.thread_count = 2;
+    BM11OptimizeResult result = BM11RunOptimize(&config);
+
+    BM11Model model;
+    BM11Model::OutputParameters base = model.getOutputParameters();
+    BM11Model::InputParameters  defaults = BM11Model::getDefaultInputParameters();
+    BM11_CHECK(memcmp(&result.input, &defaults, sizeof(defaults)) == 0);
+    BM11_CHECK(memcmp(&result.output, &base, sizeof(base)) == 0);
+    BM11_CHECK(result.feasible && result.objective == base.total.cost);
+    BM11_CHECK(result.evaluations == 1 && result.starts_feasible == 1);
+
+    /* An unmet constraint still reports the base design, as infeasible */
+    BM11OptimizeAddConstraint(&config, BM11OutputField_overall_structure_height, BM11ConstraintAtLeast, 1000.0f);
+    result = BM11RunOptimize(&config);
+    BM11_CHECK(!result.feasible && result.violation > 0.0);
+    BM11_CHECK(memcmp(&result.output, &base, sizeof(base)) == 0);
+}
+
+int main(void)
+{
+    testProblem();
+    testNoVariables();
+    return BM11TestFinish("BM11OptimizeTests");
+}
@@ -0,0 +1,216 @@
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include "BM11Fields.h"
+#include "BM11Model.h"
+#include "BM11Pareto.h"
+#include "BM11Sweep.h"
+#include "BM11Test.h"
+
+/*
+   BM11ParetoFront against an O(n^2) brute-force filter with 2 to 4
+   objectives, with and without a resolution grid: the same front in any
+   insertion order, after merging, and from a multi-threaded
+   BM11RunParetoSweep(). Rejected designs never join the front.
+ */
+
+#define DESIGN_COUNT 3000
+
+static const BM11ParetoObjective allObjectives[] = {
+    { BM11OutputField_total_cost,                       BM11ParetoMinimize, 0.0f },
+    { BM11OutputField_overall_structure_height,         BM11ParetoMaximize, 0.0f },
+    { BM11OutputField_overall_structure_footprint_area, BM11ParetoMinimize, 0.0f },
+    { BM11OutputField_total_mass,                       BM11ParetoMinimize, 0.0f },
+};
+
+typedef struct {
+    std::vector<BM11Model::InputParameters>  input;
+    std::vector<BM11Model::OutputParameters> output;
+    std::vector<BM11Model::Status>           status;
+} Designs;
+
+/* Minimized key of one objective, as the front compares it */
+static float objectiveKey(const BM11ParetoObjective *objective, const BM11Model::OutputParameters *output)
+{
+    float v = BM11GetOutputField(output, objective->field);
+    if (objective->sense == BM11ParetoMaximize) {
+        v = -v;
+    }
+    if (objective->resolution > 0.0f) {
+        v = floorf(v / objective->resolution);
+    }
+    return v;
+}
+
+/* Design j is out if another design is at least as good everywhere and
+   either better somewhere or tied with a lower index */
+static std::vector<uint64_t> bruteForceFront(const Designs *designs, const BM11ParetoObjective *objectives, int count)
+{
+    size_t n = designs->input.size();
+    std::vector<float> key(n * count);
+    for (size_t i = 0; i < n; i++) {
+        for (int d = 0; d < count; d++) {
+            key[i * count + d] = objectiveKey(&objectives[d], &designs->output[i]);
+        }
+    }
+
+    std::vector<uint64_t> front;
+    for (size_t j = 0; j < n; j++) {
+        if (designs->status[j] != BM11Model::StatusOK) {
+            continue;
+        }
+        bool beaten = false;
+        for (size_t i = 0; (i < n) && !beaten; i++) {
+            if ((i == j) || (designs->status[i] != BM11Model::StatusOK)) {
+                continue;
+            }
+            bool no_worse = true, better = false;
+            for (int d = 0; d < count; d++) {
+                no_worse = no_worse && (key[i * count + d] <= key[j * count + d]);
+                better   = better   || (key[i * count + d] <  key[j * count + d]);
+            }
+            beaten = no_worse && (better || (i < j));
+        }
+        if (!beaten) {
+            front.push_back(j);
+        }
+    }
+    return front;
+}
+
+static std::vector<uint64_t> frontIndices(const BM11ParetoFront *front)
+{
+    std::vector<BM11ParetoPoint> points;
+    front->getPoints(&points);
+    std::vector<uint64_t> indices;
+    for (size_t p = 0; p < points.size(); p++) {
+        indices.push_back(points[p].index);
+    }
+    return indices;
+}
+
+static void testBruteForce(const Designs *designs)
+{
+    for (int count = 2; count <= 4; count++) {
+        for (int grid = 0; grid < 2; grid++) {
+            BM11ParetoObjective objectives[4];
+            memcpy(objectives, allObjectives, sizeof(objectives));
+            if (grid) {
+                objectives[0].resolution = 25.0f;
+                objectives[1].resolution = 0.25f;
+                objectives[2].resolution = 5.0f;
+                objectives[3].resolution = 10.0f;
+            }
+            std::vector<uint64_t> expected = bruteForceFront(designs, objectives, count);
+
+            /* Forwards, backwards, and split in two then merged */
+            BM11ParetoFront forwards(objectives, count), backwards(objectives, count);
+            BM11ParetoFront odd(objectives, count), even(objectives, count);
+            for (size_t i = 0; i < DESIGN_COUNT; i++) {
+                size_t r = DESIGN_COUNT - 1 - i;
+                forwards.insert(i, &designs->input[i], &designs->output[i], designs->status[i]);
+                backwards.insert(r, &designs->input[r], &designs->output[r], designs->status[r]);
+                ((i % 2) ? odd : even).insert(i, &designs->input[i], &designs->output[i], designs->status[i]);
+            }
+            odd.merge(even);
+
+            BM11_CHECK(expected.size() > 1);
+            BM11_CHECK(frontIndices(&forwards) == expected);
+            BM11_CHECK(frontIndices(&backwards) == expected);
+            BM11_CHECK(frontIndices(&odd) == expected);
+            BM11_CHECK(forwards.getSize() == expected.size());
+            BM11_CHECK(forwards.getInsertCount() >= expected.size());
+        }
+    }
+}
+
+static void testRejected(const Designs *designs)
+{
+    BM11ParetoFront front(allObjectives, 3);
+    for (size_t i = 0; i < DESIGN_COUNT; i++) {
+        front.insert(i, &designs->input[i], &designs->output[i], designs->status[i]);
+    }
+    std::vector<uint64_t> before = frontIndices(&front);
+
+    /* Zeroed outputs would beat every real design on cost and footprint */
+    BM11Model::InputParameters bad = BM11Model::getDefaultInputParameters();
+    bad.squareSideLength = -1.0f;
+    BM11Model model;
+    model.setInputParameters(bad);
+    BM11Model::OutputParameters zeroed = model.getOutputParameters();
+    BM11_CHECK(model.getStatus() != BM11Model::StatusOK && zeroed.total.cost == 0.0f);
+    BM11_CHECK(!front.insert(DESIGN_COUNT, &bad, &zeroed, model.getStatus()));
+    BM11_CHECK(frontIndices(&front) == before);
+
+    /* Non-finite objectives are ignored too */
+    BM11Model::OutputParameters output = designs->output[before[0]];
+    output.total.cost = NAN;
+    BM11_CHECK(!front.insert(DESIGN_COUNT + 1, &designs->input[before[0]], &output, BM11Model::StatusOK));
+    BM11_CHECK(frontIndices(&front) == before);
+}
+
+static void recordDesign(void *context, uint64_t index,
+                         const BM11Model::InputParameters  *input,
+                         const BM11Model::OutputParameters *output,
+                         BM11Model::Status status, int thread_index)
+{
+    (void)thread_index;
+    Designs *designs = (Designs *)context;
+    designs->input[index]  = *input;
+    designs->output[index] = *output;
+    designs->status[index] = status;
+}
+
+static void testSweep(void)
+{
+    BM11SweepConfig config;
+    BM11SweepConfigInit(&config);
+    config.print_profile = false;
+    config.grain         = 9;
+    BM11SweepAddAxis(&config, BM11InputField_squareSideLength, 6.0f, 24.0f, 19);
+    BM11SweepAddAxis(&config, BM11InputField_baseCutBackLength, 0.0f, 8.0f, 17);
+    BM11SweepAddAxis(&config, BM11InputField_angle_ABC, 1.4f, 2.6f, 13);
+    uint64_t count = BM11SweepDesignCount(&config);
+
+    Designs designs;
+    designs.input.resize(count);
+    designs.output.resize(count);
+    designs.status.resize(count);
+    config.thread_count   = 1;
+    config.result         = recordDesign;
+    config.result_context = &designs;
+    BM11RunSweep(&config);
+    std::vector<uint64_t> expected = bruteForceFront(&designs, allObjectives, 3);
+
+    for (int threads = 1; threads <= 4; threads += 3) {
+        BM11ParetoFront front(allObjectives, 3);
+        config.thread_count = threads;
+        BM11RunParetoSweep(&config, &front);
+        BM11_CHECK(frontIndices(&front) == expected);
+    }
+}
+
+int main(void)
+{
+    Designs  designs;
+    uint64_t state = 14;
+    int      rejected = 0;
+    for (int d = 0; d < DESIGN_COUNT; d++) {
+        BM11Model::InputParameters input = BM11TestRandomInputs(&state);
+        if ((d % 11) == 0) {
+            input.baseCutBackLength = input.squareSideLength;
+        }
+        BM11Model model;
+        model.setInputParameters(input);
+        designs.input.push_back(input);
+        designs.output.push_back(model.getOutputParameters());
+        designs.status.push_back(model.getStatus());
+        rejected += (model.getStatus() != BM11Model::StatusOK);
+    }
+    BM11_CHECK(rejected > 0);
+
+    testBruteForce(&designs);
+    testRejected(&designs);
+    testSweep();
+    return BM11TestFinish("BM11ParetoTests");
+}
@@ -0,0 +1,129 @@
+#include <math.h>
+#include <vector>
+#include "BM11Model.h"
+#include "BM11Procurement.h"
+#include "BM11Test.h"
+#include "BM11Truss.h"
+
+/*
+   BM11ProcurementEvaluate(): every cut list fits its stock lengths and
+   reaches no fewer lengths or sheets than the lower bounds, costs follow
+   from the counts, results don't depend on the thread count, batches and
+   the optimizer hook agree with single evaluations, and rejected designs
+   are refused.
+ */
+
+#define DESIGN_COUNT 60
+
+static bool sameResult(const BM11ProcurementResult *a, const BM11ProcurementResult *b)
+{
+    bool same = a->cost == b->cost && a->frame.bar_count == b->frame.bar_count &&
+                a->frame.largest_offcut == b->frame.largest_offcut &&
+                a->mirror.sheet_count == b->mirror.sheet_count && a->mirror.arrangement == b->mirror.arrangement &&
+                a->mirror.corner == b->mirror.corner && a->mirror.rotation == b->mirror.rotation &&
+                a->mirror.offset.x == b->mirror.offset.x && a->mirror.offset.y == b->mirror.offset.y;
+    for (int p = 0; same && (p < a->frame.piece_count); p++) {
+        same = a->frame.piece_bar[p] == b->frame.piece_bar[p];
+    }
+    return same;
+}
+
+/* Each remainder and its kerf fit in the length it is cut from */
+static bool cutsFit(const BM11ProcurementConfig *config, const BM11CutList *list)
+{
+    int full = 0;
+    for (int p = 0; p < list->piece_count; p++) {
+        full += list->piece_full[p];
+    }
+    std::vector<double> used(list->bar_count, 0.0);
+    for (int p = 0; p < list->piece_count; p++) {
+        int bar = list->piece_bar[p];
+        if (bar < full || bar >= list->bar_count) {
+            return false;
+        }
+        used[bar] += list->piece_length[p] + config->kerf;
+    }
+    for (int b = full; b < list->bar_count; b++) {
+        if (used[b] > config->stock_length * 12.0 + config->kerf + 1e-3) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(void)
+{
+    BM11ProcurementConfig config;
+    BM11ProcurementConfigInit(&config);
+    config.restarts = 4;
+
+    std::vector<BM11Model::InputParameters>  inputs;
+    std::vector<BM11Model::OutputParameters> outputs;
+    std::vector<BM11ProcurementResult>       results;
+    uint64_t state = 18;
+    int      wrong = 0, differ = 0, rejected = 0;
+
+    for (int d = 0; d < DESIGN_COUNT; d++) {
+        BM11Model::InputParameters input = BM11TestRandomInputs(&state);
+        if ((d % 7) == 0) {
+            input.baseCutBackLength = input.squareSideLength;
+        }
+        BM11Model model;
+        model.setInputParameters(input);
+        BM11Model::OutputParameters output = model.getOutputParameters();
+
+        BM11ProcurementResult one, three;
+        config.thread_count = 1;
+        bool ok = BM11ProcurementEvaluate(&config, &input, &output, &one);
+        if (model.getStatus() != BM11Model::StatusOK) {
+            BM11_CHECK(!ok);
+            rejected++;
+            continue;
+        }
+        BM11_CHECK(ok);
+        config.thread_count = 3;
+        BM11ProcurementEvaluate(&config, &input, &output, &three);
+        differ += !sameResult(&one, &three);
+
+        const BM11CutList      *frame  = &one.frame;
+        const BM11SheetNesting *mirror = &one.mirror;
+        BM11FrameLayout layout;
+        BM11FrameLayoutBuild(&config.frame, &output, &layout);
+        double sheet_area = config.sheet.x * config.sheet.y;
+
+        wrong += !cutsFit(&config, frame);
+        wrong += (frame->piece_count != layout.member_count);
+        wrong += (frame->bar_count < frame->lower_bound || mirror->sheet_count < mirror->lower_bound);
+        wrong += (fabs(frame->waste_length - (frame->bar_count * config.stock_length - frame->member_length)) > 1e-3);
+        wrong += (fabs(frame->cost - frame->bar_count * config.stock_length * input.unit_cost.frameMetal) > 1e-3 * frame->cost);
+        wrong += (fabs(mirror->cost - mirror->sheet_count * sheet_area * input.unit_cost.mirror) > 1e-3 * mirror->cost);
+        wrong += (fabs(mirror->waste_area - (mirror->sheet_count * sheet_area - mirror->mirror_area)) > 1e-2);
+        wrong += (fabs(mirror->mirror_area - output.mirror.surface_area) > 1e-3 * output.mirror.surface_area);
+        wrong += (fabs(one.cost - (frame->cost + mirror->cost)) > 1e-3 * one.cost);
+
+        /* The optimizer hook swaps in the bought costs */
+        BM11Model::OutputParameters adjusted = output;
+        config.thread_count = 1;
+        BM11ProcurementAdjustCosts(&config, &input, &adjusted);
+        wrong += (adjusted.frame.metal_cost != frame->cost || adjusted.mirror.cost != mirror->cost);
+        wrong += (fabs(adjusted.total.cost - (output.total.cost + one.cost - one.estimate_cost)) > 1e-3 * output.total.cost);
+
+        inputs.push_back(input);
+        outputs.push_back(output);
+        results.push_back(one);
+    }
+    BM11_CHECK(rejected > 0 && inputs.size() > DESIGN_COUNT / 2);
+    BM11_CHECK(wrong == 0);
+    BM11_CHECK(differ == 0);
+
+    std::vector<BM11ProcurementResult> batch(inputs.size());
+    config.thread_count = 1;
+    BM11ProcurementEvaluateBatch(&config, &inputs[0], &outputs[0], inputs.size(), &batch[0], 4);
+    differ = 0;
+    for (size_t d = 0; d < inputs.size(); d++) {
+        differ += !sameResult(&batch[d], &results[d]);
+    }
+    BM11_CHECK(differ == 0);
+
+    return BM11TestFinish("BM11ProcurementTests");
+}
@@ -0,0 +1,79 @@
+#include "BM11Fields.h"
+#include "BM11Model.h"
+#include "BM11Profile.h"
+#include "BM11ResultCache.h"
+#include "BM11Test.h"
+
+/*
+   BM11_PROFILE counters: a rejection is counted once per design the edges
+   and validation stages (or a cache hit standing in for them) reject, not
+   again for cost-only edits of an already rejected design.
+ */
+
+static uint64_t counterSince(const BM11ProfileStats *before, BM11ProfileCounter counter)
+{
+    BM11ProfileStats after, delta;
+    BM11ProfileGetStats(&after);
+    BM11ProfileSubtract(&after, before, &delta);
+    return delta.counter[counter];
+}
+
+static void testRejections(void)
+{
+    BM11ProfileStats before;
+    BM11ProfileGetStats(&before);
+
+    BM11Model::InputParameters bad = BM11Model::getDefaultInputParameters();
+    bad.squareSideLength = -1.0f;
+    BM11Model model;
+    model.setInputParameters(bad);
+    model.getOutputParameters();
+    BM11_CHECK(model.getStatus() != BM11Model::StatusOK);
+    BM11_CHECK(counterSince(&before, BM11ProfileValidationFailures) == 1);
+
+    /* Cost-only edits re-evaluate but don't reject anything new */
+    for (int e = 0; e < 5; e++) {
+        model.setInputParameter(BM11InputField_unit_cost_mirror, 5.0f + e);
+        model.getOutputParameters();
+    }
+    BM11_CHECK(counterSince(&before, BM11ProfileEvaluations) == 6);
+    BM11_CHECK(counterSince(&before, BM11ProfileValidationFailures) == 1);
+
+    /* A geometry edit checks again */
+    model.setInputParameter(BM11InputField_squareSideLength, -2.0f);
+    model.getOutputParameters();
+    BM11_CHECK(counterSince(&before, BM11ProfileValidationFailures) == 2);
+
+    model.setInputParameters(BM11Model::getDefaultInputParameters());
+    model.getOutputParameters();
+    BM11_CHECK(model.getStatus() == BM11Model::StatusOK);
+    BM11_CHECK(counterSince(&before, BM11ProfileValidationFailures) == 2);
+}
+
+static void testCachedRejections(void)
+{
+    BM11ResultCache cache(64);
+    BM11Model::InputParameters bad = BM11Model::getDefaultInputParameters();
+    bad.squareSideLength = -1.0f;
+
+    BM11ProfileStats before;
+    BM11ProfileGetStats(&before);
+    for (int m = 0; m < 3; m++) {
+        BM11Model model;
+        model.setResultCache(&cache);
+        model.setInputParameters(bad);
+        model.getOutputParameters();
+        BM11_CHECK(model.getStatus() != BM11Model::StatusOK);
+    }
+    BM11_CHECK(counterSince(&before, BM11ProfileCacheMisses) == 1);
+    BM11_CHECK(counterSince(&before, BM11ProfileCacheHits) == 2);
+    BM11_CHECK(counterSince(&before, BM11ProfileValidationFailures) == 3);
+}
+
+int main(void)
+{
+    BM11_CHECK(BM11ProfileEnabled());
+    testRejections();
+    testCachedRejections();
+    return BM11TestFinish("BM11ProfileTests");
+}
@@ -0,0 +1,134 @@
+#include <string.h>
+#include <vector>
+#include "BM11Model.h"
+#include "BM11ResultCache.h"
+#include "BM11Sweep.h"
+#include "BM11Test.h"
+
+/*
+   BM11ResultCache: exact and quantized keys, statuses, eviction within
+   capacity, and a shared cache under a multi-threaded sweep giving the
+   same results as no cache.
+ */
+
+static void storeCost(void *context, uint64_t index,
+                      const BM11Model::InputParameters  *input,
+                      const BM11Model::OutputParameters *output,
+                      BM11Model::Status status, int thread_index)
+{
+    (void)input;
+    (void)status;
+    (void)thread_index;
+    ((float *)context)[index] = output->total.cost;
+}
+
+static void testLookup(void)
+{
+    BM11ResultCache cache(1024);
+    BM11Model::InputParameters  input = BM11Model::getDefaultInputParameters();
+    BM11Model::OutputParameters output;
+    BM11Model::Status           status;
+
+    BM11_CHECK(!cache.lookup(&input, &output, &status));
+
+    BM11Model model;
+    BM11Model::OutputParameters expected = model.getOutputParameters();
+    cache.insert(&input, &expected, model.getStatus());
+    BM11_CHECK(cache.lookup(&input, &output, &status));
+    BM11_CHECK(memcmp(&output, &expected, sizeof(output)) == 0 && status == BM11Model::StatusOK);
+
+    /* Exact keys by default */
+    BM11Model::InputParameters near = input;
+    near.squareSideLength = 16.001f;
+    BM11_CHECK(!cache.lookup(&near, &output, &status));
+
+    /* Rejected designs keep their status */
+    BM11Model::InputParameters bad = input;
+    bad.squareSideLength = -1.0f;
+    model.setInputParameters(bad);
+    BM11Model::OutputParameters rejected = model.getOutputParameters();
+    cache.insert(&bad, &rejected, model.getStatus());
+    BM11_CHECK(cache.lookup(&bad, &output, &status));
+    BM11_CHECK(status == model.getStatus() && status != BM11Model::StatusOK);
+
+    BM11ResultCache::Stats stats = cache.getStats();
+    BM11_CHECK(stats.hits == 2 && stats.misses == 2 && stats.entries == 2);
+    cache.clear();
+    BM11_CHECK(!cache.lookup(&input, &output, &status));
+}
+
+static void testTolerance(void)
+{
+    BM11ResultCache cache(1024);
+    cache.setTolerance(BM11InputField_squareSideLength, 0.01f);
+    BM11_CHECK(cache.getTolerance(BM11InputField_squareSideLength) == 0.01f);
+
+    BM11Model model;
+    model.setResultCache(&cache);
+    BM11Model::OutputParameters expected = model.getOutputParameters();
+
+    BM11Model::InputParameters near = BM11Model::getDefaultInputParameters();
+    near.squareSideLength = 16.001f;
+    model.setInputParameters(near);
+    BM11Model::OutputParameters output = model.getOutputParameters();
+    BM11_CHECK(memcmp(&output, &expected, sizeof(output)) == 0);
+    BM11_CHECK(cache.getStats().hits == 1);
+
+    near.squareSideLength = 16.02f;
+    model.setInputParameters(near);
+    output = model.getOutputParameters();
+    BM11_CHECK(output.total.cost != expected.total.cost);
+}
+
+static void testEviction(void)
+{
+    BM11ResultCache cache(64, 1);
+    uint64_t state = 6;
+    BM11Model model;
+    for (int i = 0; i < 1000; i++) {
+        BM11Model::InputParameters input = BM11TestRandomInputs(&state);
+        model.setInputParameters(input);
+        BM11Model::OutputParameters output = model.getOutputParameters();
+        cache.insert(&input, &output, model.getStatus());
+    }
+    BM11ResultCache::Stats stats = cache.getStats();
+    BM11_CHECK(stats.entries <= 64);
+    BM11_CHECK(stats.evictions >= 1000 - 64);
+}
+
+static void testSharedSweep(void)
+{
+    BM11SweepConfig config;
+    BM11SweepConfigInit(&config);
+    config.print_profile = false;
+    config.thread_count  = 4;
+    config.grain         = 16;
+    BM11SweepAddAxis(&config, BM11InputField_squareSideLength, 10.0f, 20.0f, 41);
+    BM11SweepAddAxis(&config, BM11InputField_angle_ABC, 1.6f, 2.2f, 25);
+    uint64_t count = BM11SweepDesignCount(&config);
+
+    std::vector<float> plain(count), cached(count), again(count);
+    config.result         = storeCost;
+    config.result_context = &plain[0];
+    BM11RunSweep(&config);
+
+    BM11ResultCache cache(4096);
+    config.cache          = &cache;
+    config.result_context = &cached[0];
+    BM11RunSweep(&config);
+    config.result_context = &again[0];
+    BM11RunSweep(&config);
+
+    BM11_CHECK(memcmp(&plain[0], &cached[0], sizeof(float) * count) == 0);
+    BM11_CHECK(memcmp(&plain[0], &again[0], sizeof(float) * count) == 0);
+    BM11_CHECK(cache.getStats().hits >= count);
+}
+
+int main(void)
+{
+    testLookup();
+    testTolerance();
+    testEviction();
+    testSharedSweep();
+    return BM11TestFinish("BM11ResultCacheTests");
+}
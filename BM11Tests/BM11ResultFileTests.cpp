@@ -0,0 +1,204 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+#include "BM11Fields.h"
+#include "BM11ResultFile.h"
+#include "BM11Sweep.h"
+#include "BM11Test.h"
+
+/*
+   BM11ResultWriter/BM11ResultReader: a multi-threaded sweep written as
+   binary reads back with every row, 64-byte aligned columns and the model's
+   values; CSV rows parse back to the same values; column lists and
+   BM11FormatFloat() behave as documented.
+ */
+
+#define BINARY_PATH "BM11ResultFileTests.bm11"
+#define CSV_PATH    "BM11ResultFileTests.csv"
+
+static void appendResult(void *context, uint64_t index,
+                         const BM11Model::InputParameters  *input,
+                         const BM11Model::OutputParameters *output,
+                         BM11Model::Status status, int thread_index)
+{
+    ((BM11ResultWriter *)context)->appendDesign(thread_index, index, input, output, status);
+}
+
+static void setupSweep(BM11SweepConfig *config)
+{
+    BM11SweepConfigInit(config);
+    config->print_profile = false;
+    config->thread_count  = 3;
+    config->grain         = 50;
+    BM11SweepAddAxis(config, BM11InputField_squareSideLength, 4.0f, 24.0f, 61);
+    BM11SweepAddAxis(config, BM11InputField_baseCutBackLength, 0.0f, 5.0f, 41);
+}
+
+static void testColumns(void)
+{
+    BM11ResultColumn columns[128];
+    BM11_CHECK(BM11ParseResultColumns("index,squareSideLength,total.cost,status", columns, 128) == 4);
+    BM11_CHECK(columns[0].source == BM11ResultColumnIndex);
+    BM11_CHECK(columns[1].source == BM11ResultColumnInput && columns[1].field == BM11InputField_squareSideLength);
+    BM11_CHECK(columns[2].source == BM11ResultColumnOutput && columns[2].field == BM11OutputField_total_cost);
+    BM11_CHECK(columns[3].source == BM11ResultColumnStatus);
+    BM11_CHECK(strcmp(BM11ResultColumnName(&columns[2]), "total.cost") == 0);
+    BM11_CHECK(BM11ParseResultColumns("outputs", columns, 128) == BM11OutputField_Count);
+    BM11_CHECK(BM11ParseResultColumns("index,nonsense", columns, 128) == -1);
+    BM11_CHECK(BM11ParseResultColumns("outputs", columns, 10) == -1);
+}
+
+static void testFormatFloat(void)
+{
+    char buffer[64];
+    BM11_CHECK(BM11FormatFloat(buffer, 3.14159f, 3) == 5 && strcmp(buffer, "3.142") == 0);
+    BM11FormatFloat(buffer, -0.5f, 0);
+    BM11_CHECK(strcmp(buffer, "-1") == 0);
+    BM11FormatFloat(buffer, -0.0001f, 2);
+    BM11_CHECK(strcmp(buffer, "0.00") == 0);
+    BM11FormatFloat(buffer, NAN, 6);
+    BM11_CHECK(strcmp(buffer, "nan") == 0);
+    BM11FormatFloat(buffer, -INFINITY, 6);
+    BM11_CHECK(strcmp(buffer, "-inf") == 0);
+
+    uint64_t state = 8;
+    int      wrong = 0;
+    for (int i = 0; i < 10000; i++) {
+        float value    = (float)((BM11TestRandom(&state) - 0.5) * pow(10.0, 12 * BM11TestRandom(&state) - 4));
+        int   decimals = (int)(BM11TestRandom(&state) * 8);
+        int   length   = BM11FormatFloat(buffer, value, decimals);
+        double parsed  = strtod(buffer, NULL);
+        if (length != (int)strlen(buffer) || fabs(parsed - value) > 0.5 * pow(10.0, -decimals) + fabs(value) * 1e-15) {
+            wrong++;
+        }
+    }
+    BM11_CHECK(wrong == 0);
+}
+
+static void testBinary(void)
+{
+    BM11SweepConfig config;
+    setupSweep(&config);
+    uint64_t count = BM11SweepDesignCount(&config);
+
+    BM11ResultColumn columns[8];
+    int column_count = BM11ParseResultColumns("index,status,squareSideLength,total.cost,total.mass", columns, 8);
+    BM11ResultWriter writer;
+    BM11_CHECK(writer.open(BINARY_PATH, BM11ResultBinary, columns, column_count, config.thread_count, 100));
+    config.result         = appendResult;
+    config.result_context = &writer;
+    BM11RunSweep(&config);
+    BM11_CHECK(writer.close());
+    BM11_CHECK(writer.getRowCount() == count);
+
+    BM11ResultReader reader;
+    BM11_CHECK(reader.open(BINARY_PATH));
+    BM11_CHECK(reader.getColumnCount() == column_count);
+    BM11_CHECK(reader.getRowCount() == count);
+    BM11_CHECK(reader.getChunkCount() == (count + 99) / 100);
+    BM11_CHECK(reader.getColumnType(0) == BM11ResultUInt64);
+    BM11_CHECK(reader.getColumnType(1) == BM11ResultUInt8);
+    BM11_CHECK(reader.getColumnType(3) == BM11ResultFloat32);
+    BM11_CHECK(reader.findColumn("total.cost") == 3 && reader.findColumn("nope") < 0);
+
+    int misaligned = 0;
+    for (size_t c = 0; c < reader.getChunkCount(); c++) {
+        for (int k = 0; k < column_count; k++) {
+            misaligned += ((uintptr_t)reader.getChunkColumn(c, k) % 64) != 0;
+        }
+    }
+    BM11_CHECK(misaligned == 0);
+
+    /* Rows are in block order; the index column says which design each is */
+    std::vector<int> seen(count, 0);
+    int wrong = 0;
+    for (uint64_t row = 0; row < count; row++) {
+        uint64_t index = (uint64_t)reader.getValue(row, 0);
+        if (index >= count) {
+            wrong++;
+            continue;
+        }
+        seen[index]++;
+        BM11Model::InputParameters input;
+        BM11SweepGetDesign(&config, index, &input);
+        BM11Model model;
+        model.setInputParameters(input);
+        BM11Model::OutputParameters output = model.getOutputParameters();
+        if (reader.getValue(row, 1) != (double)model.getStatus() ||
+            reader.getValue(row, 2) != (double)input.squareSideLength ||
+            reader.getValue(row, 3) != (double)output.total.cost ||
+            reader.getValue(row, 4) != (double)output.total.mass) {
+            wrong++;
+        }
+    }
+    BM11_CHECK(wrong == 0);
+    int missing = 0;
+    for (uint64_t i = 0; i < count; i++) {
+        missing += (seen[i] != 1);
+    }
+    BM11_CHECK(missing == 0);
+    reader.close();
+    unlink(BINARY_PATH);
+
+    BM11_CHECK(!reader.open("BM11ResultFileTests.missing"));
+}
+
+static void testCSV(void)
+{
+    BM11SweepConfig config;
+    setupSweep(&config);
+    config.thread_count = 1;
+    uint64_t count = BM11SweepDesignCount(&config);
+
+    BM11ResultColumn columns[4];
+    int column_count = BM11ParseResultColumns("index,squareSideLength,total.cost", columns, 4);
+    BM11ResultWriter writer;
+    BM11_CHECK(writer.open(CSV_PATH, BM11ResultCSV, columns, column_count));
+    writer.setDecimals(4);
+    config.result         = appendResult;
+    config.result_context = &writer;
+    BM11RunSweep(&config);
+    BM11_CHECK(writer.close());
+
+    FILE *file = fopen(CSV_PATH, "r");
+    BM11_CHECK(file != NULL);
+    if (file == NULL) {
+        return;
+    }
+    char line[256];
+    BM11_CHECK(fgets(line, sizeof(line), file) && strcmp(line, "index,squareSideLength,total.cost\n") == 0);
+    uint64_t rows = 0;
+    int      wrong = 0;
+    while (fgets(line, sizeof(line), file)) {
+        char    *end;
+        uint64_t index = strtoull(line, &end, 10);
+        double   side  = strtod(end + 1, &end);
+        double   cost  = strtod(end + 1, &end);
+        BM11Model::InputParameters input;
+        BM11SweepGetDesign(&config, index, &input);
+        BM11Model model;
+        model.setInputParameters(input);
+        /* Half a unit in the 4th decimal, ties included */
+        if (index != rows || fabs(side - input.squareSideLength) > 5.001e-5 ||
+            fabs(cost - model.getOutputParameters().total.cost) > 5.001e-5) {
+            wrong++;
+        }
+        rows++;
+    }
+    fclose(file);
+    unlink(CSV_PATH);
+    BM11_CHECK(rows == count);
+    BM11_CHECK(wrong == 0);
+}
+
+int main(void)
+{
+    testColumns();
+    testFormatFloat();
+    testBinary();
+    testCSV();
+    return BM11TestFinish("BM11ResultFileTests");
+}
@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "BM11Model.h"
+#include "BM11Server.h"
+#include "BM11Test.h"
+
+/*
+   BM11Server::serveStream(): JSON results match BM11Model to float
+   tolerance, including the example in BM11Server.h, and a designs list
+   or repeated inputs beyond the limit are refused with an error.
+ */
+
+#define DESIGN_COUNT   100
+#define MAX_DESIGNS    (1u << 20)
+
+/* Writes the requests to a file, serves it and returns every response line */
+static std::vector<std::string> serve(const std::string &requests)
+{
+    FILE *in  = tmpfile();
+    FILE *out = tmpfile();
+    fwrite(requests.data(), 1, requests.size(), in);
+    fflush(in);
+    rewind(in);
+
+    BM11ServerConfig config;
+    BM11ServerConfigInit(&config);
+    config.thread_count = 2;
+    {
+        BM11Server server(&config);
+        BM11_CHECK(server.serveStream(fileno(in), fileno(out)));
+    }
+
+    std::vector<std::string> lines;
+    std::string line;
+    int c;
+    rewind(out);
+    while ((c = fgetc(out)) != EOF) {
+        if (c == '\n') {
+            lines.push_back(line);
+            line.clear();
+        } else {
+            line.push_back((char)c);
+        }
+    }
+    fclose(in);
+    fclose(out);
+    return lines;
+}
+
+static const std::string *findResponse(const std::vector<std::string> &lines, const char *id)
+{
+    std::string prefix = std::string("{\"id\":") + id + ",";
+    for (size_t l = 0; l < lines.size(); l++) {
+        if (lines[l].compare(0, prefix.size(), prefix) == 0) {
+            return &lines[l];
+        }
+    }
+    return NULL;
+}
+
+/* The number after "key": from *p on, moving *p past it */
+static bool nextValue(const char **p, const char *key, double *value)
+{
+    std::string quoted = std::string("\"") + key + "\":";
+    const char *at = strstr(*p, quoted.c_str());
+    if (at == NULL) {
+        return false;
+    }
+    char *end;
+    *value = strtod(at + quoted.size(), &end);
+    *p     = end;
+    return end != at + quoted.size();
+}
+
+int main(void)
+{
+    std::vector<BM11Model::InputParameters> inputs(DESIGN_COUNT);
+    uint64_t    state = 19;
+    std::string requests = "{\"id\": 1, \"fields\": [\"total.cost\", \"status\"], \"input\": {\"squareSideLength\": 14}}\n";
+    requests += "{\"id\": 2, \"fields\": \"index,status,total.cost,frame.metal_cost\", \"designs\": [";
+    for (int d = 0; d < DESIGN_COUNT; d++) {
+        inputs[d] = BM11TestRandomInputs(&state);
+        char design[512];
+        snprintf(design, sizeof(design),
+                 "%s{\"squareSideLength\": %.9g, \"baseCutBackLength\": %.9g, \"angle_ABC\": %.9g, "
+                 "\"shoulderHeight\": %.9g, \"unit_cost.mirror\": %.9g}",
+                 d ? ", " : "", inputs[d].squareSideLength, inputs[d].baseCutBackLength, inputs[d].angle_ABC,
+                 inputs[d].shoulderHeight, inputs[d].unit_cost.mirror);
+        requests += design;
+    }
+    requests += "]}\n{\"id\": 3, \"designs\": [{}";
+    for (uint32_t d = 0; d < MAX_DESIGNS; d++) {
+        requests += ",{}";
+    }
+    requests += "]}\n{\"id\": 4";
+    for (uint32_t d = 0; d <= MAX_DESIGNS; d++) {
+        requests += ", \"input\": {}";
+    }
+    requests += "}\n";
+
+    std::vector<std::string> lines = serve(requests);
+    BM11_CHECK(lines.size() == 4);
+
+    /* The example in BM11Server.h */
+    const std::string *example = findResponse(lines, "1");
+    BM11_CHECK(example != NULL);
+    if (example) {
+        BM11Model model;
+        BM11Model::InputParameters input = model.getInputParameters();
+        input.squareSideLength = 14;
+        model.setInputParameters(input);
+        double      cost, status;
+        const char *p = example->c_str();
+        BM11_CHECK(nextValue(&p, "total.cost", &cost) && nextValue(&p, "status", &status));
+        BM11_CHECK_NEAR(cost, model.getOutputParameters().total.cost, 1e-5 * cost);
+        BM11_CHECK_NEAR(cost, 6877.72217, 1e-2);
+        BM11_CHECK(status == 0);
+    }
+
+    const std::string *many = findResponse(lines, "2");
+    BM11_CHECK(many != NULL);
+    if (many) {
+        const char *p = many->c_str();
+        int wrong = 0, rejected = 0;
+        for (int d = 0; d < DESIGN_COUNT; d++) {
+            double index, status, cost, metal;
+            if (!nextValue(&p, "index", &index) || !nextValue(&p, "status", &status) ||
+                !nextValue(&p, "total.cost", &cost) || !nextValue(&p, "frame.metal_cost", &metal)) {
+                wrong++;
+                break;
+            }
+            BM11Model model;
+            model.setInputParameters(inputs[d]);
+            BM11Model::OutputParameters output = model.getOutputParameters();
+            if (index != d || status != model.getStatus()) {
+                wrong++;
+                continue;
+            }
+            if (status != BM11Model::StatusOK) {
+                rejected++;
+                continue;
+            }
+            wrong += fabs(cost - output.total.cost) > 1e-4 * fabs(output.total.cost);
+            wrong += fabs(metal - output.frame.metal_cost) > 1e-4 * fabs(output.frame.metal_cost);
+        }
+        BM11_CHECK(wrong == 0);
+        BM11_CHECK(rejected < DESIGN_COUNT / 2);
+    }
+
+    const std::string *refused = findResponse(lines, "3");
+    BM11_CHECK(refused != NULL && *refused == "{\"id\":3,\"error\":\"too many designs\"}");
+    refused = findResponse(lines, "4");
+    BM11_CHECK(refused != NULL && *refused == "{\"id\":4,\"error\":\"too many designs\"}");
+
+    return BM11TestFinish("BM11ServerTests");
+}
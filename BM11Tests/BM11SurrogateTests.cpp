@@ -0,0 +1,165 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+#include "BM11Fields.h"
+#include "BM11Model.h"
+#include "BM11Surrogate.h"
+#include "BM11Test.h"
+
+/*
+   BM11Surrogate on the default table against BM11Model at random points
+   inside it: the total cost error medians for trilinear and tricubic
+   queries, how well the trilinear error estimate tracks the actual error,
+   exact fallbacks outside the table and for infeasible designs, and
+   malformed files being refused.
+ */
+
+#define TABLE_PATH   "BM11SurrogateTests.bin"
+#define QUERY_COUNT  4000
+
+static double median(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    return values.empty() ? 0.0 : values[values.size() / 2];
+}
+
+static double percentile(std::vector<double> values, double q)
+{
+    std::sort(values.begin(), values.end());
+    return values.empty() ? 0.0 : values[(size_t)(q * (values.size() - 1))];
+}
+
+static BM11Model::InputParameters randomQuery(const BM11Surrogate *surrogate, uint64_t *state)
+{
+    BM11Model::InputParameters input = BM11TestRandomInputs(state);
+    static const int axis_field[BM11_SURROGATE_AXES] = {
+        BM11InputField_squareSideLength, BM11InputField_baseCutBackLength, BM11InputField_angle_ABC,
+    };
+    for (int a = 0; a < BM11_SURROGATE_AXES; a++) {
+        double t = BM11TestRandom(state);
+        BM11SetInputField(&input, axis_field[a],
+                          (float)(surrogate->getAxisMin(a) + t * (surrogate->getAxisMax(a) - surrogate->getAxisMin(a))));
+    }
+    return input;
+}
+
+static void testAccuracy(const BM11Surrogate *surrogate)
+{
+    std::vector<double> linear_error, cubic_error, ratio;
+    uint64_t state = 15;
+    int      status_mismatches = 0;
+
+    for (int q = 0; q < QUERY_COUNT; q++) {
+        BM11Model::InputParameters input = randomQuery(surrogate, &state);
+        BM11Model model;
+        model.setInputParameters(input);
+        double expected = model.getOutputParameters().total.cost;
+
+        BM11Model::OutputParameters linear, cubic, estimate;
+        BM11Model::Status status = surrogate->query(&input, &linear, &estimate, BM11SurrogateLinear);
+        surrogate->query(&input, &cubic, NULL, BM11SurrogateCubic);
+        if (status != model.getStatus()) {
+            status_mismatches++;
+            continue;
+        }
+        if (status != BM11Model::StatusOK) {
+            continue;
+        }
+        double actual = linear.total.cost - expected;
+        linear_error.push_back(fabs(actual) / expected);
+        cubic_error.push_back(fabs(cubic.total.cost - expected) / expected);
+        /* Only where the error stands clear of float rounding */
+        if (fabs(actual) > 1e-5 * expected) {
+            ratio.push_back(fabs(estimate.total.cost) / fabs(actual));
+        }
+    }
+
+    double linear_median = median(linear_error);
+    double cubic_median  = median(cubic_error);
+    printf("%zu designs: total.cost median relative error %.2g trilinear, %.2g tricubic; "
+           "estimate/actual %.2f (p50), %.2f (p99) over %zu\n",
+           linear_error.size(), linear_median, cubic_median,
+           percentile(ratio, 0.5), percentile(ratio, 0.99), ratio.size());
+    BM11_CHECK(status_mismatches == 0);
+    BM11_CHECK(linear_error.size() > QUERY_COUNT / 2);
+    BM11_CHECK(linear_median < 2e-4);
+    BM11_CHECK(cubic_median < 5e-6);
+    BM11_CHECK(cubic_median < linear_median / 10);
+    BM11_CHECK(ratio.size() > 100);
+    BM11_CHECK(percentile(ratio, 0.5) > 0.7 && percentile(ratio, 0.5) < 1.4);
+    BM11_CHECK(percentile(ratio, 0.99) < 3.0);
+}
+
+static void testFallbacks(const BM11Surrogate *surrogate)
+{
+    BM11Model::OutputParameters output, error;
+
+    /* Outside the table: exact, with no error */
+    BM11Model::InputParameters input = BM11Model::getDefaultInputParameters();
+    input.squareSideLength = surrogate->getAxisMax(0) + 2.0f;
+    BM11Model model;
+    model.setInputParameters(input);
+    BM11Model::OutputParameters expected = model.getOutputParameters();
+    BM11_CHECK(surrogate->query(&input, &output, &error) == BM11Model::StatusOK);
+    BM11_CHECK(memcmp(&output, &expected, sizeof(output)) == 0);
+    BM11_CHECK(error.total.cost == 0.0f);
+
+    /* Infeasible inside the table: rejected as the model rejects it */
+    input = BM11Model::getDefaultInputParameters();
+    input.baseCutBackLength = surrogate->getAxisMax(1);
+    input.squareSideLength  = input.baseCutBackLength;
+    model.setInputParameters(input);
+    expected = model.getOutputParameters();
+    BM11_CHECK(surrogate->query(&input, &output, &error) == model.getStatus());
+    BM11_CHECK(model.getStatus() != BM11Model::StatusOK);
+    BM11_CHECK(memcmp(&output, &expected, sizeof(output)) == 0);
+}
+
+static void testFiles(void)
+{
+    BM11Surrogate surrogate;
+    BM11_CHECK(!surrogate.open("BM11SurrogateTests.missing"));
+
+    /* A truncated table is refused */
+    FILE *in = fopen(TABLE_PATH, "rb");
+    std::vector<char> bytes(4096);
+    size_t length = in ? fread(&bytes[0], 1, bytes.size(), in) : 0;
+    if (in) {
+        fclose(in);
+    }
+    FILE *out = fopen("BM11SurrogateTests.short", "wb");
+    BM11_CHECK(out && length == bytes.size());
+    if (out) {
+        fwrite(&bytes[0], 1, length, out);
+        fclose(out);
+    }
+    BM11_CHECK(!surrogate.open("BM11SurrogateTests.short"));
+    unlink("BM11SurrogateTests.short");
+
+    BM11SurrogateConfig config;
+    BM11SurrogateConfigInit(&config);
+    config.count[1] = 1;
+    BM11_CHECK(!BM11SurrogateBuild(&config, "BM11SurrogateTests.bad"));
+    unlink("BM11SurrogateTests.bad");
+}
+
+int main(void)
+{
+    BM11SurrogateConfig config;
+    BM11SurrogateConfigInit(&config);
+    BM11_CHECK(BM11SurrogateBuild(&config, TABLE_PATH));
+
+    BM11Surrogate surrogate;
+    BM11_CHECK(surrogate.open(TABLE_PATH));
+    BM11_CHECK(surrogate.getAxisCount(0) == 33 && surrogate.getAxisCount(1) == 25 && surrogate.getAxisCount(2) == 31);
+
+    testAccuracy(&surrogate);
+    testFallbacks(&surrogate);
+    testFiles();
+    surrogate.close();
+    unlink(TABLE_PATH);
+    return BM11TestFinish("BM11SurrogateTests");
+}
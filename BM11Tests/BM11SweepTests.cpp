@@ -0,0 +1,127 @@
+#include <string.h>
+#include <vector>
+#include "BM11Model.h"
+#include "BM11Parallel.h"
+#include "BM11Sweep.h"
+#include "BM11Test.h"
+
+/*
+   BM11RunSweep() visits every design once, on any thread count, with the
+   same outputs as a fresh BM11Model per design; BM11ParallelFor() covers
+   every index once while threads steal from each other.
+ */
+
+typedef struct {
+    std::vector<float>    cost;
+    std::vector<uint8_t>  status;
+    std::vector<uint32_t> visits;
+} SweepRecord;
+
+static void recordResult(void *context, uint64_t index,
+                         const BM11Model::InputParameters  *input,
+                         const BM11Model::OutputParameters *output,
+                         BM11Model::Status status, int thread_index)
+{
+    (void)input;
+    (void)thread_index;
+    SweepRecord *record = (SweepRecord *)context;
+    record->cost[index]   = output->total.cost;
+    record->status[index] = (uint8_t)status;
+    __atomic_fetch_add(&record->visits[index], 1, __ATOMIC_RELAXED);
+}
+
+static void countRange(void *context, uint64_t begin, uint64_t end, int thread_index)
+{
+    (void)thread_index;
+    uint32_t *visits = (uint32_t *)context;
+    for (uint64_t i = begin; i < end; i++) {
+        __atomic_fetch_add(&visits[i], 1, __ATOMIC_RELAXED);
+    }
+}
+
+static void testGrid(int thread_count)
+{
+    BM11SweepConfig config;
+    BM11SweepConfigInit(&config);
+    config.print_profile = false;
+    config.thread_count  = thread_count;
+    config.grain         = 7;
+    BM11SweepAddAxis(&config, BM11InputField_squareSideLength, 6.0f, 20.0f, 15);
+    BM11SweepAddAxis(&config, BM11InputField_baseCutBackLength, 0.0f, 4.0f, 9);
+    BM11SweepAddAxis(&config, BM11InputField_unit_cost_mirror, 4.0f, 9.0f, 6);
+
+    uint64_t count = BM11SweepDesignCount(&config);
+    BM11_CHECK(count == 15 * 9 * 6);
+
+    SweepRecord record;
+    record.cost.assign(count, -1.0f);
+    record.status.assign(count, 0xff);
+    record.visits.assign(count, 0);
+    config.result         = recordResult;
+    config.result_context = &record;
+    BM11SweepStats stats = BM11RunSweep(&config);
+    BM11_CHECK(stats.designs_done == count);
+
+    uint64_t status_total = 0;
+    for (int s = 0; s < BM11Model::StatusCount; s++) {
+        status_total += stats.status_count[s];
+    }
+    BM11_CHECK(status_total == count);
+
+    /* Last axis fastest */
+    BM11Model::InputParameters first, second;
+    BM11SweepGetDesign(&config, 0, &first);
+    BM11SweepGetDesign(&config, 1, &second);
+    BM11_CHECK(first.squareSideLength == 6.0f && first.unit_cost.mirror == 4.0f);
+    BM11_CHECK(second.squareSideLength == 6.0f && second.unit_cost.mirror == 5.0f);
+
+    int mismatches = 0;
+    for (uint64_t i = 0; i < count; i++) {
+        BM11Model::InputParameters input;
+        BM11SweepGetDesign(&config, i, &input);
+        BM11Model model;
+        model.setInputParameters(input);
+        BM11Model::OutputParameters output = model.getOutputParameters();
+        if (record.visits[i] != 1 || record.status[i] != (uint8_t)model.getStatus() ||
+            memcmp(&record.cost[i], &output.total.cost, sizeof(float)) != 0) {
+            mismatches++;
+        }
+    }
+    BM11_CHECK(mismatches == 0);
+}
+
+static void testZip(void)
+{
+    BM11SweepConfig config;
+    BM11SweepConfigInit(&config);
+    config.mode          = BM11SweepZip;
+    config.print_profile = false;
+    BM11SweepAddAxis(&config, BM11InputField_squareSideLength, 10.0f, 20.0f, 11);
+    BM11SweepAddAxis(&config, BM11InputField_shoulderHeight, 4.0f, 6.0f, 5);
+    BM11_CHECK(BM11SweepDesignCount(&config) == 5);
+
+    BM11Model::InputParameters input;
+    BM11SweepGetDesign(&config, 4, &input);
+    BM11_CHECK(input.squareSideLength == 14.0f && input.shoulderHeight == 6.0f);
+}
+
+static void testParallelFor(void)
+{
+    static const uint64_t count = 100003;
+    std::vector<uint32_t> visits(count, 0);
+    BM11ParallelFor(count, 13, 5, countRange, &visits[0]);
+    int wrong = 0;
+    for (uint64_t i = 0; i < count; i++) {
+        wrong += (visits[i] != 1);
+    }
+    BM11_CHECK(wrong == 0);
+}
+
+int main(void)
+{
+    testGrid(1);
+    testGrid(4);
+    testZip();
+    testParallelFor();
+    return BM11TestFinish("BM11SweepTests");
+}
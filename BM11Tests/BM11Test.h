@@ -0,0 +1,69 @@
+#ifndef BM11_TEST_H
+#define BM11_TEST_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "BM11Model.h"
+
+/*
+   Minimal checks for the BM11Tests executables. A failed check prints its
+   location and the test keeps going; BM11TestFinish() reports the counts
+   and gives main()'s exit status. BM11TestRandomInputs() draws designs
+   around the defaults, wide enough that some are rejected.
+ */
+
+static int BM11TestChecks;
+static int BM11TestFailures;
+
+static inline bool BM11TestCheck(bool ok, const char *file, int line, const char *expression)
+{
+    BM11TestChecks++;
+    if (!ok) {
+        BM11TestFailures++;
+        fprintf(stderr, "%s:%d: FAILED: %s\n", file, line, expression);
+    }
+    return ok;
+}
+
+static inline bool BM11TestCheckNear(double actual, double expected, double tolerance,
+                                     const char *file, int line, const char *expression)
+{
+    bool ok = fabs(actual - expected) <= tolerance;
+    if (!BM11TestCheck(ok, file, line, expression)) {
+        fprintf(stderr, "    actual %.9g, expected %.9g, tolerance %.3g\n", actual, expected, tolerance);
+    }
+    return ok;
+}
+
+static inline int BM11TestFinish(const char *name)
+{
+    printf("%s: %d checks, %d failures\n", name, BM11TestChecks, BM11TestFailures);
+    return BM11TestFailures ? 1 : 0;
+}
+
+static inline double BM11TestRandom(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    z ^= (z >> 31);
+    return (double)(z >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static inline BM11Model::InputParameters BM11TestRandomInputs(uint64_t *state)
+{
+    BM11Model::InputParameters p = BM11Model::getDefaultInputParameters();
+    p.squareSideLength  = (float)(8.0 + 16.0 * BM11TestRandom(state));
+    p.baseCutBackLength = (float)(6.0 * BM11TestRandom(state));
+    p.angle_ABC         = BMMathDegreesToRadians((float)(70.0 + 80.0 * BM11TestRandom(state)));
+    p.shoulderHeight    = (float)(4.0 + 2.0 * BM11TestRandom(state));
+    p.unit_cost.mirror *= (float)(0.5 + BM11TestRandom(state));
+    return p;
+}
+
+#define BM11_CHECK(condition)                BM11TestCheck((condition), __FILE__, __LINE__, #condition)
+#define BM11_CHECK_NEAR(actual, expected, tolerance) \
+    BM11TestCheckNear((actual), (expected), (tolerance), __FILE__, __LINE__, #actual " ~ " #expected)
+
+#endif /* BM11_TEST_H */
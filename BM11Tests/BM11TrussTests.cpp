@@ -0,0 +1,182 @@
+#include <math.h>
+#include <vector>
+#include "BM11Model.h"
+#include "BM11Test.h"
+#include "BM11Truss.h"
+#include "BM11Wind.h"
+
+/*
+   BM11TrussSolver: reactions balance the loads in force and in moment,
+   the wind load adds up to BM11Wind's force, the response is linear in the
+   load, BM11TrussSolveBatch() matches single solves on any thread count and
+   rejected designs aren't solved.
+ */
+
+#define DESIGN_COUNT 300
+
+static BMVector3 sum(BMVector3 a, BMVector3 b)
+{
+    return BMVector3Make(a.x + b.x, a.y + b.y, a.z + b.z);
+}
+
+static bool sameSummary(const BM11TrussSummary *a, const BM11TrussSummary *b)
+{
+    return a->solved == b->solved && a->max_displacement == b->max_displacement &&
+           a->max_displacement_node == b->max_displacement_node && a->max_stress == b->max_stress &&
+           a->max_stress_member == b->max_stress_member && a->max_tension == b->max_tension &&
+           a->max_compression == b->max_compression;
+}
+
+static void testEquilibrium(const std::vector<BM11Model::InputParameters> &inputs,
+                            const std::vector<BM11Model::OutputParameters> &outputs,
+                            const std::vector<BM11Model::Status> &status)
+{
+    BM11TrussConfig config;
+    BM11TrussConfigInit(&config);
+    config.wind_heading = 30.0f;
+    config.panel_weight = 1.5f;
+    BM11TrussSolver solver(&config);
+
+    int solved = 0, unbalanced = 0;
+    for (size_t d = 0; d < inputs.size(); d++) {
+        BM11TrussSummary summary;
+        bool ok = solver.solve(&inputs[d], &outputs[d], &summary);
+        BM11_CHECK(ok == summary.solved);
+        if (status[d] != BM11Model::StatusOK) {
+            BM11_CHECK(!ok);
+            continue;
+        }
+        if (!ok) {
+            continue;
+        }
+        solved++;
+
+        /* Sum of forces and of moments about O (node 0), in lb and lb ft */
+        const BM11FrameLayout *layout = solver.getLayout();
+        double force[3] = { 0, 0, 0 }, moment[3] = { 0, 0, 0 }, scale = 0;
+        for (int n = 0; n < layout->node_count; n++) {
+            BMVector3 f = sum(solver.getLoad(n), solver.getReaction(n));
+            BMVector3 r = BMVector3Subtract(layout->node[n], layout->node[0]);
+            BMVector3 m = BMVector3CrossProduct(r, f);
+            force[0]  += f.x; force[1]  += f.y; force[2]  += f.z;
+            moment[0] += m.x; moment[1] += m.y; moment[2] += m.z;
+            scale      = fmax(scale, BMVector3Length(solver.getLoad(n)));
+        }
+        double reach = outputs[d].edge_length.OA + outputs[d].edge_length.OB;
+        for (int k = 0; k < 3; k++) {
+            if (fabs(force[k]) > 1e-4 * scale * layout->node_count ||
+                fabs(moment[k]) > 1e-4 * scale * reach * layout->node_count) {
+                unbalanced++;
+                break;
+            }
+        }
+    }
+    printf("%d frames solved, %d out of equilibrium\n", solved, unbalanced);
+    BM11_CHECK(solved > (int)inputs.size() / 2);
+    BM11_CHECK(unbalanced == 0);
+}
+
+static void testWindLoad(void)
+{
+    BM11Model model;
+    BM11Model::InputParameters  input  = model.getInputParameters();
+    BM11Model::OutputParameters output = model.getOutputParameters();
+
+    for (int heading = 0; heading < 180; heading += 15) {
+        BM11TrussConfig config;
+        BM11TrussConfigInit(&config);
+        config.gravity          = false;
+        config.wind_heading     = (float)heading;
+        config.drag_coefficient = 1.2f;
+        BM11TrussSolver  solver(&config);
+        BM11TrussSummary summary;
+        BM11_CHECK(solver.solve(&input, &output, &summary));
+
+        BM11WindGrid grid;
+        BM11WindGridInit(&grid);
+        float area[360];
+        BM11WindEvaluate(&grid, &output, 1, area, NULL);
+        double expected = area[heading] * BM11WindPressure(config.wind_speed_mph) * config.drag_coefficient;
+
+        BMVector3 total = BMVector3Make(0, 0, 0);
+        for (int n = 0; n < solver.getLayout()->node_count; n++) {
+            total = sum(total, solver.getLoad(n));
+        }
+        /* Horizontal, along the heading */
+        double along = total.x * cos(heading * M_PI / 180) + total.z * sin(heading * M_PI / 180);
+        BM11_CHECK_NEAR(fabs(along), expected, 1e-4 * expected);
+        BM11_CHECK_NEAR(total.y, 0.0, 1e-4 * expected);
+    }
+}
+
+static void testLinearity(void)
+{
+    BM11Model model;
+    BM11Model::InputParameters  input  = model.getInputParameters();
+    BM11Model::OutputParameters output = model.getOutputParameters();
+
+    BM11TrussConfig config;
+    BM11TrussConfigInit(&config);
+    config.gravity = false;
+    BM11TrussSolver  once(&config);
+    BM11TrussSummary one, two;
+    BM11_CHECK(once.solve(&input, &output, &one));
+    config.drag_coefficient *= 2;
+    BM11TrussSolver twice(&config);
+    BM11_CHECK(twice.solve(&input, &output, &two));
+
+    BM11_CHECK_NEAR(two.max_displacement, 2 * one.max_displacement, 1e-5 * one.max_displacement);
+    BM11_CHECK(two.max_displacement_node == one.max_displacement_node);
+    for (int m = 0; m < once.getLayout()->member_count; m++) {
+        float a = once.getMemberForce(m)->axial;
+        BM11_CHECK_NEAR(twice.getMemberForce(m)->axial, 2 * a, 1e-4 * fabs(a) + 1e-3);
+    }
+    BM11_CHECK(one.max_displacement > 0 && one.max_stress > 0);
+    BM11_CHECK(once.getEquationCount() > 0 && once.getFactorNonzeroCount() > 0);
+}
+
+static void testBatch(const std::vector<BM11Model::InputParameters> &inputs,
+                      const std::vector<BM11Model::OutputParameters> &outputs)
+{
+    BM11TrussConfig config;
+    BM11TrussConfigInit(&config);
+    BM11TrussSolver solver(&config);
+
+    std::vector<BM11TrussSummary> single(inputs.size()), one(inputs.size()), four(inputs.size());
+    for (size_t d = 0; d < inputs.size(); d++) {
+        solver.solve(&inputs[d], &outputs[d], &single[d]);
+    }
+    BM11TrussSolveBatch(&config, &inputs[0], &outputs[0], inputs.size(), &one[0], 1);
+    BM11TrussSolveBatch(&config, &inputs[0], &outputs[0], inputs.size(), &four[0], 4);
+
+    int wrong = 0;
+    for (size_t d = 0; d < inputs.size(); d++) {
+        wrong += !sameSummary(&single[d], &one[d]);
+        wrong += !sameSummary(&single[d], &four[d]);
+    }
+    BM11_CHECK(wrong == 0);
+}
+
+int main(void)
+{
+    std::vector<BM11Model::InputParameters>  inputs(DESIGN_COUNT);
+    std::vector<BM11Model::OutputParameters> outputs(DESIGN_COUNT);
+    std::vector<BM11Model::Status>           status(DESIGN_COUNT);
+    uint64_t state = 16;
+    for (int d = 0; d < DESIGN_COUNT; d++) {
+        inputs[d] = BM11TestRandomInputs(&state);
+        if ((d % 13) == 0) {
+            inputs[d].baseCutBackLength = inputs[d].squareSideLength;
+        }
+        BM11Model model;
+        model.setInputParameters(inputs[d]);
+        outputs[d] = model.getOutputParameters();
+        status[d]  = model.getStatus();
+    }
+
+    testEquilibrium(inputs, outputs, status);
+    testWindLoad();
+    testLinearity();
+    testBatch(inputs, outputs);
+    return BM11TestFinish("BM11TrussTests");
+}
@@ -0,0 +1,108 @@
+#include <math.h>
+#include <vector>
+#include "BM11Model.h"
+#include "BM11Test.h"
+#include "BM11Wind.h"
+
+/*
+   BM11WindEvaluate() against a scalar double evaluation of the documented
+   formulas, on the default grid and on one whose counts leave lane tails;
+   0 and 90 degrees reproduce the model's YZ and XY areas, rejected designs
+   load nothing and a NULL area table doesn't change the forces.
+ */
+
+#define DESIGN_COUNT 200
+
+static void testGrid(const BM11WindGrid *grid, const std::vector<BM11Model::OutputParameters> &designs)
+{
+    size_t area_count  = BM11WindAreaCount(grid);
+    size_t force_count = BM11WindForceCount(grid);
+    std::vector<float> area(area_count * designs.size()), force(force_count * designs.size());
+    BM11WindEvaluate(grid, &designs[0], designs.size(), &area[0], &force[0]);
+
+    int wrong = 0;
+    for (size_t i = 0; i < designs.size(); i++) {
+        const BM11Model::OutputParameters *op = &designs[i];
+        BMVector3 n = BMVector3CrossProduct(BMVector3Subtract(op->vertex_coord.B0, op->vertex_coord.A0),
+                                            BMVector3Subtract(op->vertex_coord.B0, op->vertex_coord.O));
+        double scale = sqrt((double)n.x * n.x + (double)n.z * n.z); /* Largest area */
+
+        for (uint32_t d = 0; d < grid->direction_count; d++) {
+            double t        = 2.0 * M_PI * d / grid->direction_count;
+            double expected = fabs(n.x * 0.5 * cos(t) + n.z * 0.5 * sin(t)) * 2.0;
+            float  actual   = area[i * area_count + d];
+            if (fabs(actual - expected) > 1e-5 * scale + 1e-6) {
+                wrong++;
+            }
+            for (uint32_t c = 0; c < grid->drag_count; c++) {
+                for (uint32_t s = 0; s < grid->speed_count; s++) {
+                    double mph       = grid->speed_mph[s];
+                    double pressure  = (mph * 1.46667) * (mph * 1.46667) * 0.00256;
+                    double reference = expected * pressure * grid->drag_coefficient[c];
+                    float  value     = force[i * force_count + ((size_t)c * grid->direction_count + d) * grid->speed_count + s];
+                    if (fabs(value - reference) > 1e-5 * scale * pressure * grid->drag_coefficient[c] + 1e-6) {
+                        wrong++;
+                    }
+                }
+            }
+        }
+    }
+    BM11_CHECK(wrong == 0);
+
+    std::vector<float> forces_only(force.size());
+    BM11WindEvaluate(grid, &designs[0], designs.size(), NULL, &forces_only[0]);
+    BM11_CHECK(forces_only == force);
+}
+
+int main(void)
+{
+    std::vector<BM11Model::OutputParameters> designs(DESIGN_COUNT);
+    std::vector<BM11Model::Status>           status(DESIGN_COUNT);
+    uint64_t state = 10;
+    int      rejected = 0;
+    for (int d = 0; d < DESIGN_COUNT; d++) {
+        BM11Model::InputParameters input = BM11TestRandomInputs(&state);
+        if ((d % 17) == 0) {
+            input.baseCutBackLength = input.squareSideLength;
+        }
+        BM11Model model;
+        model.setInputParameters(input);
+        designs[d] = model.getOutputParameters();
+        status[d]  = model.getStatus();
+        rejected  += (status[d] != BM11Model::StatusOK);
+    }
+    BM11_CHECK(rejected > 0);
+
+    BM11WindGrid grid;
+    BM11WindGridInit(&grid);
+    BM11_CHECK(grid.direction_count == 360 && grid.speed_count == 20 && grid.drag_count == 1);
+    testGrid(&grid, designs);
+
+    static const float speeds[] = { 3.0f, 17.5f, 40.0f, 61.0f, 88.0f, 90.0f, 120.0f };
+    static const float drags[]  = { 0.8f, 1.3f };
+    BM11WindGrid odd;
+    odd.direction_count  = 37;
+    odd.speed_count      = 7;
+    odd.speed_mph        = speeds;
+    odd.drag_count       = 2;
+    odd.drag_coefficient = drags;
+    testGrid(&odd, designs);
+
+    /* The axes give the model's projected areas; rejected designs give zero */
+    std::vector<float> area(BM11WindAreaCount(&grid) * DESIGN_COUNT);
+    BM11WindEvaluate(&grid, &designs[0], DESIGN_COUNT, &area[0], NULL);
+    for (int d = 0; d < DESIGN_COUNT; d++) {
+        const float *table = &area[(size_t)d * grid.direction_count];
+        BM11_CHECK_NEAR(table[0],  designs[d].wind.total_surface_area_YZ, 1e-5 * fmax(1.0, designs[d].wind.total_surface_area_YZ));
+        BM11_CHECK_NEAR(table[90], designs[d].wind.total_surface_area_XY, 1e-5 * fmax(1.0, designs[d].wind.total_surface_area_XY));
+        if (status[d] != BM11Model::StatusOK) {
+            int nonzero = 0;
+            for (uint32_t h = 0; h < grid.direction_count; h++) {
+                nonzero += (table[h] != 0.0f);
+            }
+            BM11_CHECK(nonzero == 0);
+        }
+    }
+
+    return BM11TestFinish("BM11WindTests");
+}